@@ -41,6 +41,7 @@ struct db_elem
     uint32_t surface_id;
     char *cfg_app_id;
     char *cfg_title;
+    uint32_t max_frame_rate;
     struct ivi_layout_surface *layout_surface;
 };
 
@@ -56,6 +57,7 @@ struct ivi_id_agent
     struct wl_listener id_allocation_listener;
     struct wl_listener destroy_listener;
     struct wl_listener surface_removed;
+    struct wl_listener surface_created;
 };
 
 static int32_t
@@ -201,6 +203,23 @@ surface_event_remove(struct wl_listener *listener, void *data) {
     }
 }
 
+static void
+surface_event_create(struct wl_listener *listener, void *data) {
+    struct ivi_id_agent *ida = wl_container_of(listener, ida,
+                surface_created);
+    struct ivisurface *ivisurf = (struct ivisurface *) data;
+    struct db_elem *db_elem = NULL;
+
+    /* apply the frame rate limit of the configuration */
+    wl_list_for_each(db_elem, &ida->app_list, link)
+    {
+        if(db_elem->layout_surface == ivisurf->layout_surface) {
+            ivisurf->frame_rate_limit = db_elem->max_frame_rate;
+            break;
+        }
+    }
+}
+
 static int32_t deinit(struct ivi_id_agent *ida);
 
 static void
@@ -303,6 +322,8 @@ read_config(struct ivi_id_agent *ida)
                          &db_elem->cfg_app_id, NULL);
         weston_config_section_get_string(section, "app-title",
                          &db_elem->cfg_title, NULL);
+        weston_config_section_get_uint(section, "max-frame-rate",
+                         &db_elem->max_frame_rate, 0);
 
         if (db_elem->cfg_app_id == NULL && db_elem->cfg_title == NULL) {
             weston_log("ivi-id-agent: Every parameter is NULL in app "
@@ -347,11 +368,13 @@ id_agent_module_init(struct ivishell *shell)
     ida->interface = shell->interface;
     ida->id_allocation_listener.notify = id_allocation_event_request;
     ida->surface_removed.notify = surface_event_remove;
+    ida->surface_created.notify = surface_event_create;
 
     ida->interface->shell_add_destroy_listener_once(
             &ida->destroy_listener, id_agent_module_deinit);
     wl_signal_add(&shell->id_allocation_request_signal, &ida->id_allocation_listener);
     ida->interface->add_listener_remove_surface(&ida->surface_removed);
+    wl_signal_add(&shell->ivisurface_created_signal, &ida->surface_created);
 
     wl_list_init(&ida->app_list);
     if(read_config(ida) != 0) {
@@ -381,6 +404,7 @@ deinit(struct ivi_id_agent *ida)
     wl_list_remove(&ida->id_allocation_listener.link);
     wl_list_remove(&ida->destroy_listener.link);
     wl_list_remove(&ida->surface_removed.link);
+    wl_list_remove(&ida->surface_created.link);
     free(ida);
 
     return IVI_SUCCEEDED;
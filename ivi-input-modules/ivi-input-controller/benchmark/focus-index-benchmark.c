@@ -0,0 +1,190 @@
+/*
+ * Copyright (C) 2017 Advanced Driver Information Technology Joint Venture GmbH
+ *
+ * Permission to use, copy, modify, distribute, and sell this software and
+ * its documentation for any purpose is hereby granted without fee, provided
+ * that the above copyright notice appear in all copies and that both that
+ * copyright notice and this permission notice appear in supporting
+ * documentation, and that the name of the copyright holders not be used in
+ * advertising or publicity pertaining to distribution of the software
+ * without specific, written prior permission.  The copyright holders make
+ * no representations about the suitability of this software for any
+ * purpose.  It is provided "as is" without express or implied warranty.
+ *
+ * THE COPYRIGHT HOLDERS DISCLAIM ALL WARRANTIES WITH REGARD TO THIS
+ * SOFTWARE, INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND
+ * FITNESS, IN NO EVENT SHALL THE COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * SPECIAL, INDIRECT OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER
+ * RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF
+ * CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+ * CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+
+/**
+ * Benchmark of the keyboard event routing of ivi-input-controller.
+ *
+ * Sets up 500 surfaces which accept 4 seats, each seat with keyboard focus
+ * on one surface and pointer focus on another one, and measures the time
+ * routing a key event and a modifiers event takes per event through the
+ * focus index of the seat. For reference, the same events are routed by
+ * walking every surface and its accepted seats, as the input controller
+ * did before the focus index.
+ *
+ * Only the routing is measured, the events are handed to a counter
+ * instead of the wl_keyboard resources of clients.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "../src/ivi-input-focus.h"
+
+#define BENCH_SURFACES 500
+#define BENCH_SEATS 4
+#define BENCH_EVENTS 20000
+
+/* like ILM_INPUT_DEVICE_* */
+#define BENCH_KEYBOARD 1
+#define BENCH_POINTER 2
+
+struct bench_seat {
+    struct ivi_input_focus_index focus_index;
+};
+
+/* like seat_focus of the input controller */
+struct bench_focus {
+    struct bench_seat *seat;
+    struct ivi_input_focus_entry entry;
+    struct wl_list link;
+};
+
+struct bench_surface {
+    /* bench_focus::link of the accepted seats */
+    struct wl_list accepted_seat_list;
+    struct bench_focus focus[BENCH_SEATS];
+    struct wl_list link;
+};
+
+static uint32_t routed;
+
+static double
+now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static void
+count_event(struct ivi_input_focus_entry *entry, void *data)
+{
+    (void)entry;
+    (void)data;
+
+    routed++;
+}
+
+/* key routing as it was done before the focus index */
+static void
+route_key_by_surface_walk(struct wl_list *surfaces, struct bench_seat *seat)
+{
+    struct bench_surface *surface;
+    struct bench_focus *focus;
+
+    wl_list_for_each(surface, surfaces, link) {
+        wl_list_for_each(focus, &surface->accepted_seat_list, link) {
+            if (focus->seat != seat)
+                continue;
+
+            if (focus->entry.focus & BENCH_KEYBOARD)
+                count_event(&focus->entry, NULL);
+            break;
+        }
+    }
+}
+
+static void
+set_focus(struct bench_surface *surface, struct bench_seat *seats, int seat,
+          uint32_t device)
+{
+    surface->focus[seat].entry.focus |= device;
+    ivi_input_focus_index_update(&seats[seat].focus_index,
+                                 &surface->focus[seat].entry);
+}
+
+int
+main(void)
+{
+    static struct bench_surface surfaces[BENCH_SURFACES];
+    struct bench_seat seats[BENCH_SEATS];
+    struct wl_list surface_list;
+    double start, indexed_key, indexed_mods, walked_key;
+    uint32_t expected;
+    int i, j, n;
+
+    wl_list_init(&surface_list);
+
+    for (j = 0; j < BENCH_SEATS; j++)
+        ivi_input_focus_index_init(&seats[j].focus_index,
+                                   BENCH_KEYBOARD | BENCH_POINTER);
+
+    for (i = 0; i < BENCH_SURFACES; i++) {
+        wl_list_init(&surfaces[i].accepted_seat_list);
+        for (j = 0; j < BENCH_SEATS; j++) {
+            surfaces[i].focus[j].seat = &seats[j];
+            ivi_input_focus_entry_init(&surfaces[i].focus[j].entry);
+            wl_list_insert(&surfaces[i].accepted_seat_list,
+                           &surfaces[i].focus[j].link);
+        }
+        wl_list_insert(&surface_list, &surfaces[i].link);
+    }
+
+    /* keyboard and pointer focus of every seat on surfaces spread over
+     * the surface list */
+    for (j = 0; j < BENCH_SEATS; j++) {
+        i = (j * 2 + 1) * BENCH_SURFACES / (BENCH_SEATS * 2);
+        set_focus(&surfaces[i], seats, j, BENCH_KEYBOARD);
+        set_focus(&surfaces[BENCH_SURFACES - 1 - i], seats, j, BENCH_POINTER);
+    }
+
+    routed = 0;
+    start = now_ns();
+    for (n = 0; n < BENCH_EVENTS; n++)
+        for (j = 0; j < BENCH_SEATS; j++)
+            ivi_input_focus_route(&seats[j].focus_index, BENCH_KEYBOARD,
+                                  count_event, NULL);
+    indexed_key = (now_ns() - start) / (BENCH_EVENTS * BENCH_SEATS);
+    expected = routed;
+
+    start = now_ns();
+    for (n = 0; n < BENCH_EVENTS; n++)
+        for (j = 0; j < BENCH_SEATS; j++)
+            ivi_input_focus_route(&seats[j].focus_index,
+                                  BENCH_KEYBOARD | BENCH_POINTER,
+                                  count_event, NULL);
+    indexed_mods = (now_ns() - start) / (BENCH_EVENTS * BENCH_SEATS);
+
+    routed = 0;
+    start = now_ns();
+    for (n = 0; n < BENCH_EVENTS; n++)
+        for (j = 0; j < BENCH_SEATS; j++)
+            route_key_by_surface_walk(&surface_list, &seats[j]);
+    walked_key = (now_ns() - start) / (BENCH_EVENTS * BENCH_SEATS);
+
+    if (routed != expected) {
+        fprintf(stderr, "routed %u key events, the surface walk %u\n",
+                expected, routed);
+        return 1;
+    }
+
+    printf("%d surfaces, %d seats, %d events per seat\n",
+           BENCH_SURFACES, BENCH_SEATS, BENCH_EVENTS);
+    printf("key, focus index:        %10.1f ns/event\n", indexed_key);
+    printf("modifiers, focus index:  %10.1f ns/event\n", indexed_mods);
+    printf("key, surface walk:       %10.1f ns/event\n", walked_key);
+
+    return 0;
+}
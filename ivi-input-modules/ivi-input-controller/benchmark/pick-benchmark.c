@@ -0,0 +1,179 @@
+/*
+ * Copyright (C) 2017 Advanced Driver Information Technology Joint Venture GmbH
+ *
+ * Permission to use, copy, modify, distribute, and sell this software and
+ * its documentation for any purpose is hereby granted without fee, provided
+ * that the above copyright notice appear in all copies and that both that
+ * copyright notice and this permission notice appear in supporting
+ * documentation, and that the name of the copyright holders not be used in
+ * advertising or publicity pertaining to distribution of the software
+ * without specific, written prior permission.  The copyright holders make
+ * no representations about the suitability of this software for any
+ * purpose.  It is provided "as is" without express or implied warranty.
+ *
+ * THE COPYRIGHT HOLDERS DISCLAIM ALL WARRANTIES WITH REGARD TO THIS
+ * SOFTWARE, INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND
+ * FITNESS, IN NO EVENT SHALL THE COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * SPECIAL, INDIRECT OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER
+ * RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF
+ * CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+ * CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+
+/**
+ * Benchmark of the spatial index used to pick the pointer focus.
+ *
+ * Stacks 40 layers of 8 surfaces each at random positions on a 1920x1080
+ * screen, and measures how many picks per second ivi_input_index_pick()
+ * does at random points. For reference, the same points are picked by
+ * testing every rectangle from the top to the bottom, as
+ * weston_compositor_pick_view() walks every view. Both must pick the same
+ * surface.
+ *
+ * The index is rebuilt on the first pick after the scene changed, so the
+ * picks per second are also measured with a rebuild before every pick, the
+ * worst case of a scene changing faster than the pointer moves.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "../src/ivi-input-index.h"
+
+#define BENCH_WIDTH 1920
+#define BENCH_HEIGHT 1080
+#define BENCH_LAYERS 40
+#define BENCH_SURFACES_PER_LAYER 8
+#define BENCH_RECTS (BENCH_LAYERS * BENCH_SURFACES_PER_LAYER)
+#define BENCH_PICKS 1000000
+#define BENCH_REBUILDS 10000
+
+struct bench_rect {
+    int32_t x1, y1, x2, y2;
+};
+
+static struct bench_rect rects[BENCH_RECTS];
+static int32_t points[BENCH_PICKS][2];
+
+static double
+elapsed_s(const struct timespec *start)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - start->tv_sec) +
+           (now.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+/* Add the rectangles from the top to the bottom and build the grid */
+static int
+build_index(struct ivi_input_index *index)
+{
+    int i;
+
+    ivi_input_index_clear(index);
+    for (i = 0; i < BENCH_RECTS; i++) {
+        if (ivi_input_index_add(index, &rects[i], rects[i].x1, rects[i].y1,
+                                rects[i].x2, rects[i].y2) < 0)
+            return -1;
+    }
+
+    return ivi_input_index_build(index);
+}
+
+static void *
+linear_pick(int32_t x, int32_t y)
+{
+    int i;
+
+    for (i = 0; i < BENCH_RECTS; i++) {
+        if (x >= rects[i].x1 && x < rects[i].x2 &&
+            y >= rects[i].y1 && y < rects[i].y2)
+            return &rects[i];
+    }
+
+    return NULL;
+}
+
+int
+main(int argc, char **argv)
+{
+    struct ivi_input_index index;
+    struct timespec start;
+    double linear_s, index_s, build_s, rebuild_s;
+    uintptr_t checksum_linear = 0, checksum_index = 0;
+    uintptr_t checksum_rebuild_linear = 0, checksum_rebuild = 0;
+    int i, w, h;
+
+    (void)argc;
+    (void)argv;
+
+    srand(1);
+    for (i = 0; i < BENCH_RECTS; i++) {
+        w = 64 + rand() % (BENCH_WIDTH / 2);
+        h = 64 + rand() % (BENCH_HEIGHT / 2);
+        rects[i].x1 = rand() % (BENCH_WIDTH - w);
+        rects[i].y1 = rand() % (BENCH_HEIGHT - h);
+        rects[i].x2 = rects[i].x1 + w;
+        rects[i].y2 = rects[i].y1 + h;
+    }
+
+    for (i = 0; i < BENCH_PICKS; i++) {
+        points[i][0] = rand() % BENCH_WIDTH;
+        points[i][1] = rand() % BENCH_HEIGHT;
+    }
+
+    ivi_input_index_init(&index);
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    if (build_index(&index) < 0) {
+        fprintf(stderr, "failed to build the index\n");
+        return 1;
+    }
+    build_s = elapsed_s(&start);
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (i = 0; i < BENCH_PICKS; i++)
+        checksum_linear += (uintptr_t)linear_pick(points[i][0], points[i][1]);
+    linear_s = elapsed_s(&start);
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (i = 0; i < BENCH_PICKS; i++)
+        checksum_index += (uintptr_t)ivi_input_index_pick(&index,
+                points[i][0], points[i][1], NULL, NULL);
+    index_s = elapsed_s(&start);
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (i = 0; i < BENCH_REBUILDS; i++) {
+        if (build_index(&index) < 0) {
+            fprintf(stderr, "failed to build the index\n");
+            return 1;
+        }
+        checksum_rebuild += (uintptr_t)ivi_input_index_pick(&index,
+                points[i][0], points[i][1], NULL, NULL);
+    }
+    rebuild_s = elapsed_s(&start);
+
+    ivi_input_index_release(&index);
+
+    for (i = 0; i < BENCH_REBUILDS; i++)
+        checksum_rebuild_linear +=
+            (uintptr_t)linear_pick(points[i][0], points[i][1]);
+
+    if (checksum_linear != checksum_index ||
+        checksum_rebuild_linear != checksum_rebuild) {
+        fprintf(stderr, "the index picked other surfaces than the walk\n");
+        return 1;
+    }
+
+    printf("%d surfaces on %d layers, %d picks\n",
+           BENCH_RECTS, BENCH_LAYERS, BENCH_PICKS);
+    printf("index build:     %8.1f us\n", build_s * 1e6);
+    printf("walk all:        %12.0f picks/s\n", BENCH_PICKS / linear_s);
+    printf("spatial index:   %12.0f picks/s\n", BENCH_PICKS / index_s);
+    printf("rebuild + pick:  %12.0f picks/s\n", BENCH_REBUILDS / rebuild_s);
+
+    return 0;
+}
@@ -0,0 +1,580 @@
+/*
+ * Copyright (C) 2017 Advanced Driver Information Technology Joint Venture GmbH
+ *
+ * Permission to use, copy, modify, distribute, and sell this software and
+ * its documentation for any purpose is hereby granted without fee, provided
+ * that the above copyright notice appear in all copies and that both that
+ * copyright notice and this permission notice appear in supporting
+ * documentation, and that the name of the copyright holders not be used in
+ * advertising or publicity pertaining to distribution of the software
+ * without specific, written prior permission.  The copyright holders make
+ * no representations about the suitability of this software for any
+ * purpose.  It is provided "as is" without express or implied warranty.
+ *
+ * THE COPYRIGHT HOLDERS DISCLAIM ALL WARRANTIES WITH REGARD TO THIS
+ * SOFTWARE, INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND
+ * FITNESS, IN NO EVENT SHALL THE COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * SPECIAL, INDIRECT OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER
+ * RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF
+ * CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+ * CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+
+/**
+ * Evaluation of the touch-motion modes of ivi-input-controller.
+ *
+ * Feeds the touch events of a trace recorded with input-record, or of a
+ * generated drag sampled at 90 Hz, to every mode, with the frames of an
+ * output at a given refresh rate. A frame shows the positions a mode sent
+ * until then. They are compared with the trace interpolated at the frame
+ * time:
+ *
+ *   events: motion events sent to the client
+ *   error:  mean and maximum distance to the trace, in pixels
+ *   jitter: mean change of the motion from one frame to the next, in
+ *           pixels, as far as the trace itself does not change its motion
+ *
+ * The results are averaged over 8 phases of the frames to the samples.
+ *
+ * Usage: ivi-input-touch-resample-benchmark [trace.ivir [refresh in Hz]]
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "ivi-input-record.h"
+#include "../src/ivi-input-resample.h"
+
+#define PHASES 8
+#define DEFAULT_REFRESH_HZ 60
+#define GENERATED_RATE_HZ 90
+#define GENERATED_DURATION_US 1500000
+
+enum strategy {
+    /* the trace itself at the frame time, for the jitter of the motion */
+    STRATEGY_TRACE,
+    STRATEGY_IMMEDIATE,
+    STRATEGY_REPAINT,
+    STRATEGY_RESAMPLE_NO_PREDICTION,
+    STRATEGY_RESAMPLE,
+    STRATEGIES
+};
+
+static const char *const strategy_names[] = {
+    [STRATEGY_TRACE] = "trace at frame time",
+    [STRATEGY_IMMEDIATE] = "immediate",
+    [STRATEGY_REPAINT] = "repaint",
+    [STRATEGY_RESAMPLE_NO_PREDICTION] = "resample, no prediction",
+    [STRATEGY_RESAMPLE] = "resample",
+};
+
+enum event_type {
+    EVENT_DOWN,
+    EVENT_MOTION,
+    EVENT_UP
+};
+
+#define NO_STROKE UINT32_MAX
+
+struct event {
+    int64_t time_us;
+    enum event_type type;
+    int id;
+    double x, y;
+    /* the events from the down to the up of a touch point are a stroke */
+    uint32_t stroke;
+};
+
+struct stroke {
+    /* struct ivi_input_resample_sample of the down and the motions */
+    struct wl_array samples;
+    int id;
+    bool down;
+
+    /* position shown by the frames */
+    double x, y;
+    /* positions shown by the last two frames, for the jitter */
+    uint32_t frames;
+    double x1, y1, x2, y2;
+
+    /* latest motion, held by the repaint mode */
+    bool held;
+    double held_x, held_y;
+};
+
+struct trace {
+    /* struct event, in the order of the trace */
+    struct wl_array events;
+    /* struct stroke */
+    struct wl_array strokes;
+};
+
+struct result {
+    uint64_t events;
+    uint64_t frames;
+    double error_sum;
+    double error_max;
+    uint64_t jitter_frames;
+    double jitter_sum;
+};
+
+static struct stroke *
+get_stroke(struct trace *trace, uint32_t index)
+{
+    return (struct stroke *)trace->strokes.data + index;
+}
+
+static uint32_t
+stroke_count(struct trace *trace)
+{
+    return trace->strokes.size / sizeof(struct stroke);
+}
+
+static int
+add_event(struct trace *trace, int64_t time_us, enum event_type type,
+          int id, double x, double y)
+{
+    struct event *event;
+
+    event = wl_array_add(&trace->events, sizeof *event);
+    if (event == NULL)
+        return -1;
+
+    event->time_us = time_us;
+    event->type = type;
+    event->id = id;
+    event->x = x;
+    event->y = y;
+    event->stroke = NO_STROKE;
+    return 0;
+}
+
+static uint32_t
+find_down_stroke(struct trace *trace, int id)
+{
+    uint32_t i;
+
+    for (i = stroke_count(trace); i > 0; i--) {
+        if (get_stroke(trace, i - 1)->down && get_stroke(trace, i - 1)->id == id)
+            return i - 1;
+    }
+    return NO_STROKE;
+}
+
+/* Splits the events into strokes. A motion without a down, of a point
+ * which was down when the recording started, starts a stroke as well. */
+static int
+split_strokes(struct trace *trace)
+{
+    struct ivi_input_resample_sample *sample;
+    struct stroke *stroke;
+    struct event *event;
+    uint32_t index;
+
+    wl_array_for_each(event, &trace->events) {
+        index = find_down_stroke(trace, event->id);
+
+        if (event->type == EVENT_UP) {
+            if (index != NO_STROKE)
+                get_stroke(trace, index)->down = false;
+            event->stroke = index;
+            continue;
+        }
+
+        if (event->type == EVENT_DOWN && index != NO_STROKE) {
+            get_stroke(trace, index)->down = false;
+            index = NO_STROKE;
+        }
+
+        if (index == NO_STROKE) {
+            stroke = wl_array_add(&trace->strokes, sizeof *stroke);
+            if (stroke == NULL)
+                return -1;
+            memset(stroke, 0, sizeof *stroke);
+            wl_array_init(&stroke->samples);
+            stroke->id = event->id;
+            stroke->down = true;
+            index = stroke_count(trace) - 1;
+            event->type = EVENT_DOWN;
+        }
+
+        stroke = get_stroke(trace, index);
+        sample = wl_array_add(&stroke->samples, sizeof *sample);
+        if (sample == NULL)
+            return -1;
+        sample->time_us = event->time_us;
+        sample->x = event->x;
+        sample->y = event->y;
+        event->stroke = index;
+    }
+
+    return 0;
+}
+
+static int
+load_trace(struct trace *trace, const char *path)
+{
+    struct ivi_input_record_header header;
+    struct ivi_input_record *record;
+    enum event_type type;
+    FILE *file;
+    char *buffer = NULL;
+    int ret = -1;
+    int id;
+
+    file = fopen(path, "rb");
+    if (file == NULL) {
+        fprintf(stderr, "failed to open %s\n", path);
+        return -1;
+    }
+
+    if (fread(&header, sizeof header, 1, file) != 1 ||
+        header.magic != IVI_INPUT_RECORD_MAGIC ||
+        header.version != IVI_INPUT_RECORD_VERSION ||
+        header.record_size < sizeof *record) {
+        fprintf(stderr, "%s is not an input trace\n", path);
+        goto out;
+    }
+
+    buffer = malloc(header.record_size);
+    if (buffer == NULL)
+        goto out;
+    record = (struct ivi_input_record *)buffer;
+
+    while (fread(buffer, header.record_size, 1, file) == 1) {
+        switch (record->type) {
+        case IVI_INPUT_RECORD_SEAT:
+            if (fseek(file, (record->args[0] + 7) & ~7, SEEK_CUR) != 0)
+                goto out;
+            continue;
+        case IVI_INPUT_RECORD_TOUCH_DOWN:
+            type = EVENT_DOWN;
+            break;
+        case IVI_INPUT_RECORD_TOUCH_MOTION:
+            type = EVENT_MOTION;
+            break;
+        case IVI_INPUT_RECORD_TOUCH_UP:
+            type = EVENT_UP;
+            break;
+        default:
+            continue;
+        }
+
+        /* touch ids are per seat */
+        id = (record->seat << 16) | (record->args[0] & 0xffff);
+        if (add_event(trace, record->time_us, type, id,
+                      wl_fixed_to_double(record->args[1]),
+                      wl_fixed_to_double(record->args[2])) < 0)
+            goto out;
+    }
+
+    ret = 0;
+out:
+    free(buffer);
+    fclose(file);
+    return ret;
+}
+
+/* A drag along a curve whose speed changes, sampled at GENERATED_RATE_HZ
+ * with a jitter of the timestamps of up to 1 ms, at the precision of
+ * wl_fixed_t */
+static double
+generated_position(double s, bool y)
+{
+    double value;
+
+    if (y)
+        value = 540.0 + 300.0 * sin(2.0 * M_PI * s / 1.5);
+    else
+        value = 200.0 + 1000.0 * s + 100.0 * sin(2.0 * M_PI * s);
+    return round(value * 256.0) / 256.0;
+}
+
+static int
+generate_trace(struct trace *trace)
+{
+    int64_t interval_us = 1000000 / GENERATED_RATE_HZ;
+    int64_t time_us;
+    double s;
+
+    srand(1);
+
+    if (add_event(trace, 0, EVENT_DOWN, 0, generated_position(0, false),
+                  generated_position(0, true)) < 0)
+        return -1;
+
+    for (time_us = interval_us; time_us < GENERATED_DURATION_US;
+         time_us += interval_us) {
+        s = (time_us + rand() % 2001 - 1000) / 1e6;
+        if (add_event(trace, (int64_t)(s * 1e6), EVENT_MOTION, 0,
+                      generated_position(s, false),
+                      generated_position(s, true)) < 0)
+            return -1;
+    }
+
+    return add_event(trace, GENERATED_DURATION_US, EVENT_UP, 0, 0, 0);
+}
+
+/* Position of the trace, interpolated at the time */
+static void
+trace_position(struct stroke *stroke, int64_t time_us, double *x, double *y)
+{
+    struct ivi_input_resample_sample *samples = stroke->samples.data;
+    uint32_t count = stroke->samples.size / sizeof *samples;
+    uint32_t low = 0;
+    uint32_t high = count - 1;
+    uint32_t middle;
+    double alpha;
+
+    if (time_us <= samples[0].time_us || count == 1) {
+        *x = samples[0].x;
+        *y = samples[0].y;
+        return;
+    }
+    if (time_us >= samples[count - 1].time_us) {
+        *x = samples[count - 1].x;
+        *y = samples[count - 1].y;
+        return;
+    }
+
+    /* samples[low].time_us <= time_us < samples[high].time_us */
+    while (high - low > 1) {
+        middle = (low + high) / 2;
+        if (samples[middle].time_us <= time_us)
+            low = middle;
+        else
+            high = middle;
+    }
+
+    alpha = (double)(time_us - samples[low].time_us) /
+            (double)(samples[high].time_us - samples[low].time_us);
+    *x = samples[low].x + (samples[high].x - samples[low].x) * alpha;
+    *y = samples[low].y + (samples[high].y - samples[low].y) * alpha;
+}
+
+static void
+show(struct stroke *stroke, double x, double y, struct result *result)
+{
+    stroke->x = x;
+    stroke->y = y;
+    result->events++;
+}
+
+static void
+feed_event(struct trace *trace, struct ivi_input_resampler *resampler,
+           enum strategy strategy, struct event *event,
+           struct wl_array *active, struct result *result)
+{
+    struct ivi_input_resample_point *point;
+    struct ivi_input_resample_sample sample;
+    struct stroke *stroke;
+    uint32_t *index;
+
+    if (event->stroke == NO_STROKE)
+        return;
+    stroke = get_stroke(trace, event->stroke);
+
+    switch (event->type) {
+    case EVENT_DOWN:
+        index = wl_array_add(active, sizeof *index);
+        if (index != NULL)
+            *index = event->stroke;
+        stroke->down = true;
+        stroke->x = event->x;
+        stroke->y = event->y;
+        stroke->frames = 0;
+        stroke->held = false;
+        /* the resampler knows the points by their stroke */
+        if (strategy >= STRATEGY_RESAMPLE_NO_PREDICTION)
+            ivi_input_resampler_down(resampler, event->stroke,
+                                     event->time_us, event->x, event->y);
+        break;
+
+    case EVENT_MOTION:
+        if (strategy == STRATEGY_IMMEDIATE) {
+            show(stroke, event->x, event->y, result);
+        } else if (strategy == STRATEGY_REPAINT) {
+            stroke->held = true;
+            stroke->held_x = event->x;
+            stroke->held_y = event->y;
+        } else if (strategy >= STRATEGY_RESAMPLE_NO_PREDICTION) {
+            ivi_input_resampler_motion(resampler, event->stroke,
+                                       event->time_us, event->x, event->y);
+        }
+        break;
+
+    case EVENT_UP:
+        /* held motion is sent in front of the up */
+        if (stroke->held)
+            show(stroke, stroke->held_x, stroke->held_y, result);
+        stroke->held = false;
+        wl_array_for_each(point, &resampler->points) {
+            if (point->touch_id == (int)event->stroke &&
+                ivi_input_resampler_settle(point, &sample))
+                show(stroke, sample.x, sample.y, result);
+        }
+        ivi_input_resampler_up(resampler, event->stroke);
+
+        stroke->down = false;
+        wl_array_for_each(index, active) {
+            if (*index == event->stroke) {
+                *index = ((uint32_t *)active->data)
+                         [active->size / sizeof *index - 1];
+                active->size -= sizeof *index;
+                break;
+            }
+        }
+        break;
+    }
+}
+
+static void
+show_frame(struct trace *trace, struct ivi_input_resampler *resampler,
+           enum strategy strategy, int64_t frame_us,
+           struct wl_array *active, struct result *result)
+{
+    struct ivi_input_resample_point *point;
+    struct ivi_input_resample_sample sample;
+    struct stroke *stroke;
+    uint32_t *index;
+    double x, y;
+    double distance;
+
+    if (strategy >= STRATEGY_RESAMPLE_NO_PREDICTION) {
+        wl_array_for_each(point, &resampler->points) {
+            if (ivi_input_resampler_sample(resampler, point, frame_us,
+                                           &sample))
+                show(get_stroke(trace, point->touch_id),
+                     sample.x, sample.y, result);
+        }
+    }
+
+    wl_array_for_each(index, active) {
+        stroke = get_stroke(trace, *index);
+        trace_position(stroke, frame_us, &x, &y);
+
+        if (strategy == STRATEGY_TRACE) {
+            stroke->x = x;
+            stroke->y = y;
+        } else if (stroke->held) {
+            show(stroke, stroke->held_x, stroke->held_y, result);
+            stroke->held = false;
+        }
+
+        distance = hypot(stroke->x - x, stroke->y - y);
+        result->error_sum += distance;
+        if (distance > result->error_max)
+            result->error_max = distance;
+        result->frames++;
+
+        if (stroke->frames >= 2) {
+            result->jitter_sum += hypot(stroke->x - 2 * stroke->x1 + stroke->x2,
+                                        stroke->y - 2 * stroke->y1 + stroke->y2);
+            result->jitter_frames++;
+        }
+        stroke->x2 = stroke->x1;
+        stroke->y2 = stroke->y1;
+        stroke->x1 = stroke->x;
+        stroke->y1 = stroke->y;
+        stroke->frames++;
+    }
+}
+
+static void
+simulate(struct trace *trace, enum strategy strategy, int64_t period_us,
+         int64_t phase_us, struct result *result)
+{
+    struct ivi_input_resampler resampler;
+    struct event *events = trace->events.data;
+    uint32_t count = trace->events.size / sizeof *events;
+    struct wl_array active;
+    uint32_t i = 0;
+    int64_t frame_us;
+    int64_t end_us = events[count - 1].time_us + period_us;
+
+    ivi_input_resampler_init(&resampler);
+    if (strategy == STRATEGY_RESAMPLE_NO_PREDICTION)
+        resampler.max_prediction_us = 0;
+    wl_array_init(&active);
+
+    for (frame_us = events[0].time_us + phase_us; frame_us <= end_us;
+         frame_us += period_us) {
+        for (; i < count && events[i].time_us <= frame_us; i++)
+            feed_event(trace, &resampler, strategy, &events[i], &active,
+                       result);
+        show_frame(trace, &resampler, strategy, frame_us, &active, result);
+    }
+
+    wl_array_release(&active);
+    ivi_input_resampler_release(&resampler);
+}
+
+int
+main(int argc, char **argv)
+{
+    struct result results[STRATEGIES];
+    struct result *result;
+    struct trace trace;
+    struct stroke *stroke;
+    double refresh_hz = DEFAULT_REFRESH_HZ;
+    int64_t period_us;
+    int strategy;
+    int phase;
+    int ret = 1;
+
+    wl_array_init(&trace.events);
+    wl_array_init(&trace.strokes);
+
+    if (argc > 2)
+        refresh_hz = atof(argv[2]);
+    if (refresh_hz <= 0) {
+        fprintf(stderr, "invalid refresh rate %s\n", argv[2]);
+        return 1;
+    }
+    period_us = (int64_t)(1e6 / refresh_hz);
+
+    if ((argc > 1 ? load_trace(&trace, argv[1]) : generate_trace(&trace)) < 0 ||
+        split_strokes(&trace) < 0) {
+        fprintf(stderr, "failed to read the touch events\n");
+        goto out;
+    }
+    if (trace.events.size == 0) {
+        fprintf(stderr, "the trace has no touch events\n");
+        goto out;
+    }
+
+    memset(results, 0, sizeof results);
+    for (strategy = 0; strategy < STRATEGIES; strategy++) {
+        for (phase = 0; phase < PHASES; phase++) {
+            simulate(&trace, strategy, period_us, period_us * phase / PHASES,
+                     &results[strategy]);
+        }
+    }
+
+    printf("%s, %zu touch events in %u strokes, frames at %.1f Hz\n",
+           argc > 1 ? argv[1] : "generated drag at 90 Hz",
+           trace.events.size / sizeof(struct event), stroke_count(&trace),
+           refresh_hz);
+    printf("%-24s %8s %12s %10s %10s\n",
+           "mode", "events", "error mean", "error max", "jitter");
+    for (strategy = 0; strategy < STRATEGIES; strategy++) {
+        result = &results[strategy];
+        printf("%-24s %8.1f %12.2f %10.2f %10.3f\n", strategy_names[strategy],
+               (double)result->events / PHASES,
+               result->frames ? result->error_sum / result->frames : 0.0,
+               result->error_max,
+               result->jitter_frames ?
+                   result->jitter_sum / result->jitter_frames : 0.0);
+    }
+    ret = 0;
+
+out:
+    wl_array_for_each(stroke, &trace.strokes)
+        wl_array_release(&stroke->samples);
+    wl_array_release(&trace.strokes);
+    wl_array_release(&trace.events);
+    return ret;
+}
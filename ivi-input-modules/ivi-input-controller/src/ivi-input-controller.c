@@ -21,6 +21,7 @@
  * CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
  */
 
+#include <math.h>
 #include <stdlib.h>
 #include <string.h>
 
@@ -36,6 +37,64 @@
 
 #include "ivi-input-server-protocol.h"
 #include "ivi-controller.h"
+#include "ivi-input-focus.h"
+#include "ivi-input-index.h"
+#include "ivi-input-replay.h"
+#include "ivi-input-resample.h"
+
+/* Delivery of touch motion events of a seat, set with touch-motion in an
+ * [ivi-input] section of weston.ini */
+enum touch_motion_mode {
+    /* every motion is sent as it arrives */
+    TOUCH_MOTION_IMMEDIATE,
+    /* the last motion of every touch point is sent with the touch frame */
+    TOUCH_MOTION_COALESCE,
+    /* the last motion of every touch point is sent when the output
+     * showing the touch focus has repainted */
+    TOUCH_MOTION_REPAINT,
+    /* like repaint, but every touch point is sent at its position at the
+     * time of the repaint, see ivi-input-resample.h */
+    TOUCH_MOTION_RESAMPLE
+};
+
+/* Histogram of the time from the timestamp of an input event until it is
+ * sent to a client. Bucket 0 counts events sent within
+ * INPUT_LATENCY_BUCKET0_US, every further bucket doubles the limit, the
+ * last one counts all slower events. */
+#define INPUT_LATENCY_BUCKETS 16
+#define INPUT_LATENCY_BUCKET0_US 64
+
+/* Clock of the timestamps libinput gives input events, which is not the
+ * presentation clock of the compositor */
+#define INPUT_CLOCK CLOCK_MONOTONIC
+
+/* payload of one input_acceptance_batch event, below the message size
+ * limit of 4096 bytes */
+#define MAX_ACCEPTANCE_BATCH_SIZE 2048
+
+/* indexed like the bits of ILM_INPUT_DEVICE_* */
+enum input_latency_device {
+    INPUT_LATENCY_KEYBOARD,
+    INPUT_LATENCY_POINTER,
+    INPUT_LATENCY_TOUCH,
+    INPUT_LATENCY_DEVICES
+};
+
+struct input_latency {
+    uint32_t buckets[INPUT_LATENCY_BUCKETS];
+    uint32_t count;
+    uint32_t max_us;
+    uint64_t sum_us;
+};
+
+struct pending_touch_motion {
+    int touch_id;
+    struct timespec time;
+    /* time of the newest real sample, the input latency is measured from.
+     * Resampled motions get a synthesized time. */
+    struct timespec input_time;
+    struct weston_coord_global pos;
+};
 
 struct seat_ctx {
     struct input_context *input_ctx;
@@ -43,6 +102,8 @@ struct seat_ctx {
     struct weston_pointer_grab pointer_grab;
     struct weston_touch_grab touch_grab;
     struct weston_seat *west_seat;
+    /* lowest number not used by another seat, sent with seat_id */
+    uint32_t id;
 
     /* pointer focus can be forced to specific surfaces
      * when there are no motion events at all. motion
@@ -52,20 +113,80 @@ struct seat_ctx {
     struct ivisurface *forced_ptr_focus_surf;
     int32_t  forced_surf_enabled;
 
+    /* seat_focus::entry of the surfaces with keyboard or pointer focus of
+     * this seat, which receive key and modifier events */
+    struct ivi_input_focus_index focus_index;
+
+    /* kbd_client::link of the clients key events were sent to */
+    struct wl_list kbd_clients;
+
+    enum touch_motion_mode touch_motion_mode;
+    /* struct pending_touch_motion, at most one per touch point */
+    struct wl_array pending_motions;
+    /* samples of the touch points, in TOUCH_MOTION_RESAMPLE */
+    struct ivi_input_resampler resampler;
+    /* events were sent since the last wl_touch.frame */
+    bool touch_unframed;
+    struct weston_output *touch_flush_output;
+    struct wl_listener touch_flush_listener;
+    struct wl_listener touch_output_destroy_listener;
+    uint32_t touch_motions;
+    uint32_t merged_touch_motions;
+
+    struct input_latency latency[INPUT_LATENCY_DEVICES];
+
+    /* a surface accepted this seat during a batch of acceptance changes */
+    bool refocus_pending;
+
     struct wl_listener updated_caps_listener;
     struct wl_listener destroy_listener;
     struct wl_list seat_node;
 };
 
+/* A change of input acceptance, broadcast at the end of the dispatch
+ * cycle */
+struct pending_acceptance {
+    /* NULL if the surface or the seat was destroyed meanwhile */
+    struct ivisurface *surface;
+    struct seat_ctx *seat_ctx;
+    /* acceptance before the first change in this cycle */
+    bool initial;
+};
+
 struct seat_focus {
     struct seat_ctx *seat_ctx;
-    ilmInputDevice focus;
+    struct ivisurface *surface;
+    /* ILM_INPUT_DEVICE_* bits in entry.focus */
+    struct ivi_input_focus_entry entry;
+    struct wl_list link;
+};
+
+/* The wl_keyboard resources of one client for one seat, so key events to
+ * a surface of the client do not scan the resources of every client */
+struct kbd_client {
+    struct seat_ctx *seat_ctx;
+    struct wl_client *client;
     struct wl_list link;
+    /* kbd_client_resource::link, valid unless the client created a
+     * wl_keyboard since it was filled */
+    struct wl_list resources;
+    bool valid;
+
+    struct wl_listener resource_created;
+    struct wl_listener client_destroyed;
+};
+
+struct kbd_client_resource {
+    struct wl_resource *resource;
+    struct wl_list link;
+    struct wl_listener destroy_listener;
 };
 
 struct input_context {
     struct wl_list resource_list;
     struct wl_list seat_list;
+    /* struct seat_ctx *, indexed by seat_ctx::id, NULL for free ids */
+    struct wl_array seats_by_id;
     int successful_init_stage;
     struct ivishell *ivishell;
 
@@ -73,8 +194,42 @@ struct input_context {
     struct wl_listener surface_destroyed;
     struct wl_listener shell_destroy_listener;
     struct wl_listener seat_create_listener;
+    struct wl_listener scene_changed;
 
     char *seat_default_name;
+
+    /* input rectangles of the ivi surfaces, rebuilt on the first pick
+     * after the scene changed or an output was repainted */
+    struct ivi_input_index pick_index;
+    bool pick_index_dirty;
+    /* struct pick_output */
+    struct wl_list pick_outputs;
+    struct wl_listener output_created;
+
+    /* debug scope ivi-input-touch */
+    struct weston_log_scope *touch_scope;
+    /* debug scope ivi-input-latency */
+    struct weston_log_scope *latency_scope;
+
+    /* set with input-record in the [ivi-shell] section of weston.ini */
+    struct ivi_input_recorder *recorder;
+    /* set with input-replay in the [ivi-shell] section of weston.ini */
+    bool replay_enabled;
+    struct ivi_input_player *player;
+    /* the ivi_input resource which requested the running replay */
+    struct wl_resource *replay_resource;
+
+    /* struct pending_acceptance, flushed by acceptance_idle */
+    struct wl_array pending_acceptance;
+    struct wl_event_source *acceptance_idle;
+};
+
+/* Dirties the pick index when its output is repainted */
+struct pick_output {
+    struct input_context *ctx;
+    struct wl_listener frame_listener;
+    struct wl_listener destroy_listener;
+    struct wl_list link;
 };
 
 enum kbd_events {
@@ -96,65 +251,173 @@ struct wl_keyboard_data {
     uint32_t serial;
 };
 
+/* Sets of seat ids. Ids from 32 on are bits of the uint32_t words in
+ * high, starting with id 32. */
+static void
+seat_mask_init(struct ivi_seat_mask *mask)
+{
+    mask->low = 0;
+    wl_array_init(&mask->high);
+}
+
+static void
+seat_mask_release(struct ivi_seat_mask *mask)
+{
+    wl_array_release(&mask->high);
+    seat_mask_init(mask);
+}
+
+static bool
+seat_mask_test(const struct ivi_seat_mask *mask, uint32_t id)
+{
+    const uint32_t *words = mask->high.data;
+
+    if (id < 32)
+        return (mask->low & (1u << id)) != 0;
+
+    id -= 32;
+    if (id / 32 >= mask->high.size / sizeof *words)
+        return false;
+    return (words[id / 32] & (1u << (id % 32))) != 0;
+}
+
+static int
+seat_mask_set(struct ivi_seat_mask *mask, uint32_t id)
+{
+    uint32_t *words;
+
+    if (id < 32) {
+        mask->low |= 1u << id;
+        return 0;
+    }
+
+    id -= 32;
+    while (id / 32 >= mask->high.size / sizeof *words) {
+        words = wl_array_add(&mask->high, sizeof *words);
+        if (words == NULL)
+            return -1;
+        *words = 0;
+    }
+
+    words = mask->high.data;
+    words[id / 32] |= 1u << (id % 32);
+    return 0;
+}
+
+static void
+seat_mask_clear(struct ivi_seat_mask *mask, uint32_t id)
+{
+    uint32_t *words = mask->high.data;
+
+    if (id < 32) {
+        mask->low &= ~(1u << id);
+        return;
+    }
+
+    id -= 32;
+    if (id / 32 < mask->high.size / sizeof *words)
+        words[id / 32] &= ~(1u << (id % 32));
+}
+
 static struct seat_focus *
-get_accepted_seat(struct ivisurface *surface, struct seat_ctx *seat_ctx)
+find_seat_focus(struct ivisurface *surface, struct seat_ctx *seat_ctx)
 {
     struct seat_focus *st_focus;
-    struct seat_focus *ret_focus = NULL;
 
     wl_list_for_each(st_focus, &surface->accepted_seat_list, link) {
-        if (st_focus->seat_ctx == seat_ctx) {
-            ret_focus = st_focus;
-            break;
-        }
+        if (st_focus->seat_ctx == seat_ctx)
+            return st_focus;
     }
-    return ret_focus;
+    return NULL;
 }
 
-static int
-add_accepted_seat(struct ivisurface *surface, struct seat_ctx *seat_ctx)
+/* The focus of an accepted seat on the surface. Acceptance is the bit of
+ * the seat in accepted_seat_mask, its seat_focus is allocated the first
+ * time the focus is needed, so surfaces which never get input cost no
+ * allocation. Paths which only take focus away use find_seat_focus(). */
+static struct seat_focus *
+get_or_create_seat_focus(struct ivisurface *surface,
+                         struct seat_ctx *seat_ctx)
 {
     const struct ivi_layout_interface *interface =
         surface->shell->interface;
     struct seat_focus *st_focus;
-    int ret = 0;
 
-    st_focus = get_accepted_seat(surface, seat_ctx);
+    if (!seat_mask_test(&surface->accepted_seat_mask, seat_ctx->id))
+        return NULL;
+
+    st_focus = find_seat_focus(surface, seat_ctx);
+    if (st_focus != NULL)
+        return st_focus;
+
+    st_focus = calloc(1, sizeof(*st_focus));
     if (st_focus == NULL) {
-        st_focus = calloc(1, sizeof(*st_focus));
+        weston_log("%s Failed to allocate memory for focus of seat '%s' on surface %d\n",
+                   __FUNCTION__, seat_ctx->west_seat->seat_name,
+                   interface->get_id_of_surface(surface->layout_surface));
+        return NULL;
+    }
 
-        if (NULL != st_focus) {
-            st_focus->seat_ctx = seat_ctx;
-            wl_list_insert(&surface->accepted_seat_list, &st_focus->link);
-            ret = 1;
-       } else {
-            weston_log("%s Failed to allocate memory for seat addition of surface %d",
-                    __FUNCTION__, interface->get_id_of_surface(surface->layout_surface));
-        }
-    } else {
+    st_focus->seat_ctx = seat_ctx;
+    st_focus->surface = surface;
+    wl_list_insert(&surface->accepted_seat_list, &st_focus->link);
+    ivi_input_focus_entry_init(&st_focus->entry);
+
+    return st_focus;
+}
+
+/* Keeps seat_ctx::focus_index in sync with the focus of st_focus */
+static void
+update_focus_index(struct seat_focus *st_focus)
+{
+    ivi_input_focus_index_update(&st_focus->seat_ctx->focus_index,
+                                 &st_focus->entry);
+}
+
+static void
+free_seat_focus(struct seat_focus *st_focus)
+{
+    wl_list_remove(&st_focus->link);
+    ivi_input_focus_entry_remove(&st_focus->entry);
+    free(st_focus);
+}
+
+static int
+add_accepted_seat(struct ivisurface *surface, struct seat_ctx *seat_ctx)
+{
+    const struct ivi_layout_interface *interface =
+        surface->shell->interface;
+
+    if (seat_mask_test(&surface->accepted_seat_mask, seat_ctx->id)) {
         weston_log("%s: Warning: seat '%s' is already accepted by surface %d\n",
                    __FUNCTION__, seat_ctx->west_seat->seat_name,
                    interface->get_id_of_surface(surface->layout_surface));
-        ret = 1;
+        return 1;
     }
 
-    return ret;
+    if (seat_mask_set(&surface->accepted_seat_mask, seat_ctx->id) < 0) {
+        weston_log("%s Failed to allocate memory for seat addition of surface %d",
+                   __FUNCTION__, interface->get_id_of_surface(surface->layout_surface));
+        return 0;
+    }
+
+    return 1;
 }
 
 static int
 remove_if_seat_accepted(struct ivisurface *surface, struct seat_ctx *seat_ctx)
 {
-    int ret = 0;
+    struct seat_focus *st_focus;
 
-    struct seat_focus *st_focus = get_accepted_seat(surface, seat_ctx);
+    if (!seat_mask_test(&surface->accepted_seat_mask, seat_ctx->id))
+        return 0;
 
-    if (NULL != st_focus) {
-        ret = 1;
-        wl_list_remove(&st_focus->link);
-        free(st_focus);
+    st_focus = find_seat_focus(surface, seat_ctx);
+    if (NULL != st_focus)
+        free_seat_focus(st_focus);
 
-    }
-    return ret;
+    seat_mask_clear(&surface->accepted_seat_mask, seat_ctx->id);
+    return 1;
 }
 
 struct seat_ctx*
@@ -171,13 +434,221 @@ input_ctrl_get_seat_ctx(struct input_context *ctx, const char *nm_seat)
     return ret_ctx;
 }
 
+static struct seat_ctx *
+input_ctrl_get_seat_ctx_from_id(struct input_context *ctx, uint32_t id)
+{
+    struct seat_ctx **seats = ctx->seats_by_id.data;
+
+    if (id >= ctx->seats_by_id.size / sizeof *seats)
+        return NULL;
+    return seats[id];
+}
+
+/* Makes seat_ctx the seat of its id, or frees the id if seat_ctx is
+ * NULL */
+static int
+set_seat_ctx_of_id(struct input_context *ctx, uint32_t id,
+                   struct seat_ctx *seat_ctx)
+{
+    struct seat_ctx **seats;
+    size_t count = ctx->seats_by_id.size / sizeof *seats;
+    size_t size;
+
+    if (id >= count) {
+        if (seat_ctx == NULL)
+            return 0;
+        size = (id + 1 - count) * sizeof *seats;
+        seats = wl_array_add(&ctx->seats_by_id, size);
+        if (seats == NULL)
+            return -1;
+        memset(seats, 0, size);
+    }
+
+    seats = ctx->seats_by_id.data;
+    seats[id] = seat_ctx;
+    return 0;
+}
+
+/* An entry of input_acceptance_batch and set_input_acceptance_batch */
+struct acceptance_entry {
+    uint32_t surface;
+    int32_t accepted;
+    uint32_t seat_id;
+};
+
+static int
+add_acceptance_entry(struct wl_array *entries, uint32_t surface,
+                     uint32_t seat_id, int32_t accepted)
+{
+    struct acceptance_entry *entry;
+
+    entry = wl_array_add(entries, sizeof *entry);
+    if (entry == NULL)
+        return -1;
+
+    entry->surface = surface;
+    entry->accepted = accepted;
+    entry->seat_id = seat_id;
+    return 0;
+}
+
+/* Sends entries of add_acceptance_entry() with input_acceptance_batch
+ * events of at most MAX_ACCEPTANCE_BATCH_SIZE bytes, or with single
+ * input_acceptance events to clients of older versions */
+static void
+send_acceptance_entries(struct input_context *ctx,
+                        struct wl_resource *resource,
+                        struct wl_array *entries)
+{
+    struct acceptance_entry *entry;
+    struct seat_ctx *seat_ctx;
+    struct wl_array chunk;
+    size_t max = MAX_ACCEPTANCE_BATCH_SIZE / sizeof *entry * sizeof *entry;
+    size_t offset;
+
+    if (wl_resource_get_version(resource) <
+        IVI_INPUT_INPUT_ACCEPTANCE_BATCH_SINCE_VERSION) {
+        wl_array_for_each(entry, entries) {
+            seat_ctx = input_ctrl_get_seat_ctx_from_id(ctx, entry->seat_id);
+            if (seat_ctx == NULL)
+                continue;
+            ivi_input_send_input_acceptance(resource, entry->surface,
+                                            seat_ctx->west_seat->seat_name,
+                                            entry->accepted);
+        }
+        return;
+    }
+
+    chunk.alloc = 0;
+    for (offset = 0; offset < entries->size; offset += chunk.size) {
+        chunk.data = (char *)entries->data + offset;
+        chunk.size = entries->size - offset < max ?
+                     entries->size - offset : max;
+        ivi_input_send_input_acceptance_batch(resource, &chunk);
+    }
+}
+
 static void
-send_input_acceptance(struct input_context *ctx, uint32_t surface_id, const char *seat, int32_t accepted)
+flush_input_acceptance(struct input_context *ctx)
 {
+    const struct ivi_layout_interface *interface =
+        ctx->ivishell->interface;
+    struct pending_acceptance *pending;
     struct wl_resource *resource;
-    wl_resource_for_each(resource, &ctx->resource_list) {
-        ivi_input_send_input_acceptance(resource, surface_id, seat,
-                                        accepted);
+    struct wl_array entries;
+    bool accepted;
+
+    if (ctx->acceptance_idle) {
+        wl_event_source_remove(ctx->acceptance_idle);
+        ctx->acceptance_idle = NULL;
+    }
+
+    wl_array_init(&entries);
+    wl_array_for_each(pending, &ctx->pending_acceptance) {
+        if (pending->surface == NULL)
+            continue;
+
+        seat_mask_clear(&pending->surface->acceptance_pending,
+                        pending->seat_ctx->id);
+        accepted = seat_mask_test(&pending->surface->accepted_seat_mask,
+                                  pending->seat_ctx->id);
+        /* changed back and forth within the cycle */
+        if (accepted == pending->initial)
+            continue;
+
+        if (add_acceptance_entry(&entries,
+                interface->get_id_of_surface(pending->surface->layout_surface),
+                pending->seat_ctx->id,
+                accepted ? ILM_TRUE : ILM_FALSE) < 0)
+            weston_log("%s: Failed to allocate memory for acceptance event\n",
+                       __FUNCTION__);
+    }
+    ctx->pending_acceptance.size = 0;
+
+    if (entries.size > 0) {
+        wl_resource_for_each(resource, &ctx->resource_list) {
+            send_acceptance_entries(ctx, resource, &entries);
+        }
+    }
+    wl_array_release(&entries);
+}
+
+static void
+flush_input_acceptance_idle(void *data)
+{
+    struct input_context *ctx = data;
+
+    /* the event loop removes the idle source after this call */
+    ctx->acceptance_idle = NULL;
+    flush_input_acceptance(ctx);
+}
+
+/* Broadcasts a change of the acceptance of seat_ctx by surface, once the
+ * current dispatch cycle is done, or at the end of the acceptance request
+ * which made the change. Several changes of many surfaces are sent as few
+ * input_acceptance_batch events, changes which are undone before are not
+ * sent at all. */
+static void
+queue_input_acceptance(struct input_context *ctx, struct ivisurface *surface,
+                       struct seat_ctx *seat_ctx, bool initial)
+{
+    const struct ivi_layout_interface *interface =
+        ctx->ivishell->interface;
+    struct wl_event_loop *loop;
+    struct pending_acceptance *pending;
+    struct wl_resource *resource;
+    bool accepted;
+
+    if (seat_mask_test(&surface->acceptance_pending, seat_ctx->id))
+        return;
+
+    pending = wl_array_add(&ctx->pending_acceptance, sizeof *pending);
+    if (pending == NULL ||
+        seat_mask_set(&surface->acceptance_pending, seat_ctx->id) < 0) {
+        /* out of memory, send the change on its own */
+        if (pending != NULL)
+            ctx->pending_acceptance.size -= sizeof *pending;
+        flush_input_acceptance(ctx);
+
+        accepted = seat_mask_test(&surface->accepted_seat_mask, seat_ctx->id);
+        if (accepted == initial)
+            return;
+        wl_resource_for_each(resource, &ctx->resource_list) {
+            ivi_input_send_input_acceptance(resource,
+                interface->get_id_of_surface(surface->layout_surface),
+                seat_ctx->west_seat->seat_name,
+                accepted ? ILM_TRUE : ILM_FALSE);
+        }
+        return;
+    }
+    pending->surface = surface;
+    pending->seat_ctx = seat_ctx;
+    pending->initial = initial;
+
+    if (ctx->acceptance_idle == NULL) {
+        loop = wl_display_get_event_loop(ctx->ivishell->compositor->wl_display);
+        ctx->acceptance_idle =
+            wl_event_loop_add_idle(loop, flush_input_acceptance_idle, ctx);
+        if (ctx->acceptance_idle == NULL)
+            flush_input_acceptance(ctx);
+    }
+}
+
+/* Forgets the changes of a destroyed surface or seat */
+static void
+drop_pending_acceptance(struct input_context *ctx, struct ivisurface *surface,
+                        struct seat_ctx *seat_ctx)
+{
+    struct pending_acceptance *pending;
+
+    wl_array_for_each(pending, &ctx->pending_acceptance) {
+        if (pending->surface == NULL ||
+            (pending->surface != surface && pending->seat_ctx != seat_ctx))
+            continue;
+
+        seat_mask_clear(&pending->surface->acceptance_pending,
+                        pending->seat_ctx->id);
+        pending->surface = NULL;
     }
 }
 
@@ -198,15 +669,7 @@ static struct ivisurface *
 input_ctrl_get_surf_ctx(struct input_context *ctx,
         struct ivi_layout_surface *lyt_surf)
 {
-    struct ivisurface *surf_ctx = NULL;
-    struct ivisurface *ret_ctx = NULL;
-    wl_list_for_each(surf_ctx, &ctx->ivishell->list_surface, link) {
-        if (lyt_surf == surf_ctx->layout_surface) {
-            ret_ctx = surf_ctx;
-            break;
-        }
-    }
-    return ret_ctx;
+    return ivishell_get_surface(ctx->ivishell, lyt_surf);
 }
 
 
@@ -214,11 +677,7 @@ static struct ivisurface *
 input_ctrl_get_surf_ctx_from_id(struct input_context *ctx,
         uint32_t ivi_surf_id)
 {
-    const struct ivi_layout_interface *interface = ctx->ivishell->interface;
-    struct ivi_layout_surface *lyt_surf;
-    lyt_surf = interface->get_surface_from_id(ivi_surf_id);
-
-    return input_ctrl_get_surf_ctx(ctx, lyt_surf);
+    return ivishell_get_surface_from_id(ctx->ivishell, ivi_surf_id);
 }
 
 
@@ -239,6 +698,53 @@ input_ctrl_get_surf_ctx_from_surf(struct input_context *ctx,
     return surf_ctx;
 }
 
+static void
+record_input_latency(struct seat_ctx *ctx_seat,
+                     enum input_latency_device device,
+                     const struct timespec *time)
+{
+    struct input_latency *latency = &ctx_seat->latency[device];
+    struct timespec now;
+    int64_t delta_us;
+    int64_t limit_us = INPUT_LATENCY_BUCKET0_US;
+    uint32_t bucket = 0;
+
+    /* synthesized events have no timestamp */
+    if (time->tv_sec == 0 && time->tv_nsec == 0)
+        return;
+
+    clock_gettime(INPUT_CLOCK, &now);
+    delta_us = timespec_to_usec(&now) - timespec_to_usec(time);
+    /* backends without libinput stamp events with another clock */
+    if (delta_us < 0)
+        return;
+    if (delta_us > UINT32_MAX)
+        delta_us = UINT32_MAX;
+
+    while (bucket < INPUT_LATENCY_BUCKETS - 1 && delta_us >= limit_us) {
+        bucket++;
+        limit_us *= 2;
+    }
+
+    latency->buckets[bucket]++;
+    latency->count++;
+    latency->sum_us += delta_us;
+    if (delta_us > latency->max_us)
+        latency->max_us = delta_us;
+}
+
+static void
+record_input(struct seat_ctx *ctx_seat, enum ivi_input_record_type type,
+             const struct timespec *time,
+             int32_t arg0, int32_t arg1, int32_t arg2)
+{
+    struct ivi_input_recorder *recorder = ctx_seat->input_ctx->recorder;
+
+    if (recorder)
+        ivi_input_recorder_add(recorder, ctx_seat->west_seat, type, time,
+                               arg0, arg1, arg2);
+}
+
 static void
 input_ctrl_kbd_snd_event_resource(struct seat_ctx *ctx_seat,
         struct weston_keyboard *keyboard, struct wl_resource *resource,
@@ -290,6 +796,142 @@ input_ctrl_kbd_snd_event_resource(struct seat_ctx *ctx_seat,
 }
 
 
+static void
+kbd_client_clear_resources(struct kbd_client *kbd_client)
+{
+    struct kbd_client_resource *kbd_res, *next;
+
+    wl_list_for_each_safe(kbd_res, next, &kbd_client->resources, link) {
+        wl_list_remove(&kbd_res->destroy_listener.link);
+        wl_list_remove(&kbd_res->link);
+        free(kbd_res);
+    }
+    kbd_client->valid = false;
+}
+
+static void
+kbd_client_destroy(struct kbd_client *kbd_client)
+{
+    kbd_client_clear_resources(kbd_client);
+    wl_list_remove(&kbd_client->resource_created.link);
+    wl_list_remove(&kbd_client->client_destroyed.link);
+    wl_list_remove(&kbd_client->link);
+    free(kbd_client);
+}
+
+static void
+kbd_client_handle_resource_destroy(struct wl_listener *listener, void *data)
+{
+    struct kbd_client_resource *kbd_res =
+            wl_container_of(listener, kbd_res, destroy_listener);
+
+    wl_list_remove(&kbd_res->destroy_listener.link);
+    wl_list_remove(&kbd_res->link);
+    free(kbd_res);
+}
+
+static void
+kbd_client_handle_resource_created(struct wl_listener *listener, void *data)
+{
+    struct kbd_client *kbd_client =
+            wl_container_of(listener, kbd_client, resource_created);
+    struct wl_resource *resource = data;
+
+    /* weston adds the resource to the lists of the keyboard only after
+     * creating it, collect it with the next event */
+    if (wl_resource_get_class(resource) == wl_keyboard_interface.name)
+        kbd_client->valid = false;
+}
+
+static void
+kbd_client_handle_client_destroy(struct wl_listener *listener, void *data)
+{
+    struct kbd_client *kbd_client =
+            wl_container_of(listener, kbd_client, client_destroyed);
+
+    kbd_client_destroy(kbd_client);
+}
+
+static void
+kbd_client_add_resources(struct kbd_client *kbd_client,
+                         struct wl_list *resource_list)
+{
+    struct kbd_client_resource *kbd_res;
+    struct wl_resource *resource;
+
+    wl_resource_for_each(resource, resource_list) {
+        if (wl_resource_get_client(resource) != kbd_client->client)
+            continue;
+
+        kbd_res = calloc(1, sizeof *kbd_res);
+        if (kbd_res == NULL) {
+            kbd_client_clear_resources(kbd_client);
+            return;
+        }
+
+        kbd_res->resource = resource;
+        kbd_res->destroy_listener.notify = kbd_client_handle_resource_destroy;
+        wl_resource_add_destroy_listener(resource, &kbd_res->destroy_listener);
+        wl_list_insert(kbd_client->resources.prev, &kbd_res->link);
+    }
+}
+
+/* Returns the filled resource cache of client for this seat, or NULL if
+ * it can not be allocated */
+static struct kbd_client *
+get_kbd_client(struct seat_ctx *ctx_seat, struct weston_keyboard *keyboard,
+               struct wl_client *client)
+{
+    struct kbd_client *kbd_client;
+    bool found = false;
+
+    wl_list_for_each(kbd_client, &ctx_seat->kbd_clients, link) {
+        if (kbd_client->client == client) {
+            found = true;
+            break;
+        }
+    }
+
+    if (!found) {
+        kbd_client = calloc(1, sizeof *kbd_client);
+        if (kbd_client == NULL)
+            return NULL;
+
+        kbd_client->seat_ctx = ctx_seat;
+        kbd_client->client = client;
+        wl_list_init(&kbd_client->resources);
+        kbd_client->resource_created.notify =
+                kbd_client_handle_resource_created;
+        wl_client_add_resource_created_listener(client,
+                &kbd_client->resource_created);
+        kbd_client->client_destroyed.notify = kbd_client_handle_client_destroy;
+        wl_client_add_destroy_listener(client, &kbd_client->client_destroyed);
+        wl_list_insert(&ctx_seat->kbd_clients, &kbd_client->link);
+    }
+
+    if (!kbd_client->valid) {
+        kbd_client_clear_resources(kbd_client);
+        kbd_client->valid = true;
+        kbd_client_add_resources(kbd_client, &keyboard->focus_resource_list);
+        if (kbd_client->valid)
+            kbd_client_add_resources(kbd_client, &keyboard->resource_list);
+        if (!kbd_client->valid)
+            return NULL;
+    }
+
+    return kbd_client;
+}
+
+/* Drops the resource caches of a seat whose keyboard changed */
+static void
+clear_kbd_clients(struct seat_ctx *ctx_seat)
+{
+    struct kbd_client *kbd_client, *next;
+
+    wl_list_for_each_safe(kbd_client, next, &ctx_seat->kbd_clients, link)
+        kbd_client_destroy(kbd_client);
+}
+
 static void
 input_ctrl_kbd_wl_snd_event(struct seat_ctx *ctx_seat,
         struct weston_surface *send_surf, struct weston_keyboard *keyboard,
@@ -299,8 +941,20 @@ input_ctrl_kbd_wl_snd_event(struct seat_ctx *ctx_seat,
     struct wl_client *surface_client;
     struct wl_client *client;
     struct wl_list *resource_list;
+    struct kbd_client *kbd_client;
+    struct kbd_client_resource *kbd_res;
 
     surface_client = wl_resource_get_client(send_surf->resource);
+
+    kbd_client = get_kbd_client(ctx_seat, keyboard, surface_client);
+    if (kbd_client != NULL) {
+        wl_list_for_each(kbd_res, &kbd_client->resources, link) {
+            input_ctrl_kbd_snd_event_resource(ctx_seat, keyboard,
+                    kbd_res->resource, send_surf->resource, kbd_data);
+        }
+        return;
+    }
+
     resource_list = &keyboard->focus_resource_list;
     wl_resource_for_each(resource, resource_list) {
         client = wl_resource_get_client(resource);
@@ -329,10 +983,11 @@ input_ctrl_kbd_leave_surf(struct seat_ctx *ctx_seat,
     struct input_context *ctx = ctx_seat->input_ctx;
     struct seat_focus *st_focus;
 
-    st_focus = get_accepted_seat(surf_ctx, ctx_seat);
+    /* without seat_focus, the seat never had focus on the surface */
+    st_focus = find_seat_focus(surf_ctx, ctx_seat);
 
     if ((NULL != st_focus)
-        && ((st_focus->focus & ILM_INPUT_DEVICE_KEYBOARD))) {
+        && ((st_focus->entry.focus & ILM_INPUT_DEVICE_KEYBOARD))) {
 
         kbd_data.kbd_evt = KEYBOARD_LEAVE;
         kbd_data.serial = wl_display_next_serial(
@@ -340,7 +995,8 @@ input_ctrl_kbd_leave_surf(struct seat_ctx *ctx_seat,
         input_ctrl_kbd_wl_snd_event(ctx_seat, w_surf,
                 ctx_seat->keyboard_grab.keyboard, &kbd_data);
 
-        st_focus->focus &= ~ILM_INPUT_DEVICE_KEYBOARD;
+        st_focus->entry.focus &= ~ILM_INPUT_DEVICE_KEYBOARD;
+        update_focus_index(st_focus);
         send_input_focus(ctx, surf_ctx,
                 ILM_INPUT_DEVICE_KEYBOARD, ILM_FALSE);
     }
@@ -355,9 +1011,9 @@ input_ctrl_kbd_enter_surf(struct seat_ctx *ctx_seat,
     struct seat_focus *st_focus;
     uint32_t serial;
 
-    st_focus = get_accepted_seat(surf_ctx, ctx_seat);
+    st_focus = get_or_create_seat_focus(surf_ctx, ctx_seat);
     if ((NULL != st_focus) &&
-        (!(st_focus->focus & ILM_INPUT_DEVICE_KEYBOARD))) {
+        (!(st_focus->entry.focus & ILM_INPUT_DEVICE_KEYBOARD))) {
         serial = wl_display_next_serial(ctx->ivishell->compositor->wl_display);
 
         kbd_data.kbd_evt = KEYBOARD_ENTER;
@@ -365,7 +1021,8 @@ input_ctrl_kbd_enter_surf(struct seat_ctx *ctx_seat,
         input_ctrl_kbd_wl_snd_event(ctx_seat, w_surf,
                 ctx_seat->keyboard_grab.keyboard, &kbd_data);
 
-        st_focus->focus |= ILM_INPUT_DEVICE_KEYBOARD;
+        st_focus->entry.focus |= ILM_INPUT_DEVICE_KEYBOARD;
+        update_focus_index(st_focus);
         send_input_focus(ctx, surf_ctx,
                 ILM_INPUT_DEVICE_KEYBOARD, ILM_TRUE);
 
@@ -396,17 +1053,37 @@ input_ctrl_kbd_set_focus_surf(struct seat_ctx *ctx_seat,
     }
 }
 
+/* A keyboard event on its way through the focus index */
+struct kbd_route {
+    struct seat_ctx *seat_ctx;
+    struct weston_keyboard *keyboard;
+    struct wl_keyboard_data *kbd_data;
+};
+
+static void
+kbd_route_event(struct ivi_input_focus_entry *entry, void *data)
+{
+    struct kbd_route *route = data;
+    struct seat_focus *st_focus = wl_container_of(entry, st_focus, entry);
+    const struct ivi_layout_interface *interface =
+        route->seat_ctx->input_ctx->ivishell->interface;
+    struct weston_surface *surface;
+
+    surface = interface->surface_get_weston_surface(
+            st_focus->surface->layout_surface);
+    input_ctrl_kbd_wl_snd_event(route->seat_ctx, surface, route->keyboard,
+                                route->kbd_data);
+}
+
 static void
 keyboard_grab_key(struct weston_keyboard_grab *grab, const struct timespec *time,
                   uint32_t key, uint32_t state)
 {
     struct seat_ctx *seat_ctx = wl_container_of(grab, seat_ctx, keyboard_grab);
-    struct ivisurface *surf_ctx;
-    struct seat_focus *st_focus;
     struct wl_keyboard_data kbd_data;
-    struct weston_surface *surface;
-    const struct ivi_layout_interface *interface =
-        seat_ctx->input_ctx->ivishell->interface;
+    struct kbd_route route = { seat_ctx, grab->keyboard, &kbd_data };
+
+    record_input(seat_ctx, IVI_INPUT_RECORD_KEY, time, key, state, 0);
 
     kbd_data.kbd_evt = KEYBOARD_KEY;
     kbd_data.time = timespec_to_msec(time);
@@ -415,18 +1092,10 @@ keyboard_grab_key(struct weston_keyboard_grab *grab, const struct timespec *time
     kbd_data.serial = wl_display_next_serial(grab->keyboard->seat->
                                             compositor->wl_display);
 
-    wl_list_for_each(surf_ctx, &seat_ctx->input_ctx->ivishell->list_surface, link) {
-
-        st_focus = get_accepted_seat(surf_ctx, seat_ctx);
-        if (NULL == st_focus)
-            continue;
-
-        if (!(st_focus->focus & ILM_INPUT_DEVICE_KEYBOARD))
-            continue;
-
-        surface = interface->surface_get_weston_surface(surf_ctx->layout_surface);
-        input_ctrl_kbd_wl_snd_event(seat_ctx, surface, grab->keyboard, &kbd_data);
-    }
+    if (ivi_input_focus_route(&seat_ctx->focus_index,
+                              ILM_INPUT_DEVICE_KEYBOARD,
+                              kbd_route_event, &route) > 0)
+        record_input_latency(seat_ctx, INPUT_LATENCY_KEYBOARD, time);
 }
 
 static void
@@ -435,12 +1104,8 @@ keyboard_grab_modifiers(struct weston_keyboard_grab *grab, uint32_t serial,
                         uint32_t mods_locked, uint32_t group)
 {
     struct seat_ctx *seat_ctx = wl_container_of(grab, seat_ctx, keyboard_grab);
-    struct ivisurface *surf_ctx;
-    struct seat_focus *st_focus;
-    struct weston_surface *surface;
     struct wl_keyboard_data kbd_data;
-    const struct ivi_layout_interface *interface =
-        seat_ctx->input_ctx->ivishell->interface;
+    struct kbd_route route = { seat_ctx, grab->keyboard, &kbd_data };
 
     kbd_data.kbd_evt = KEYBOARD_MODIFIER;
     kbd_data.serial = serial;
@@ -449,36 +1114,26 @@ keyboard_grab_modifiers(struct weston_keyboard_grab *grab, uint32_t serial,
     kbd_data.mods_locked = mods_locked;
     kbd_data.group = group;
 
-    wl_list_for_each(surf_ctx, &seat_ctx->input_ctx->ivishell->list_surface, link) {
-
-        st_focus = get_accepted_seat(surf_ctx, seat_ctx);
-        if (NULL == st_focus)
-            continue;
-
-        /* Keyboard modifiers go to surfaces with pointer focus as well */
-        if (!(st_focus->focus
-              & (ILM_INPUT_DEVICE_KEYBOARD | ILM_INPUT_DEVICE_POINTER)))
-            continue;
-
-        surface = interface->surface_get_weston_surface(surf_ctx->layout_surface);
-
-        input_ctrl_kbd_wl_snd_event(seat_ctx, surface, grab->keyboard, &kbd_data);
-    }
+    /* Keyboard modifiers go to surfaces with pointer focus as well */
+    ivi_input_focus_route(&seat_ctx->focus_index,
+                          ILM_INPUT_DEVICE_KEYBOARD | ILM_INPUT_DEVICE_POINTER,
+                          kbd_route_event, &route);
 }
 
 static void
 keyboard_grab_cancel(struct weston_keyboard_grab *grab)
 {
     struct seat_ctx *ctx_seat = wl_container_of(grab, ctx_seat, keyboard_grab);
-    struct ivisurface *surf;
+    struct seat_focus *st_focus, *next;
     struct weston_surface *w_surf;
     const struct ivi_layout_interface *interface =
                                 ctx_seat->input_ctx->ivishell->interface;
 
-    wl_list_for_each(surf, &ctx_seat->input_ctx->ivishell->list_surface,
-                     link) {
-        w_surf = interface->surface_get_weston_surface(surf->layout_surface);
-        input_ctrl_kbd_leave_surf(ctx_seat, surf, w_surf);
+    wl_list_for_each_safe(st_focus, next, &ctx_seat->focus_index.entries,
+                          entry.link) {
+        w_surf = interface->surface_get_weston_surface(
+                st_focus->surface->layout_surface);
+        input_ctrl_kbd_leave_surf(ctx_seat, st_focus->surface, w_surf);
     }
 }
 
@@ -497,14 +1152,18 @@ input_ctrl_snd_focus_to_controller(struct ivisurface *surf_ctx,
     struct seat_focus *st_focus = NULL;
 
     if (NULL != surf_ctx) {
-        st_focus = get_accepted_seat(surf_ctx, ctx_seat);
+        if (ILM_TRUE == enabled)
+            st_focus = get_or_create_seat_focus(surf_ctx, ctx_seat);
+        else
+            st_focus = find_seat_focus(surf_ctx, ctx_seat);
         /* Send focus lost event to the surface which has lost the focus*/
         if (NULL != st_focus) {
             if (ILM_TRUE == enabled) {
-                st_focus->focus |= device;
+                st_focus->entry.focus |= device;
             } else {
-                st_focus->focus &= ~device;
+                st_focus->entry.focus &= ~device;
             }
+            update_focus_index(st_focus);
             send_input_focus(ctx, surf_ctx, device, enabled);
         }
     }
@@ -530,6 +1189,211 @@ input_ctrl_ptr_leave_west_focus(struct seat_ctx *ctx_seat,
 }
 
 
+static bool
+view_takes_input_at(struct weston_view *view, struct weston_coord_global pos)
+{
+    struct weston_coord_surface surf_pos;
+
+    if (!weston_view_is_mapped(view))
+        return false;
+
+    weston_view_update_transform(view);
+    if (!pixman_region32_contains_point(&view->transform.boundingbox,
+                                        pos.c.x, pos.c.y, NULL))
+        return false;
+
+    surf_pos = weston_coord_global_to_surface(view, pos);
+    return weston_view_takes_input_at_point(view, surf_pos);
+}
+
+struct pick {
+    struct input_context *ctx;
+    struct weston_coord_global pos;
+    struct weston_view *view;
+};
+
+/* Find the view of an ivi surface or of one of its sub-surfaces, which
+ * takes input at the picked position */
+static bool
+pick_surface_view(void *data, void *user_data)
+{
+    struct ivisurface *surf_ctx = data;
+    struct pick *pick = user_data;
+    const struct ivi_layout_interface *lyt_if =
+            pick->ctx->ivishell->interface;
+    struct weston_surface *surface;
+    struct weston_subsurface *sub;
+    struct weston_view *view;
+
+    surface = lyt_if->surface_get_weston_surface(surf_ctx->layout_surface);
+    if (surface == NULL)
+        return false;
+
+    if (wl_list_empty(&surface->subsurface_list)) {
+        wl_list_for_each(view, &surface->views, surface_link) {
+            if (view_takes_input_at(view, pick->pos)) {
+                pick->view = view;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /* the list holds the surface itself too, from the top to the bottom */
+    wl_list_for_each(sub, &surface->subsurface_list, parent_link) {
+        wl_list_for_each(view, &sub->surface->views, surface_link) {
+            if (view_takes_input_at(view, pick->pos)) {
+                pick->view = view;
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+static void
+add_surface_to_pick_index(struct input_context *ctx,
+                          struct ivisurface *surf_ctx)
+{
+    const struct ivi_layout_interface *lyt_if = ctx->ivishell->interface;
+    struct weston_surface *surface;
+    struct weston_subsurface *sub;
+    struct weston_view *view;
+    pixman_box32_t box;
+    pixman_region32_t area;
+
+    surface = lyt_if->surface_get_weston_surface(surf_ctx->layout_surface);
+    if (surface == NULL)
+        return;
+
+    pixman_region32_init(&area);
+
+    if (wl_list_empty(&surface->subsurface_list)) {
+        wl_list_for_each(view, &surface->views, surface_link) {
+            if (!weston_view_is_mapped(view))
+                continue;
+            weston_view_update_transform(view);
+            pixman_region32_union(&area, &area,
+                                  &view->transform.boundingbox);
+        }
+    } else {
+        wl_list_for_each(sub, &surface->subsurface_list, parent_link) {
+            wl_list_for_each(view, &sub->surface->views, surface_link) {
+                if (!weston_view_is_mapped(view))
+                    continue;
+                weston_view_update_transform(view);
+                pixman_region32_union(&area, &area,
+                                      &view->transform.boundingbox);
+            }
+        }
+    }
+
+    if (pixman_region32_not_empty(&area)) {
+        box = *pixman_region32_extents(&area);
+        if (ivi_input_index_add(&ctx->pick_index, surf_ctx,
+                                box.x1, box.y1, box.x2, box.y2) < 0)
+            ctx->pick_index_dirty = true;
+    }
+
+    pixman_region32_fini(&area);
+}
+
+/* Add the visible ivi surfaces of all screens, from the top to the bottom
+ * of the render order. On failure the index stays dirty, and picks fall
+ * back to weston_compositor_pick_view(). */
+static void
+rebuild_pick_index(struct input_context *ctx)
+{
+    const struct ivi_layout_interface *lyt_if = ctx->ivishell->interface;
+    const struct ivi_layout_layer_properties *layer_prop;
+    struct ivi_layout_layer **layers = NULL;
+    struct ivi_layout_surface **surfaces = NULL;
+    struct weston_output *output;
+    struct ivisurface *surf_ctx;
+    int32_t layer_count = 0, surface_count = 0;
+    int32_t i, j;
+
+    ivi_input_index_clear(&ctx->pick_index);
+    ctx->pick_index_dirty = false;
+
+    wl_list_for_each(output, &ctx->ivishell->compositor->output_list, link) {
+        if (lyt_if->get_layers_on_screen(output, &layer_count,
+                                         &layers) != IVI_SUCCEEDED)
+            continue;
+
+        for (i = layer_count - 1; i >= 0; i--) {
+            layer_prop = lyt_if->get_properties_of_layer(layers[i]);
+            if (!layer_prop->visibility)
+                continue;
+
+            if (lyt_if->get_surfaces_on_layer(layers[i], &surface_count,
+                                              &surfaces) != IVI_SUCCEEDED)
+                continue;
+
+            for (j = surface_count - 1; j >= 0; j--) {
+                surf_ctx = input_ctrl_get_surf_ctx(ctx, surfaces[j]);
+                if (surf_ctx && surf_ctx->prop->visibility)
+                    add_surface_to_pick_index(ctx, surf_ctx);
+            }
+
+            free(surfaces);
+            surfaces = NULL;
+        }
+
+        free(layers);
+        layers = NULL;
+    }
+
+    if (ivi_input_index_build(&ctx->pick_index) < 0)
+        ctx->pick_index_dirty = true;
+}
+
+/* Views of the weston layers above the ivi layers, like the input panel,
+ * are not in the pick index */
+static bool
+views_above_ivi_layers(struct weston_compositor *compositor)
+{
+    struct weston_layer *layer;
+
+    wl_list_for_each(layer, &compositor->layer_list, link) {
+        if (layer->position <= WESTON_LAYER_POSITION_NORMAL)
+            break;
+        /* the pointer sprite takes no input */
+        if (layer->position == WESTON_LAYER_POSITION_CURSOR)
+            continue;
+        if (!wl_list_empty(&layer->view_list.link))
+            return true;
+    }
+
+    return false;
+}
+
+/* Same as weston_compositor_pick_view(), but only tests the ivi surfaces
+ * near the position */
+static struct weston_view *
+input_ctrl_pick_view(struct input_context *ctx,
+                     struct weston_coord_global pos)
+{
+    struct weston_compositor *compositor = ctx->ivishell->compositor;
+    struct pick pick = { ctx, pos, NULL };
+
+    if (views_above_ivi_layers(compositor))
+        return weston_compositor_pick_view(compositor, pos);
+
+    if (ctx->pick_index_dirty)
+        rebuild_pick_index(ctx);
+
+    if (ctx->pick_index_dirty ||
+        !ivi_input_index_pick(&ctx->pick_index,
+                              (int32_t)floor(pos.c.x),
+                              (int32_t)floor(pos.c.y),
+                              pick_surface_view, &pick))
+        return weston_compositor_pick_view(compositor, pos);
+
+    return pick.view;
+}
+
 static void
 input_ctrl_ptr_set_west_focus(struct seat_ctx *ctx_seat,
         struct weston_pointer *pointer, struct weston_view *w_view)
@@ -540,8 +1404,7 @@ input_ctrl_ptr_set_west_focus(struct seat_ctx *ctx_seat,
     struct seat_focus *st_focus;
 
     if (NULL == view) {
-        view = weston_compositor_pick_view(pointer->seat->compositor,
-                pointer->pos);
+        view = input_ctrl_pick_view(ctx, pointer->pos);
     }
 
     if (pointer->focus != view) {
@@ -666,16 +1529,30 @@ pointer_grab_motion(struct weston_pointer_grab *grab, const struct timespec *tim
     /*Motion results in re-evaluation of pointer focus*/
     seat->forced_ptr_focus_surf = NULL;
     weston_pointer_send_motion(grab->pointer, time, event);
+
+    /* relative motion is recorded with the position it resulted in */
+    record_input(seat, IVI_INPUT_RECORD_POINTER_MOTION, time,
+                 wl_fixed_from_double(grab->pointer->pos.c.x),
+                 wl_fixed_from_double(grab->pointer->pos.c.y), 0);
+
+    if (grab->pointer->focus)
+        record_input_latency(seat, INPUT_LATENCY_POINTER, time);
 }
 
 static void
 pointer_grab_button(struct weston_pointer_grab *grab, const struct timespec *time,
                     uint32_t button, uint32_t state)
 {
+    struct seat_ctx *seat = wl_container_of(grab, seat, pointer_grab);
     struct weston_pointer *pointer = grab->pointer;
 
+    record_input(seat, IVI_INPUT_RECORD_BUTTON, time, button, state, 0);
+
     weston_pointer_send_button(pointer, time, button, state);
 
+    if (pointer->focus)
+        record_input_latency(seat, INPUT_LATENCY_POINTER, time);
+
     if (pointer->button_count == 0 &&
         state == WL_POINTER_BUTTON_STATE_RELEASED) {
         grab->interface->focus(grab);
@@ -687,19 +1564,33 @@ pointer_grab_axis(struct weston_pointer_grab *grab,
                   const struct timespec *time,
                   struct weston_pointer_axis_event *event)
 {
+    struct seat_ctx *seat = wl_container_of(grab, seat, pointer_grab);
+
+    record_input(seat, IVI_INPUT_RECORD_AXIS, time, event->axis,
+                 wl_fixed_from_double(event->value), 0);
+
     weston_pointer_send_axis(grab->pointer, time, event);
+
+    if (grab->pointer->focus)
+        record_input_latency(seat, INPUT_LATENCY_POINTER, time);
 }
 
 static void
 pointer_grab_axis_source(struct weston_pointer_grab *grab,
                           uint32_t source)
 {
+    struct seat_ctx *seat = wl_container_of(grab, seat, pointer_grab);
+
+    record_input(seat, IVI_INPUT_RECORD_AXIS_SOURCE, NULL, source, 0, 0);
     weston_pointer_send_axis_source(grab->pointer, source);
 }
 
 static void
 pointer_grab_frame(struct weston_pointer_grab *grab)
 {
+    struct seat_ctx *seat = wl_container_of(grab, seat, pointer_grab);
+
+    record_input(seat, IVI_INPUT_RECORD_POINTER_FRAME, NULL, 0, 0, 0);
     weston_pointer_send_frame(grab->pointer);
 }
 
@@ -740,18 +1631,19 @@ input_ctrl_touch_set_west_focus(struct seat_ctx *ctx_seat,
             st_focus = input_ctrl_snd_focus_to_controller(surf_ctx, ctx_seat,
                     ILM_INPUT_DEVICE_TOUCH, ILM_TRUE);
         } else {
-            st_focus = get_accepted_seat(surf_ctx, ctx_seat);
+            st_focus = get_or_create_seat_focus(surf_ctx, ctx_seat);
         }
 
         if (st_focus != NULL) {
             weston_touch_send_down(touch, time, touch_id, pos);
-
+            record_input_latency(ctx_seat, INPUT_LATENCY_TOUCH, time);
         } else {
             weston_touch_set_focus(touch, NULL);
         }
     } else {
         /*Support non ivi-surfaces like input panel*/
         weston_touch_send_down(touch, time, touch_id, pos);
+        record_input_latency(ctx_seat, INPUT_LATENCY_TOUCH, time);
     }
 }
 
@@ -800,10 +1692,161 @@ input_ctrl_touch_clear_focus(struct seat_ctx *ctx_seat)
         input_ctrl_snd_focus_to_controller(surf_ctx, ctx_seat,
                 ILM_INPUT_DEVICE_TOUCH, ILM_FALSE);
 
-        input_ctrl_touch_west_send_cancel(touch);
+        input_ctrl_touch_west_send_cancel(touch);
+
+        weston_touch_set_focus(touch, NULL);
+    }
+}
+
+static void
+touch_stop_flush_at_repaint(struct seat_ctx *seat)
+{
+    if (seat->touch_flush_output == NULL)
+        return;
+
+    wl_list_remove(&seat->touch_flush_listener.link);
+    wl_list_remove(&seat->touch_output_destroy_listener.link);
+    seat->touch_flush_output = NULL;
+}
+
+static void
+touch_send_motions(struct seat_ctx *seat)
+{
+    struct pending_touch_motion *motion;
+
+    if (seat->pending_motions.size == 0)
+        return;
+
+    wl_array_for_each(motion, &seat->pending_motions) {
+        if (seat->touch_grab.touch) {
+            weston_touch_send_motion(seat->touch_grab.touch, &motion->time,
+                                     motion->touch_id, motion->pos);
+            record_input_latency(seat, INPUT_LATENCY_TOUCH,
+                                 &motion->input_time);
+        }
+        seat->touch_motions++;
+    }
+
+    seat->pending_motions.size = 0;
+    seat->touch_unframed = true;
+}
+
+static void
+touch_add_resampled_motion(struct seat_ctx *seat,
+                           const struct ivi_input_resample_point *point,
+                           const struct ivi_input_resample_sample *sample)
+{
+    struct pending_touch_motion *motion;
+
+    motion = wl_array_add(&seat->pending_motions, sizeof *motion);
+    if (motion == NULL)
+        return;
+
+    motion->touch_id = point->touch_id;
+    timespec_from_usec(&motion->time, sample->time_us);
+    timespec_from_usec(&motion->input_time,
+                       point->samples[point->count - 1].time_us);
+    motion->pos.c = weston_coord(sample->x, sample->y);
+}
+
+/* Sends the held motion events, in front of any other touch event. The
+ * resampled touch points are moved to their latest sample. */
+static void
+touch_send_pending_motions(struct seat_ctx *seat)
+{
+    struct ivi_input_resample_point *point;
+    struct ivi_input_resample_sample sample;
+
+    if (seat->touch_motion_mode == TOUCH_MOTION_RESAMPLE) {
+        wl_array_for_each(point, &seat->resampler.points) {
+            if (ivi_input_resampler_settle(point, &sample))
+                touch_add_resampled_motion(seat, point, &sample);
+        }
+    }
+
+    touch_send_motions(seat);
+}
+
+/* Adds the position of every resampled touch point at the time of the
+ * repaint of the output */
+static void
+touch_resample_motions(struct seat_ctx *seat)
+{
+    struct ivi_input_resample_point *point;
+    struct ivi_input_resample_sample sample;
+    struct timespec now;
+    int64_t frame_us;
+
+    /* the samples have the timestamps of the input events */
+    clock_gettime(INPUT_CLOCK, &now);
+    frame_us = timespec_to_usec(&now);
+
+    wl_array_for_each(point, &seat->resampler.points) {
+        if (ivi_input_resampler_sample(&seat->resampler, point, frame_us,
+                                       &sample))
+            touch_add_resampled_motion(seat, point, &sample);
+    }
+}
+
+static void
+touch_flush_at_repaint(struct wl_listener *listener, void *data)
+{
+    struct seat_ctx *seat =
+            wl_container_of(listener, seat, touch_flush_listener);
+
+    if (seat->touch_motion_mode == TOUCH_MOTION_RESAMPLE)
+        touch_resample_motions(seat);
+    touch_send_motions(seat);
+
+    if (seat->touch_unframed && seat->touch_grab.touch) {
+        weston_touch_send_frame(seat->touch_grab.touch);
+        seat->touch_unframed = false;
+    }
+
+    /* points behind their latest sample move on with the next frames */
+    if (seat->touch_motion_mode == TOUCH_MOTION_RESAMPLE &&
+        seat->touch_grab.touch &&
+        ivi_input_resampler_has_pending(&seat->resampler))
+        weston_output_schedule_repaint(seat->touch_flush_output);
+    else
+        touch_stop_flush_at_repaint(seat);
+}
+
+static void
+touch_flush_output_destroyed(struct wl_listener *listener, void *data)
+{
+    struct seat_ctx *seat =
+            wl_container_of(listener, seat, touch_output_destroy_listener);
+
+    touch_stop_flush_at_repaint(seat);
+    touch_send_pending_motions(seat);
+
+    if (seat->touch_unframed && seat->touch_grab.touch) {
+        weston_touch_send_frame(seat->touch_grab.touch);
+        seat->touch_unframed = false;
+    }
+}
+
+static void
+touch_flush_at_next_repaint(struct seat_ctx *seat, struct weston_touch *touch)
+{
+    struct weston_output *output;
+
+    if (seat->touch_flush_output != NULL)
+        return;
 
-        weston_touch_set_focus(touch, NULL);
+    output = touch->focus ? touch->focus->output : NULL;
+    if (output == NULL) {
+        touch_send_pending_motions(seat);
+        return;
     }
+
+    seat->touch_flush_output = output;
+    seat->touch_flush_listener.notify = touch_flush_at_repaint;
+    wl_signal_add(&output->frame_signal, &seat->touch_flush_listener);
+    seat->touch_output_destroy_listener.notify = touch_flush_output_destroyed;
+    wl_signal_add(&output->destroy_signal,
+                  &seat->touch_output_destroy_listener);
 }
 
 static void
@@ -813,12 +1856,23 @@ touch_grab_down(struct weston_touch_grab *grab, const struct timespec *time,
     struct seat_ctx *seat = wl_container_of(grab, seat, touch_grab);
     struct weston_coord_global pos;
 
+    record_input(seat, IVI_INPUT_RECORD_TOUCH_DOWN, time, touch_id, x, y);
+    touch_send_pending_motions(seat);
+
     /* if touch device has no focused view, there is nothing to do*/
     if (grab->touch->focus == NULL)
         return;
 
     pos.c = weston_coord_from_fixed(x, y);
     input_ctrl_touch_set_west_focus(seat, grab->touch, time, touch_id, pos);
+    seat->touch_unframed = true;
+
+    if (seat->touch_motion_mode == TOUCH_MOTION_RESAMPLE &&
+        ivi_input_resampler_down(&seat->resampler, touch_id,
+                                 timespec_to_usec(time),
+                                 pos.c.x, pos.c.y) < 0)
+        weston_log("%s: Failed to allocate memory for touch point\n",
+                   __FUNCTION__);
 }
 
 static void
@@ -830,7 +1884,13 @@ touch_grab_up(struct weston_touch_grab *grab, const struct timespec *time,
     struct weston_touch *touch = grab->touch;
     struct ivisurface *surf_ctx;
 
+    record_input(seat, IVI_INPUT_RECORD_TOUCH_UP, time, touch_id, 0, 0);
+    touch_send_pending_motions(seat);
+    if (seat->touch_motion_mode == TOUCH_MOTION_RESAMPLE)
+        ivi_input_resampler_up(&seat->resampler, touch_id);
+
     if (NULL != touch->focus) {
+        seat->touch_unframed = true;
         if (touch->num_tp == 0) {
             surf_ctx = input_ctrl_get_surf_ctx_from_surf(ctx,
                                     touch->focus->surface);
@@ -839,6 +1899,7 @@ touch_grab_up(struct weston_touch_grab *grab, const struct timespec *time,
                     seat, ILM_INPUT_DEVICE_TOUCH, ILM_FALSE);
         }
         weston_touch_send_up(touch, time, touch_id);
+        record_input_latency(seat, INPUT_LATENCY_TOUCH, time);
     }
 }
 
@@ -846,22 +1907,95 @@ static void
 touch_grab_motion(struct weston_touch_grab *grab, const struct timespec *time, int touch_id,
                   wl_fixed_t x, wl_fixed_t y)
 {
+    struct seat_ctx *seat = wl_container_of(grab, seat, touch_grab);
+    struct pending_touch_motion *motion;
     struct weston_coord_global pos;
+    bool merged = false;
 
+    record_input(seat, IVI_INPUT_RECORD_TOUCH_MOTION, time, touch_id, x, y);
     pos.c = weston_coord_from_fixed(x, y);
-    weston_touch_send_motion(grab->touch, time, touch_id, pos);
+
+    if (seat->touch_motion_mode == TOUCH_MOTION_IMMEDIATE) {
+        weston_touch_send_motion(grab->touch, time, touch_id, pos);
+        record_input_latency(seat, INPUT_LATENCY_TOUCH, time);
+        seat->touch_motions++;
+        return;
+    }
+
+    if (seat->touch_motion_mode == TOUCH_MOTION_RESAMPLE) {
+        switch (ivi_input_resampler_motion(&seat->resampler, touch_id,
+                                           timespec_to_usec(time),
+                                           pos.c.x, pos.c.y)) {
+        case -1:
+            weston_touch_send_motion(grab->touch, time, touch_id, pos);
+            record_input_latency(seat, INPUT_LATENCY_TOUCH, time);
+            seat->touch_motions++;
+            return;
+        case 1:
+            seat->merged_touch_motions++;
+            break;
+        }
+        touch_flush_at_next_repaint(seat, grab->touch);
+        return;
+    }
+
+    wl_array_for_each(motion, &seat->pending_motions) {
+        if (motion->touch_id == touch_id) {
+            merged = true;
+            break;
+        }
+    }
+
+    if (merged) {
+        seat->merged_touch_motions++;
+    } else {
+        motion = wl_array_add(&seat->pending_motions, sizeof *motion);
+        if (motion == NULL) {
+            weston_touch_send_motion(grab->touch, time, touch_id, pos);
+            record_input_latency(seat, INPUT_LATENCY_TOUCH, time);
+            seat->touch_motions++;
+            return;
+        }
+        motion->touch_id = touch_id;
+    }
+
+    motion->time = *time;
+    motion->input_time = *time;
+    motion->pos = pos;
+
+    if (seat->touch_motion_mode == TOUCH_MOTION_REPAINT)
+        touch_flush_at_next_repaint(seat, grab->touch);
 }
 
 static void
 touch_grab_frame(struct weston_touch_grab *grab)
 {
+    struct seat_ctx *seat = wl_container_of(grab, seat, touch_grab);
+
+    record_input(seat, IVI_INPUT_RECORD_TOUCH_FRAME, NULL, 0, 0, 0);
+
+    if (seat->touch_motion_mode == TOUCH_MOTION_COALESCE)
+        touch_send_pending_motions(seat);
+
+    /* held motion is framed when it is sent at the repaint */
+    if ((seat->touch_motion_mode == TOUCH_MOTION_REPAINT ||
+         seat->touch_motion_mode == TOUCH_MOTION_RESAMPLE) &&
+        !seat->touch_unframed)
+        return;
+
     weston_touch_send_frame(grab->touch);
+    seat->touch_unframed = false;
 }
 
 static void
 touch_grab_cancel(struct weston_touch_grab *grab)
 {
     struct seat_ctx *ctx_seat = wl_container_of(grab, ctx_seat, touch_grab);
+
+    record_input(ctx_seat, IVI_INPUT_RECORD_TOUCH_CANCEL, NULL, 0, 0, 0);
+    touch_send_pending_motions(ctx_seat);
+    touch_stop_flush_at_repaint(ctx_seat);
+    ivi_input_resampler_clear(&ctx_seat->resampler);
     input_ctrl_touch_clear_focus(ctx_seat);
 }
 
@@ -903,9 +2037,11 @@ handle_seat_updated_caps(struct wl_listener *listener, void *data)
     struct wl_resource *resource;
 
     if (keyboard && keyboard != ctx->keyboard_grab.keyboard) {
+        clear_kbd_clients(ctx);
         weston_keyboard_start_grab(keyboard, &ctx->keyboard_grab);
     }
     else if (!keyboard && ctx->keyboard_grab.keyboard) {
+        clear_kbd_clients(ctx);
         ctx->keyboard_grab.keyboard = NULL;
     }
 
@@ -920,6 +2056,9 @@ handle_seat_updated_caps(struct wl_listener *listener, void *data)
         weston_touch_start_grab(touch, &ctx->touch_grab);
     }
     else if (!touch && ctx->touch_grab.touch) {
+        touch_stop_flush_at_repaint(ctx);
+        ctx->pending_motions.size = 0;
+        ivi_input_resampler_clear(&ctx->resampler);
         ctx->touch_grab.touch = NULL;
     }
 
@@ -936,6 +2075,8 @@ destroy_seat(struct seat_ctx *ctx_seat)
     struct ivisurface *surf;
     struct wl_resource *resource;
 
+    drop_pending_acceptance(ctx_seat->input_ctx, NULL, ctx_seat);
+
     /* Remove seat acceptance from surfaces which have input acceptance from
      * this seat */
     wl_list_for_each(surf, &ctx_seat->input_ctx->ivishell->list_surface,
@@ -947,9 +2088,14 @@ destroy_seat(struct seat_ctx *ctx_seat)
         ivi_input_send_seat_destroyed(resource,
                                       ctx_seat->west_seat->seat_name);
     }
+    clear_kbd_clients(ctx_seat);
+    touch_stop_flush_at_repaint(ctx_seat);
+    wl_array_release(&ctx_seat->pending_motions);
+    ivi_input_resampler_release(&ctx_seat->resampler);
     wl_list_remove(&ctx_seat->destroy_listener.link);
     wl_list_remove(&ctx_seat->updated_caps_listener.link);
     wl_list_remove(&ctx_seat->seat_node);
+    set_seat_ctx_of_id(ctx_seat->input_ctx, ctx_seat->id, NULL);
     free(ctx_seat);
 }
 
@@ -960,6 +2106,159 @@ handle_seat_destroy(struct wl_listener *listener, void *data)
     destroy_seat(ctx);
 }
 
+static enum touch_motion_mode
+get_touch_motion_mode(struct input_context *ctx, const char *seat_name)
+{
+    struct weston_config *config = wet_get_config(ctx->ivishell->compositor);
+    struct weston_config_section *section = NULL;
+    enum touch_motion_mode mode = TOUCH_MOTION_IMMEDIATE;
+    const char *name;
+    char *seat = NULL;
+    char *value = NULL;
+
+    if (!config)
+        return mode;
+
+    while (weston_config_next_section(config, &section, &name)) {
+        if (0 != strcmp(name, "ivi-input"))
+            continue;
+
+        weston_config_section_get_string(section, "seat", &seat,
+                                         ctx->seat_default_name);
+        if (seat && 0 == strcmp(seat, seat_name)) {
+            weston_config_section_get_string(section, "touch-motion",
+                                             &value, "immediate");
+            if (value && 0 == strcmp(value, "coalesce")) {
+                mode = TOUCH_MOTION_COALESCE;
+            } else if (value && 0 == strcmp(value, "repaint")) {
+                mode = TOUCH_MOTION_REPAINT;
+            } else if (value && 0 == strcmp(value, "resample")) {
+                mode = TOUCH_MOTION_RESAMPLE;
+            } else if (value && 0 != strcmp(value, "immediate")) {
+                weston_log("%s: unknown touch-motion '%s' of seat %s\n",
+                           __FUNCTION__, value, seat_name);
+            }
+            free(value);
+            free(seat);
+            break;
+        }
+        free(seat);
+        seat = NULL;
+    }
+
+    return mode;
+}
+
+static void
+print_touch_stats(struct weston_log_subscription *subscription, void *data)
+{
+    static const char *const mode_names[] = {
+        [TOUCH_MOTION_IMMEDIATE] = "immediate",
+        [TOUCH_MOTION_COALESCE] = "coalesce",
+        [TOUCH_MOTION_REPAINT] = "repaint",
+        [TOUCH_MOTION_RESAMPLE] = "resample",
+    };
+    struct input_context *ctx = data;
+    struct seat_ctx *seat;
+
+    wl_list_for_each(seat, &ctx->seat_list, seat_node) {
+        weston_log_subscription_printf(subscription,
+                "seat %s: touch-motion %s, motions sent %u, merged %u\n",
+                seat->west_seat->seat_name,
+                mode_names[seat->touch_motion_mode],
+                seat->touch_motions, seat->merged_touch_motions);
+    }
+
+    weston_log_subscription_complete(subscription);
+}
+
+static void
+print_latency_stats(struct weston_log_subscription *subscription, void *data)
+{
+    static const char *const device_names[] = {
+        [INPUT_LATENCY_KEYBOARD] = "keyboard",
+        [INPUT_LATENCY_POINTER] = "pointer",
+        [INPUT_LATENCY_TOUCH] = "touch",
+    };
+    struct input_context *ctx = data;
+    struct input_latency *latency;
+    struct seat_ctx *seat;
+    uint32_t limit_us;
+    int device, i;
+
+    wl_list_for_each(seat, &ctx->seat_list, seat_node) {
+        for (device = 0; device < INPUT_LATENCY_DEVICES; device++) {
+            latency = &seat->latency[device];
+            if (latency->count == 0)
+                continue;
+
+            weston_log_subscription_printf(subscription,
+                    "seat %s %s: %u events, mean %u us, max %u us\n",
+                    seat->west_seat->seat_name, device_names[device],
+                    latency->count,
+                    (uint32_t)(latency->sum_us / latency->count),
+                    latency->max_us);
+
+            limit_us = INPUT_LATENCY_BUCKET0_US;
+            for (i = 0; i < INPUT_LATENCY_BUCKETS; i++, limit_us *= 2) {
+                if (latency->buckets[i] == 0)
+                    continue;
+                if (i < INPUT_LATENCY_BUCKETS - 1)
+                    weston_log_subscription_printf(subscription,
+                            "  < %8u us: %u\n", limit_us,
+                            latency->buckets[i]);
+                else
+                    weston_log_subscription_printf(subscription,
+                            "  >= %7u us: %u\n", limit_us / 2,
+                            latency->buckets[i]);
+            }
+        }
+    }
+
+    weston_log_subscription_complete(subscription);
+}
+
+static uint32_t
+get_free_seat_id(struct input_context *ctx)
+{
+    uint32_t id = 0;
+
+    while (input_ctrl_get_seat_ctx_from_id(ctx, id) != NULL)
+        id++;
+
+    return id;
+}
+
+static struct seat_ctx *
+input_ctrl_get_seat_ctx_from_seat(struct weston_seat *seat)
+{
+    struct wl_listener *listener;
+    struct seat_ctx *ctx_seat;
+
+    listener = wl_signal_get(&seat->destroy_signal, handle_seat_destroy);
+    if (listener == NULL)
+        return NULL;
+
+    return wl_container_of(listener, ctx_seat, destroy_listener);
+}
+
+static void
+send_seat_created(struct wl_resource *resource, struct input_context *ctx,
+                  struct weston_seat *seat)
+{
+    struct seat_ctx *ctx_seat = input_ctrl_get_seat_ctx_from_seat(seat);
+    int32_t is_default_seat;
+
+    is_default_seat = (strcmp(ctx->seat_default_name, seat->seat_name))
+                        ? ILM_FALSE : ILM_TRUE;
+    ivi_input_send_seat_created(resource, seat->seat_name,
+                                get_seat_capabilities(seat), is_default_seat);
+
+    if (ctx_seat != NULL &&
+        wl_resource_get_version(resource) >= IVI_INPUT_SEAT_ID_SINCE_VERSION)
+        ivi_input_send_seat_id(resource, seat->seat_name, ctx_seat->id);
+}
+
 static void
 handle_seat_create(struct wl_listener *listener, void *data)
 {
@@ -968,9 +2267,6 @@ handle_seat_create(struct wl_listener *listener, void *data)
                                                       seat_create_listener);
     struct wl_resource *resource;
     struct ivisurface *surf;
-    const struct ivi_layout_interface *interface =
-        input_ctx->ivishell->interface;
-    int32_t is_default_seat = ILM_FALSE;
     struct seat_ctx *ctx = calloc(1, sizeof *ctx);
     if (ctx == NULL) {
         weston_log("%s: Failed to allocate memory\n", __FUNCTION__);
@@ -979,6 +2275,18 @@ handle_seat_create(struct wl_listener *listener, void *data)
 
     ctx->input_ctx = input_ctx;
     ctx->west_seat = seat;
+    ctx->id = get_free_seat_id(input_ctx);
+    if (set_seat_ctx_of_id(input_ctx, ctx->id, ctx) < 0) {
+        weston_log("%s: Failed to allocate memory\n", __FUNCTION__);
+        free(ctx);
+        return;
+    }
+    ivi_input_focus_index_init(&ctx->focus_index,
+            ILM_INPUT_DEVICE_KEYBOARD | ILM_INPUT_DEVICE_POINTER);
+    wl_list_init(&ctx->kbd_clients);
+    wl_array_init(&ctx->pending_motions);
+    ivi_input_resampler_init(&ctx->resampler);
+    ctx->touch_motion_mode = get_touch_motion_mode(input_ctx, seat->seat_name);
 
     ctx->keyboard_grab.interface = &keyboard_grab_interface;
     ctx->pointer_grab.interface = &pointer_grab_interface;
@@ -991,22 +2299,16 @@ handle_seat_create(struct wl_listener *listener, void *data)
     ctx->updated_caps_listener.notify = &handle_seat_updated_caps;
     wl_signal_add(&seat->updated_caps_signal, &ctx->updated_caps_listener);
 
-    is_default_seat = (strcmp(input_ctx->seat_default_name, seat->seat_name))
-                        ? ILM_FALSE : ILM_TRUE;
     wl_resource_for_each(resource, &input_ctx->resource_list) {
-        ivi_input_send_seat_created(resource,
-                                    seat->seat_name,
-                                    get_seat_capabilities(seat), is_default_seat);
+        send_seat_created(resource, input_ctx, seat);
     }
 
-    /* If default seat is created, we have to add it to the accepted_seat_list
-     * of all surfaces. Also we have to send an acceptance event to all clients */
+    /* If default seat is created, all surfaces accept it. The clients get
+     * one batch of acceptance events at the end of the dispatch cycle */
     if (!strcmp(ctx->west_seat->seat_name, input_ctx->seat_default_name)) {
         wl_list_for_each(surf, &input_ctx->ivishell->list_surface, link) {
-            add_accepted_seat(surf, ctx);
-            send_input_acceptance(input_ctx,
-                                 interface->get_id_of_surface(surf->layout_surface),
-                                 input_ctx->seat_default_name, ILM_TRUE);
+            if (add_accepted_seat(surf, ctx))
+                queue_input_acceptance(input_ctx, surf, ctx, false);
         }
     }
 }
@@ -1018,16 +2320,20 @@ input_ctrl_free_surf_ctx(struct input_context *ctx, struct ivisurface *surf_ctx)
     struct seat_focus *st_focus;
     struct seat_focus *tmp_st_focus;
 
-    wl_list_for_each_safe(st_focus, tmp_st_focus,
-            &surf_ctx->accepted_seat_list, link) {
-        seat_ctx = st_focus->seat_ctx;
+    drop_pending_acceptance(ctx, surf_ctx, NULL);
 
+    wl_list_for_each(seat_ctx, &ctx->seat_list, seat_node) {
         if (seat_ctx->forced_ptr_focus_surf == surf_ctx)
             seat_ctx->forced_ptr_focus_surf = NULL;
+    }
 
-        wl_list_remove(&st_focus->link);
-        free(st_focus);
+    wl_list_for_each_safe(st_focus, tmp_st_focus,
+            &surf_ctx->accepted_seat_list, link) {
+        free_seat_focus(st_focus);
     }
+
+    seat_mask_release(&surf_ctx->accepted_seat_mask);
+    seat_mask_release(&surf_ctx->acceptance_pending);
 }
 
 static void
@@ -1037,34 +2343,105 @@ handle_surface_destroy(struct wl_listener *listener, void *data)
             wl_container_of(listener, ctx, surface_destroyed);
     struct ivisurface *surf = (struct ivisurface *) data;
 
+    ctx->pick_index_dirty = true;
+
     if (NULL != surf)
         input_ctrl_free_surf_ctx(ctx, surf);
 }
 
+static void
+handle_scene_changed(struct wl_listener *listener, void *data)
+{
+    struct input_context *ctx =
+            wl_container_of(listener, ctx, scene_changed);
+
+    ctx->pick_index_dirty = true;
+}
+
+/* Layout transitions, commits of new buffer sizes and subsurface moves
+ * change the geometry of views without a scene change. They all end in a
+ * repaint, before which weston_compositor_pick_view() sees the old
+ * geometry as well. */
+static void
+handle_pick_output_frame(struct wl_listener *listener, void *data)
+{
+    struct pick_output *pick_output =
+            wl_container_of(listener, pick_output, frame_listener);
+
+    pick_output->ctx->pick_index_dirty = true;
+}
+
+static void
+destroy_pick_output(struct pick_output *pick_output)
+{
+    wl_list_remove(&pick_output->frame_listener.link);
+    wl_list_remove(&pick_output->destroy_listener.link);
+    wl_list_remove(&pick_output->link);
+    free(pick_output);
+}
+
+static void
+handle_pick_output_destroy(struct wl_listener *listener, void *data)
+{
+    struct pick_output *pick_output =
+            wl_container_of(listener, pick_output, destroy_listener);
+
+    pick_output->ctx->pick_index_dirty = true;
+    destroy_pick_output(pick_output);
+}
+
+static void
+handle_output_created(struct wl_listener *listener, void *data)
+{
+    struct input_context *ctx =
+            wl_container_of(listener, ctx, output_created);
+    struct weston_output *output = data;
+    struct pick_output *pick_output;
+
+    ctx->pick_index_dirty = true;
+
+    pick_output = calloc(1, sizeof *pick_output);
+    if (pick_output == NULL) {
+        weston_log("%s: Failed to allocate memory for pick output\n",
+                   __FUNCTION__);
+        return;
+    }
+
+    pick_output->ctx = ctx;
+    pick_output->frame_listener.notify = handle_pick_output_frame;
+    wl_signal_add(&output->frame_signal, &pick_output->frame_listener);
+    pick_output->destroy_listener.notify = handle_pick_output_destroy;
+    wl_signal_add(&output->destroy_signal, &pick_output->destroy_listener);
+    wl_list_insert(&ctx->pick_outputs, &pick_output->link);
+}
+
 static void
 handle_surface_create(struct wl_listener *listener, void *data)
 {
     struct input_context *input_ctx =
             wl_container_of(listener, input_ctx, surface_created);
     struct ivisurface *ivisurface = (struct ivisurface *) data;
-    const struct ivi_layout_interface *interface =
-        input_ctx->ivishell->interface;
     struct seat_ctx *seat_ctx;
 
     wl_list_init(&ivisurface->accepted_seat_list);
+    seat_mask_init(&ivisurface->accepted_seat_mask);
+    seat_mask_init(&ivisurface->acceptance_pending);
 
+    /* Accepting the default seat is a bit in accepted_seat_mask, its
+     * seat_focus is allocated with the first focus */
     seat_ctx = input_ctrl_get_seat_ctx(input_ctx, input_ctx->seat_default_name);
-    if (seat_ctx) {
-        add_accepted_seat(ivisurface, seat_ctx);
-        send_input_acceptance(input_ctx,
-                              interface->get_id_of_surface(ivisurface->layout_surface),
-                              input_ctx->seat_default_name, ILM_TRUE);
-    }
+    if (seat_ctx && add_accepted_seat(ivisurface, seat_ctx))
+        queue_input_acceptance(input_ctx, ivisurface, seat_ctx, false);
 }
 
 static void
 unbind_resource_controller(struct wl_resource *resource)
 {
+    struct input_context *ctx = wl_resource_get_user_data(resource);
+
+    if (ctx->replay_resource == resource)
+        ctx->replay_resource = NULL;
+
     wl_list_remove(wl_resource_get_link(resource));
 }
 
@@ -1073,14 +2450,12 @@ setup_input_focus(struct input_context *ctx, uint32_t surface,
         uint32_t device, int32_t enabled)
 {
     struct ivisurface *surf = NULL;
-    struct seat_focus *st_focus;
     struct seat_ctx *ctx_seat;
 
     surf = input_ctrl_get_surf_ctx_from_id(ctx, surface);
     if (NULL != surf) {
-        wl_list_for_each(st_focus, &surf->accepted_seat_list, link) {
-            ctx_seat = st_focus->seat_ctx;
-            if (ctx_seat != NULL) {
+        wl_list_for_each(ctx_seat, &ctx->seat_list, seat_node) {
+            if (seat_mask_test(&surf->accepted_seat_mask, ctx_seat->id)) {
                 if (device & ILM_INPUT_DEVICE_POINTER) {
                     input_ctrl_ptr_set_focus_surf(ctx_seat, surf, enabled);
                 }
@@ -1109,81 +2484,107 @@ input_set_input_focus(struct wl_client *client,
 }
 
 static void
-setup_input_acceptance(struct input_context *ctx,
-                       uint32_t surface, const char *seat,
+refocus_pointer(struct seat_ctx *ctx_seat)
+{
+    struct weston_pointer *pointer;
+
+    pointer = weston_seat_get_pointer(ctx_seat->west_seat);
+    if (NULL != pointer) {
+        /*if seat is having NULL pointer focus, now it may be
+         * possible that a surface can hold the focus as it
+         * accepts events from that seat*/
+        if (input_ctrl_ptr_is_focus_emtpy(ctx_seat)) {
+            pointer->grab->interface->focus(pointer->grab);
+        }
+    }
+}
+
+/* Returns the seat whose pointer focus has to be evaluated again, as the
+ * surface accepts it now */
+static struct seat_ctx *
+apply_input_acceptance(struct input_context *ctx,
+                       uint32_t surface, struct seat_ctx *ctx_seat,
                        int32_t accepted)
 {
     struct ivisurface *ivisurface;
-    struct seat_ctx *ctx_seat;
     struct weston_surface *w_surf;
-    int found_seat = 0;
     const struct ivi_layout_interface *interface =
         ctx->ivishell->interface;
     struct weston_pointer *pointer;
     struct weston_touch *touch;
     struct weston_keyboard *keyboard;
     struct seat_focus *st_focus;
-
-    ctx_seat = input_ctrl_get_seat_ctx(ctx, seat);
-
-    if (NULL == ctx_seat) {
-        weston_log("%s: seat: %s was not found\n", __FUNCTION__, seat);
-        return;
-    }
+    ilmInputDevice focus;
+    bool was_accepted;
+    struct seat_ctx *refocus = NULL;
 
     ivisurface = input_ctrl_get_surf_ctx_from_id(ctx, surface);
 
-    if (NULL != ivisurface) {
-        if (accepted == ILM_TRUE) {
-            found_seat = add_accepted_seat(ivisurface, ctx_seat);
-
-            pointer = weston_seat_get_pointer(ctx_seat->west_seat);
-            if (NULL != pointer) {
-                /*if seat is having NULL pointer focus, now it may be
-                 * possible that this surface can hold the focus as it
-                 * accepts events from that seat*/
-                if (input_ctrl_ptr_is_focus_emtpy(ctx_seat)) {
-                    pointer->grab->interface->focus(pointer->grab);
-                }
+    if (NULL == ivisurface)
+        return NULL;
+
+    was_accepted = seat_mask_test(&ivisurface->accepted_seat_mask,
+                                  ctx_seat->id);
+
+    if (accepted == ILM_TRUE) {
+        add_accepted_seat(ivisurface, ctx_seat);
+        refocus = ctx_seat;
+    } else if (was_accepted) {
+        /* a seat which never had focus on the surface has no seat_focus */
+        st_focus = find_seat_focus(ivisurface, ctx_seat);
+        focus = st_focus ? st_focus->entry.focus : 0;
+
+        w_surf = interface->surface_get_weston_surface(ivisurface->
+                                                       layout_surface);
+
+        pointer = weston_seat_get_pointer(ctx_seat->west_seat);
+        if (NULL != pointer) {
+            if ((focus & ILM_INPUT_DEVICE_POINTER)
+                    == ILM_INPUT_DEVICE_POINTER) {
+                input_ctrl_ptr_clear_focus(ctx_seat);
             }
-        } else {
-            st_focus = get_accepted_seat(ivisurface, ctx_seat);
-
-            if (NULL != st_focus) {
-                w_surf = interface->surface_get_weston_surface(ivisurface->
-                                                               layout_surface);
-
-                pointer = weston_seat_get_pointer(ctx_seat->west_seat);
-                if (NULL != pointer) {
-                    if ((st_focus->focus & ILM_INPUT_DEVICE_POINTER)
-                            == ILM_INPUT_DEVICE_POINTER) {
-                        input_ctrl_ptr_clear_focus(ctx_seat);
-                    }
-                }
-                touch = weston_seat_get_touch(ctx_seat->west_seat);
-                if (NULL != touch) {
-                    if ((st_focus->focus & ILM_INPUT_DEVICE_TOUCH)
-                            == ILM_INPUT_DEVICE_TOUCH) {
-                        input_ctrl_touch_clear_focus(ctx_seat);
-                    }
-                }
-                keyboard = weston_seat_get_keyboard(ctx_seat->west_seat);
-
-                if (NULL != keyboard) {
-                    if ((st_focus->focus & ILM_INPUT_DEVICE_KEYBOARD)
-                            == ILM_INPUT_DEVICE_KEYBOARD) {
-                        input_ctrl_kbd_leave_surf(ctx_seat,
-                                ivisurface, w_surf);
-                    }
-                }
+        }
+        touch = weston_seat_get_touch(ctx_seat->west_seat);
+        if (NULL != touch) {
+            if ((focus & ILM_INPUT_DEVICE_TOUCH)
+                    == ILM_INPUT_DEVICE_TOUCH) {
+                input_ctrl_touch_clear_focus(ctx_seat);
+            }
+        }
+        keyboard = weston_seat_get_keyboard(ctx_seat->west_seat);
 
-                found_seat = remove_if_seat_accepted(ivisurface, ctx_seat);
+        if (NULL != keyboard) {
+            if ((focus & ILM_INPUT_DEVICE_KEYBOARD)
+                    == ILM_INPUT_DEVICE_KEYBOARD) {
+                input_ctrl_kbd_leave_surf(ctx_seat,
+                        ivisurface, w_surf);
             }
         }
+
+        remove_if_seat_accepted(ivisurface, ctx_seat);
+    }
+
+    queue_input_acceptance(ctx, ivisurface, ctx_seat, was_accepted);
+
+    return refocus;
+}
+
+static void
+setup_input_acceptance(struct input_context *ctx,
+                       uint32_t surface, const char *seat,
+                       int32_t accepted)
+{
+    struct seat_ctx *ctx_seat;
+
+    ctx_seat = input_ctrl_get_seat_ctx(ctx, seat);
+    if (NULL == ctx_seat) {
+        weston_log("%s: seat: %s was not found\n", __FUNCTION__, seat);
+        return;
     }
 
-    if (found_seat)
-        send_input_acceptance(ctx, surface, seat, accepted);
+    ctx_seat = apply_input_acceptance(ctx, surface, ctx_seat, accepted);
+    if (NULL != ctx_seat)
+        refocus_pointer(ctx_seat);
 }
 
 static void
@@ -1194,11 +2595,128 @@ input_set_input_acceptance(struct wl_client *client,
 {
     struct input_context *ctx = wl_resource_get_user_data(resource);
     setup_input_acceptance(ctx, surface, seat, accepted);
+    /* the requesting client gets the event before the reply to a later
+     * sync request */
+    flush_input_acceptance(ctx);
+}
+
+static void
+input_set_input_acceptance_batch(struct wl_client *client,
+                                 struct wl_resource *resource,
+                                 struct wl_array *entries)
+{
+    struct input_context *ctx = wl_resource_get_user_data(resource);
+    struct acceptance_entry *entry = entries->data;
+    /* an incomplete entry at the end is ignored */
+    struct acceptance_entry *end = entry + entries->size / sizeof *entry;
+    struct seat_ctx *ctx_seat;
+
+    for (; entry < end; entry++) {
+        ctx_seat = input_ctrl_get_seat_ctx_from_id(ctx, entry->seat_id);
+        if (NULL == ctx_seat) {
+            weston_log("%s: seat id %u was not found\n", __FUNCTION__,
+                       entry->seat_id);
+            continue;
+        }
+
+        ctx_seat = apply_input_acceptance(ctx, entry->surface, ctx_seat,
+                                          entry->accepted);
+        if (NULL != ctx_seat)
+            ctx_seat->refocus_pending = true;
+    }
+
+    wl_list_for_each(ctx_seat, &ctx->seat_list, seat_node) {
+        if (ctx_seat->refocus_pending) {
+            ctx_seat->refocus_pending = false;
+            refocus_pointer(ctx_seat);
+        }
+    }
+
+    /* all entries go out together, before the reply to a later sync */
+    flush_input_acceptance(ctx);
+}
+
+static void
+input_get_latency_stats(struct wl_client *client,
+                        struct wl_resource *resource)
+{
+    struct input_context *ctx = wl_resource_get_user_data(resource);
+    struct seat_ctx *ctx_seat;
+    struct input_latency *latency;
+    struct wl_array buckets;
+    int device;
+
+    wl_array_init(&buckets);
+    if (!wl_array_add(&buckets, sizeof latency->buckets)) {
+        wl_resource_post_no_memory(resource);
+        return;
+    }
+
+    wl_list_for_each(ctx_seat, &ctx->seat_list, seat_node) {
+        for (device = 0; device < INPUT_LATENCY_DEVICES; device++) {
+            latency = &ctx_seat->latency[device];
+            memcpy(buckets.data, latency->buckets, sizeof latency->buckets);
+            ivi_input_send_latency_stats(resource,
+                    ctx_seat->west_seat->seat_name, 1 << device,
+                    latency->count,
+                    latency->count ? latency->sum_us / latency->count : 0,
+                    latency->max_us, &buckets);
+        }
+    }
+
+    wl_array_release(&buckets);
+}
+
+static void
+input_replay_done(void *data, uint32_t events, bool success)
+{
+    struct input_context *ctx = data;
+
+    if (ctx->replay_resource)
+        ivi_input_send_input_replayed(ctx->replay_resource, events,
+                                      success ? ILM_TRUE : ILM_FALSE);
+    ctx->replay_resource = NULL;
+}
+
+static void
+input_replay_input(struct wl_client *client,
+                   struct wl_resource *resource,
+                   int32_t fd, wl_fixed_t speed)
+{
+    struct input_context *ctx = wl_resource_get_user_data(resource);
+    int ret = -1;
+
+    if (!ctx->replay_enabled) {
+        weston_log("%s: input replay is disabled, set input-replay=true in "
+                   "the [ivi-shell] section\n", __FUNCTION__);
+        close(fd);
+        ivi_input_send_input_replayed(resource, 0, ILM_FALSE);
+        return;
+    }
+
+    if (ctx->player == NULL)
+        ctx->player = ivi_input_player_create(ctx->ivishell->compositor,
+                                              ctx->seat_default_name);
+
+    if (ctx->player && speed >= 0)
+        ret = ivi_input_player_start(ctx->player, fd, wl_fixed_to_double(speed),
+                                     input_replay_done, ctx);
+    close(fd);
+
+    if (ret < 0) {
+        ivi_input_send_input_replayed(resource, 0, ILM_FALSE);
+        return;
+    }
+
+    ctx->replay_resource = resource;
 }
 
 static const struct ivi_input_interface input_implementation = {
     input_set_input_focus,
-    input_set_input_acceptance
+    input_set_input_acceptance,
+    input_get_latency_stats,
+    input_replay_input,
+    input_set_input_acceptance_batch
 };
 
 static void
@@ -1212,10 +2730,14 @@ bind_ivi_input(struct wl_client *client, void *data,
     const struct ivi_layout_interface *interface =
         ctx->ivishell->interface;
     struct seat_focus *st_focus;
+    struct seat_ctx *ctx_seat;
+    struct wl_array entries;
     uint32_t ivi_surf_id;
-    int32_t is_default_seat = ILM_FALSE;
 
-    resource = wl_resource_create(client, &ivi_input_interface, 1, id);
+    /* the state sent below includes all pending changes */
+    flush_input_acceptance(ctx);
+
+    resource = wl_resource_create(client, &ivi_input_interface, version, id);
     wl_resource_set_implementation(resource, &input_implementation,
                                    ctx, unbind_resource_controller);
 
@@ -1223,20 +2745,33 @@ bind_ivi_input(struct wl_client *client, void *data,
 
     /* Send seat events for all known seats to the client */
     wl_list_for_each(seat, &ctx->ivishell->compositor->seat_list, link) {
-        is_default_seat = (strcmp(ctx->seat_default_name, seat->seat_name))
-                            ? ILM_FALSE : ILM_TRUE;
-        ivi_input_send_seat_created(resource, seat->seat_name,
-                                    get_seat_capabilities(seat), is_default_seat);
+        send_seat_created(resource, ctx, seat);
+    }
+    /* Send acceptance and focus events for all known surfaces to the
+     * client */
+    wl_array_init(&entries);
+    wl_list_for_each(ivisurface, &ctx->ivishell->list_surface, link) {
+        ivi_surf_id = interface->get_id_of_surface(ivisurface->layout_surface);
+        wl_list_for_each(ctx_seat, &ctx->seat_list, seat_node) {
+            if (!seat_mask_test(&ivisurface->accepted_seat_mask,
+                                ctx_seat->id))
+                continue;
+            if (add_acceptance_entry(&entries, ivi_surf_id, ctx_seat->id,
+                                     ILM_TRUE) < 0) {
+                wl_client_post_no_memory(client);
+                wl_array_release(&entries);
+                return;
+            }
+        }
     }
-    /* Send focus and acceptance events for all known surfaces to the client */
+    send_acceptance_entries(ctx, resource, &entries);
+    wl_array_release(&entries);
+
     wl_list_for_each(ivisurface, &ctx->ivishell->list_surface, link) {
         ivi_surf_id = interface->get_id_of_surface(ivisurface->layout_surface);
         wl_list_for_each(st_focus, &ivisurface->accepted_seat_list, link) {
             ivi_input_send_input_focus(resource, ivi_surf_id,
-                                       st_focus->focus, ILM_TRUE);
-            ivi_input_send_input_acceptance(resource, ivi_surf_id,
-                                            st_focus->seat_ctx->west_seat->seat_name,
-                                            ILM_TRUE);
+                                       st_focus->entry.focus, ILM_TRUE);
         }
     }
 }
@@ -1249,6 +2784,17 @@ destroy_input_context(struct input_context *ctx)
     struct ivisurface *surf_ctx;
     struct ivisurface *tmp_surf_ctx;
     struct wl_resource *resource, *tmp_resource;
+    struct pick_output *pick_output, *tmp_pick_output;
+
+    if (ctx->acceptance_idle) {
+        wl_event_source_remove(ctx->acceptance_idle);
+        ctx->acceptance_idle = NULL;
+    }
+
+    if (ctx->player)
+        ivi_input_player_destroy(ctx->player);
+    if (ctx->recorder)
+        ivi_input_recorder_destroy(ctx->recorder);
 
     wl_list_for_each_safe(seat, tmp, &ctx->seat_list, seat_node) {
         /* The ivi-input-controller destroys a seat proactively, need to
@@ -1274,10 +2820,23 @@ destroy_input_context(struct input_context *ctx)
         input_ctrl_free_surf_ctx(ctx, surf_ctx);
     }
 
+    if (ctx->touch_scope)
+        weston_log_scope_destroy(ctx->touch_scope);
+    if (ctx->latency_scope)
+        weston_log_scope_destroy(ctx->latency_scope);
+
     wl_list_remove(&ctx->seat_create_listener.link);
     wl_list_remove(&ctx->surface_created.link);
     wl_list_remove(&ctx->surface_destroyed.link);
+    wl_list_remove(&ctx->scene_changed.link);
+    wl_list_remove(&ctx->output_created.link);
+    wl_list_for_each_safe(pick_output, tmp_pick_output,
+                          &ctx->pick_outputs, link)
+        destroy_pick_output(pick_output);
     wl_list_remove(&ctx->shell_destroy_listener.link);
+    ivi_input_index_release(&ctx->pick_index);
+    wl_array_release(&ctx->pending_acceptance);
+    wl_array_release(&ctx->seats_by_id);
 
     wl_resource_for_each_safe(resource, tmp_resource, &ctx->resource_list) {
         /*We have set destroy function for this resource.
@@ -1336,6 +2895,7 @@ get_config( struct input_context *ctx)
     int ret = 0;
     struct weston_config *config = NULL;
     struct weston_config_section *section = NULL;
+    char *record_path = NULL;
     ctx->seat_default_name = NULL;
 
     config = wet_get_config(ctx->ivishell->compositor);
@@ -1349,6 +2909,16 @@ get_config( struct input_context *ctx)
     weston_config_section_get_string(section,
                        "default-seat",
                        &ctx->seat_default_name, "default");
+
+    weston_config_section_get_string(section, "input-record",
+                                     &record_path, NULL);
+    if (record_path) {
+        ctx->recorder = ivi_input_recorder_create(record_path);
+        free(record_path);
+    }
+
+    weston_config_section_get_bool(section, "input-replay",
+                                   &ctx->replay_enabled, false);
 exit:
     if (!ctx->seat_default_name) {
         ctx->seat_default_name = strdup("default");
@@ -1366,6 +2936,7 @@ create_input_context(struct ivishell *shell)
 {
     struct input_context *ctx = NULL;
     struct weston_seat *seat;
+    struct weston_output *output;
     ctx = calloc(1, sizeof *ctx);
     if (ctx == NULL) {
         weston_log("%s: Failed to allocate memory for input context\n",
@@ -1376,6 +2947,8 @@ create_input_context(struct ivishell *shell)
     ctx->ivishell = shell;
     wl_list_init(&ctx->resource_list);
     wl_list_init(&ctx->seat_list);
+    wl_array_init(&ctx->seats_by_id);
+    wl_array_init(&ctx->pending_acceptance);
 
     /* get the default seat*/
     if (get_config(ctx) != 0) {
@@ -1389,9 +2962,31 @@ create_input_context(struct ivishell *shell)
 
     wl_signal_add(&ctx->ivishell->ivisurface_created_signal, &ctx->surface_created);
     wl_signal_add(&ctx->ivishell->ivisurface_removed_signal, &ctx->surface_destroyed);
+
+    ivi_input_index_init(&ctx->pick_index);
+    ctx->pick_index_dirty = true;
+    ctx->scene_changed.notify = handle_scene_changed;
+    wl_signal_add(&ctx->ivishell->scene_changed_signal, &ctx->scene_changed);
+    wl_list_init(&ctx->pick_outputs);
+    ctx->output_created.notify = handle_output_created;
+    wl_signal_add(&ctx->ivishell->compositor->output_created_signal,
+                  &ctx->output_created);
+    wl_list_for_each(output, &ctx->ivishell->compositor->output_list, link)
+        handle_output_created(&ctx->output_created, output);
     ctx->ivishell->interface->shell_add_destroy_listener_once(
             &ctx->shell_destroy_listener, input_controller_destroy);
 
+    ctx->touch_scope =
+        weston_compositor_add_log_scope(ctx->ivishell->compositor,
+                                        "ivi-input-touch",
+                                        "touch motion delivery of every seat\n",
+                                        print_touch_stats, NULL, ctx);
+    ctx->latency_scope =
+        weston_compositor_add_log_scope(ctx->ivishell->compositor,
+                                        "ivi-input-latency",
+                                        "latency of the input events sent to clients\n",
+                                        print_latency_stats, NULL, ctx);
+
     ctx->seat_create_listener.notify = &handle_seat_create;
     wl_signal_add(&ctx->ivishell->compositor->seat_created_signal, &ctx->seat_create_listener);
 
@@ -1422,7 +3017,7 @@ input_controller_init(struct ivishell *shell)
                 successful_init_stage++;
             break;
         case 1:
-            if (wl_global_create(shell->compositor->wl_display, &ivi_input_interface, 2,
+            if (wl_global_create(shell->compositor->wl_display, &ivi_input_interface, 3,
                                  ctx, bind_ivi_input) != NULL) {
                 successful_init_stage++;
             }
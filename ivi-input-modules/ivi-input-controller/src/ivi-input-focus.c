@@ -0,0 +1,81 @@
+/*
+ * Copyright (C) 2017 Advanced Driver Information Technology Joint Venture GmbH
+ *
+ * Permission to use, copy, modify, distribute, and sell this software and
+ * its documentation for any purpose is hereby granted without fee, provided
+ * that the above copyright notice appear in all copies and that both that
+ * copyright notice and this permission notice appear in supporting
+ * documentation, and that the name of the copyright holders not be used in
+ * advertising or publicity pertaining to distribution of the software
+ * without specific, written prior permission.  The copyright holders make
+ * no representations about the suitability of this software for any
+ * purpose.  It is provided "as is" without express or implied warranty.
+ *
+ * THE COPYRIGHT HOLDERS DISCLAIM ALL WARRANTIES WITH REGARD TO THIS
+ * SOFTWARE, INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND
+ * FITNESS, IN NO EVENT SHALL THE COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * SPECIAL, INDIRECT OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER
+ * RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF
+ * CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+ * CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+
+#include <stdbool.h>
+
+#include "ivi-input-focus.h"
+
+void
+ivi_input_focus_index_init(struct ivi_input_focus_index *index,
+                           uint32_t index_mask)
+{
+    wl_list_init(&index->entries);
+    index->index_mask = index_mask;
+}
+
+void
+ivi_input_focus_entry_init(struct ivi_input_focus_entry *entry)
+{
+    entry->focus = 0;
+    wl_list_init(&entry->link);
+}
+
+void
+ivi_input_focus_index_update(struct ivi_input_focus_index *index,
+                             struct ivi_input_focus_entry *entry)
+{
+    bool indexed = !wl_list_empty(&entry->link);
+    bool focused = (entry->focus & index->index_mask) != 0;
+
+    if (focused && !indexed) {
+        wl_list_insert(index->entries.prev, &entry->link);
+    } else if (!focused && indexed) {
+        wl_list_remove(&entry->link);
+        wl_list_init(&entry->link);
+    }
+}
+
+void
+ivi_input_focus_entry_remove(struct ivi_input_focus_entry *entry)
+{
+    wl_list_remove(&entry->link);
+    wl_list_init(&entry->link);
+}
+
+uint32_t
+ivi_input_focus_route(struct ivi_input_focus_index *index, uint32_t mask,
+                      ivi_input_focus_func func, void *user_data)
+{
+    struct ivi_input_focus_entry *entry;
+    uint32_t count = 0;
+
+    wl_list_for_each(entry, &index->entries, link) {
+        if (!(entry->focus & mask))
+            continue;
+
+        func(entry, user_data);
+        count++;
+    }
+
+    return count;
+}
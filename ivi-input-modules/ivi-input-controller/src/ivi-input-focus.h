@@ -0,0 +1,77 @@
+/*
+ * Copyright (C) 2017 Advanced Driver Information Technology Joint Venture GmbH
+ *
+ * Permission to use, copy, modify, distribute, and sell this software and
+ * its documentation for any purpose is hereby granted without fee, provided
+ * that the above copyright notice appear in all copies and that both that
+ * copyright notice and this permission notice appear in supporting
+ * documentation, and that the name of the copyright holders not be used in
+ * advertising or publicity pertaining to distribution of the software
+ * without specific, written prior permission.  The copyright holders make
+ * no representations about the suitability of this software for any
+ * purpose.  It is provided "as is" without express or implied warranty.
+ *
+ * THE COPYRIGHT HOLDERS DISCLAIM ALL WARRANTIES WITH REGARD TO THIS
+ * SOFTWARE, INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND
+ * FITNESS, IN NO EVENT SHALL THE COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * SPECIAL, INDIRECT OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER
+ * RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF
+ * CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+ * CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#ifndef IVI_INPUT_MODULES_IVI_INPUT_CONTROLLER_SRC_IVI_INPUT_FOCUS_H_
+#define IVI_INPUT_MODULES_IVI_INPUT_CONTROLLER_SRC_IVI_INPUT_FOCUS_H_
+
+#include <stdint.h>
+
+#include <wayland-util.h>
+
+/* Focus index of a seat
+ *
+ * Every surface which accepts a seat has an entry with the focus bits of
+ * the seat on it. The index lists the entries which have a bit of
+ * index_mask set, in the order they got it, so an event is routed to the
+ * focused surfaces without walking all surfaces accepting the seat.
+ */
+struct ivi_input_focus_index {
+    struct wl_list entries;
+    uint32_t index_mask;
+};
+
+struct ivi_input_focus_entry {
+    /* focus bits, ivi_input_focus_index_update() after changing them */
+    uint32_t focus;
+    struct wl_list link;
+};
+
+/* Called for every entry an event is routed to */
+typedef void (*ivi_input_focus_func)(struct ivi_input_focus_entry *entry,
+                                     void *user_data);
+
+void
+ivi_input_focus_index_init(struct ivi_input_focus_index *index,
+                           uint32_t index_mask);
+
+void
+ivi_input_focus_entry_init(struct ivi_input_focus_entry *entry);
+
+/* Add or remove the entry, after its focus bits changed */
+void
+ivi_input_focus_index_update(struct ivi_input_focus_index *index,
+                             struct ivi_input_focus_entry *entry);
+
+/* Remove the entry from the index it is in, if any */
+void
+ivi_input_focus_entry_remove(struct ivi_input_focus_entry *entry);
+
+/* Call func for the entries with a bit of mask in their focus, mask must
+ * be part of index_mask. The index must not change meanwhile.
+ *
+ * \return the number of entries func was called for
+ */
+uint32_t
+ivi_input_focus_route(struct ivi_input_focus_index *index, uint32_t mask,
+                      ivi_input_focus_func func, void *user_data);
+
+#endif /* IVI_INPUT_MODULES_IVI_INPUT_CONTROLLER_SRC_IVI_INPUT_FOCUS_H_ */
@@ -0,0 +1,217 @@
+/*
+ * Copyright (C) 2017 Advanced Driver Information Technology Joint Venture GmbH
+ *
+ * Permission to use, copy, modify, distribute, and sell this software and
+ * its documentation for any purpose is hereby granted without fee, provided
+ * that the above copyright notice appear in all copies and that both that
+ * copyright notice and this permission notice appear in supporting
+ * documentation, and that the name of the copyright holders not be used in
+ * advertising or publicity pertaining to distribution of the software
+ * without specific, written prior permission.  The copyright holders make
+ * no representations about the suitability of this software for any
+ * purpose.  It is provided "as is" without express or implied warranty.
+ *
+ * THE COPYRIGHT HOLDERS DISCLAIM ALL WARRANTIES WITH REGARD TO THIS
+ * SOFTWARE, INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND
+ * FITNESS, IN NO EVENT SHALL THE COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * SPECIAL, INDIRECT OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER
+ * RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF
+ * CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+ * CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "ivi-input-index.h"
+
+/* Edge of a cell in pixels, grown until the grid has at most
+ * MAX_CELLS cells */
+#define CELL_SIZE 64
+#define MAX_CELLS 4096
+
+void
+ivi_input_index_init(struct ivi_input_index *index)
+{
+    memset(index, 0, sizeof *index);
+    wl_array_init(&index->entries);
+    wl_array_init(&index->cells);
+    wl_array_init(&index->cell_entries);
+}
+
+void
+ivi_input_index_release(struct ivi_input_index *index)
+{
+    wl_array_release(&index->entries);
+    wl_array_release(&index->cells);
+    wl_array_release(&index->cell_entries);
+}
+
+void
+ivi_input_index_clear(struct ivi_input_index *index)
+{
+    index->entries.size = 0;
+    index->cells.size = 0;
+    index->cell_entries.size = 0;
+    index->columns = 0;
+    index->rows = 0;
+}
+
+int
+ivi_input_index_add(struct ivi_input_index *index, void *data,
+                    int32_t x1, int32_t y1, int32_t x2, int32_t y2)
+{
+    struct ivi_input_index_entry *entry;
+
+    if (x1 >= x2 || y1 >= y2)
+        return 0;
+
+    entry = wl_array_add(&index->entries, sizeof *entry);
+    if (entry == NULL)
+        return -1;
+
+    entry->data = data;
+    entry->x1 = x1;
+    entry->y1 = y1;
+    entry->x2 = x2;
+    entry->y2 = y2;
+
+    return 0;
+}
+
+/* Range of cells covered by an entry, inclusive */
+static void
+entry_cells(struct ivi_input_index *index,
+            const struct ivi_input_index_entry *entry,
+            int32_t *c1, int32_t *r1, int32_t *c2, int32_t *r2)
+{
+    *c1 = (entry->x1 - index->x) / index->cell_size;
+    *r1 = (entry->y1 - index->y) / index->cell_size;
+    *c2 = (entry->x2 - 1 - index->x) / index->cell_size;
+    *r2 = (entry->y2 - 1 - index->y) / index->cell_size;
+}
+
+int
+ivi_input_index_build(struct ivi_input_index *index)
+{
+    struct ivi_input_index_entry *entries = index->entries.data;
+    uint32_t count = index->entries.size / sizeof *entries;
+    int64_t x1, y1, x2, y2;
+    uint32_t *cells, *cell_entries;
+    uint32_t i, total = 0;
+    int32_t c, r, c1, r1, c2, r2;
+    size_t cell_count;
+
+    index->cells.size = 0;
+    index->cell_entries.size = 0;
+    index->columns = 0;
+    index->rows = 0;
+
+    if (count == 0)
+        return 0;
+
+    x1 = entries[0].x1;
+    y1 = entries[0].y1;
+    x2 = entries[0].x2;
+    y2 = entries[0].y2;
+    for (i = 1; i < count; i++) {
+        if (entries[i].x1 < x1)
+            x1 = entries[i].x1;
+        if (entries[i].y1 < y1)
+            y1 = entries[i].y1;
+        if (entries[i].x2 > x2)
+            x2 = entries[i].x2;
+        if (entries[i].y2 > y2)
+            y2 = entries[i].y2;
+    }
+
+    index->x = x1;
+    index->y = y1;
+    index->cell_size = CELL_SIZE;
+    for (;;) {
+        index->columns = (x2 - x1 + index->cell_size - 1) / index->cell_size;
+        index->rows = (y2 - y1 + index->cell_size - 1) / index->cell_size;
+        if ((int64_t)index->columns * index->rows <= MAX_CELLS)
+            break;
+        index->cell_size *= 2;
+    }
+
+    cell_count = (size_t)index->columns * index->rows;
+    cells = wl_array_add(&index->cells, (cell_count + 1) * sizeof *cells);
+    if (cells == NULL)
+        goto err;
+    memset(cells, 0, (cell_count + 1) * sizeof *cells);
+
+    /* count the entries of every cell, then turn the counts into the
+     * offsets of the cells */
+    for (i = 0; i < count; i++) {
+        entry_cells(index, &entries[i], &c1, &r1, &c2, &r2);
+        for (r = r1; r <= r2; r++)
+            for (c = c1; c <= c2; c++)
+                cells[r * index->columns + c + 1]++;
+    }
+
+    for (i = 1; i <= cell_count; i++) {
+        total += cells[i];
+        cells[i] = total;
+    }
+
+    cell_entries = wl_array_add(&index->cell_entries,
+                                total * sizeof *cell_entries);
+    if (cell_entries == NULL && total > 0)
+        goto err;
+
+    /* fill in entry order, cells[i] ends up at the end of cell i */
+    for (i = 0; i < count; i++) {
+        entry_cells(index, &entries[i], &c1, &r1, &c2, &r2);
+        for (r = r1; r <= r2; r++)
+            for (c = c1; c <= c2; c++)
+                cell_entries[cells[r * index->columns + c]++] = i;
+    }
+
+    memmove(cells + 1, cells, cell_count * sizeof *cells);
+    cells[0] = 0;
+
+    return 0;
+
+err:
+    index->cells.size = 0;
+    index->cell_entries.size = 0;
+    index->columns = 0;
+    index->rows = 0;
+    return -1;
+}
+
+void *
+ivi_input_index_pick(struct ivi_input_index *index, int32_t x, int32_t y,
+                     ivi_input_index_accept_func accept, void *user_data)
+{
+    struct ivi_input_index_entry *entries = index->entries.data;
+    struct ivi_input_index_entry *entry;
+    uint32_t *cells = index->cells.data;
+    uint32_t *cell_entries = index->cell_entries.data;
+    int32_t column, row;
+    uint32_t cell, i;
+
+    if (index->columns == 0 || x < index->x || y < index->y)
+        return NULL;
+
+    column = (x - index->x) / index->cell_size;
+    row = (y - index->y) / index->cell_size;
+    if (column >= index->columns || row >= index->rows)
+        return NULL;
+
+    cell = row * index->columns + column;
+    for (i = cells[cell]; i < cells[cell + 1]; i++) {
+        entry = &entries[cell_entries[i]];
+        if (x < entry->x1 || x >= entry->x2 ||
+            y < entry->y1 || y >= entry->y2)
+            continue;
+
+        if (accept == NULL || accept(entry->data, user_data))
+            return entry->data;
+    }
+
+    return NULL;
+}
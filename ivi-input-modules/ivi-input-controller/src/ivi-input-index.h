@@ -0,0 +1,89 @@
+/*
+ * Copyright (C) 2017 Advanced Driver Information Technology Joint Venture GmbH
+ *
+ * Permission to use, copy, modify, distribute, and sell this software and
+ * its documentation for any purpose is hereby granted without fee, provided
+ * that the above copyright notice appear in all copies and that both that
+ * copyright notice and this permission notice appear in supporting
+ * documentation, and that the name of the copyright holders not be used in
+ * advertising or publicity pertaining to distribution of the software
+ * without specific, written prior permission.  The copyright holders make
+ * no representations about the suitability of this software for any
+ * purpose.  It is provided "as is" without express or implied warranty.
+ *
+ * THE COPYRIGHT HOLDERS DISCLAIM ALL WARRANTIES WITH REGARD TO THIS
+ * SOFTWARE, INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND
+ * FITNESS, IN NO EVENT SHALL THE COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * SPECIAL, INDIRECT OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER
+ * RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF
+ * CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+ * CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#ifndef IVI_INPUT_MODULES_IVI_INPUT_CONTROLLER_SRC_IVI_INPUT_INDEX_H_
+#define IVI_INPUT_MODULES_IVI_INPUT_CONTROLLER_SRC_IVI_INPUT_INDEX_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <wayland-util.h>
+
+/* Spatial index of the input rectangles of surfaces
+ *
+ * Rectangles are added from the top of the scene to the bottom, then the
+ * index is built into a uniform grid over their bounding box. Every cell
+ * lists the rectangles overlapping it in the order they were added, so a
+ * pick only tests the rectangles of one cell.
+ */
+struct ivi_input_index {
+    /* struct ivi_input_index_entry, top to bottom */
+    struct wl_array entries;
+    /* cell i lists entry indices cell_entries[cells[i]..cells[i + 1]) */
+    struct wl_array cells;
+    struct wl_array cell_entries;
+    int32_t x, y;
+    int32_t columns, rows;
+    int32_t cell_size;
+};
+
+struct ivi_input_index_entry {
+    void *data;
+    int32_t x1, y1, x2, y2;
+};
+
+/* Tells whether data takes input at the point, to pick it */
+typedef bool (*ivi_input_index_accept_func)(void *data, void *user_data);
+
+void
+ivi_input_index_init(struct ivi_input_index *index);
+
+void
+ivi_input_index_release(struct ivi_input_index *index);
+
+/* Remove all rectangles, to add the scene again */
+void
+ivi_input_index_clear(struct ivi_input_index *index);
+
+/* Add a rectangle below the ones added before, x2 and y2 are exclusive
+ *
+ * \return 0 on success, -1 if out of memory
+ */
+int
+ivi_input_index_add(struct ivi_input_index *index, void *data,
+                    int32_t x1, int32_t y1, int32_t x2, int32_t y2);
+
+/* Build the grid of the rectangles added since the last clear
+ *
+ * \return 0 on success, -1 if out of memory
+ */
+int
+ivi_input_index_build(struct ivi_input_index *index);
+
+/* Data of the topmost rectangle containing the point which accept, when
+ * not NULL, returns true for
+ */
+void *
+ivi_input_index_pick(struct ivi_input_index *index, int32_t x, int32_t y,
+                     ivi_input_index_accept_func accept, void *user_data);
+
+#endif /* IVI_INPUT_MODULES_IVI_INPUT_CONTROLLER_SRC_IVI_INPUT_INDEX_H_ */
@@ -0,0 +1,635 @@
+/*
+ * Copyright (C) 2017 Advanced Driver Information Technology Joint Venture GmbH
+ *
+ * Permission to use, copy, modify, distribute, and sell this software and
+ * its documentation for any purpose is hereby granted without fee, provided
+ * that the above copyright notice appear in all copies and that both that
+ * copyright notice and this permission notice appear in supporting
+ * documentation, and that the name of the copyright holders not be used in
+ * advertising or publicity pertaining to distribution of the software
+ * without specific, written prior permission.  The copyright holders make
+ * no representations about the suitability of this software for any
+ * purpose.  It is provided "as is" without express or implied warranty.
+ *
+ * THE COPYRIGHT HOLDERS DISCLAIM ALL WARRANTIES WITH REGARD TO THIS
+ * SOFTWARE, INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND
+ * FITNESS, IN NO EVENT SHALL THE COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * SPECIAL, INDIRECT OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER
+ * RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF
+ * CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+ * CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include <libweston/libweston.h>
+
+#include "ivi-input-replay.h"
+
+/* Seat names are at most this long in a trace */
+#define MAX_SEAT_NAME 255
+
+struct ivi_input_recorder {
+    FILE *file;
+    /* char *, names of the seats written so far, by seat index */
+    struct wl_array seats;
+    uint64_t time_us;
+};
+
+/* Traces are read in chunks of this many records, one chunk per
+ * iteration of the event loop at most */
+#define REPLAY_CHUNK_RECORDS 256
+/* Larger traces are refused */
+#define REPLAY_MAX_TRACE_SIZE (16 * 1024 * 1024)
+
+struct ivi_input_player {
+    struct weston_compositor *compositor;
+    /* seat of trace seats without a seat of their name */
+    char *default_seat;
+    struct wl_event_source *timer;
+
+    /* the running replay */
+    bool running;
+    FILE *file;
+    uint32_t record_size;
+    char *buffer;
+    bool eof;
+    /* struct ivi_input_record, the chunk read last */
+    struct wl_array records;
+    uint32_t next;
+    /* char *, names of the seats of the trace, by seat index */
+    struct wl_array trace_seats;
+    uint32_t events;
+    bool timed;
+    uint64_t first_time_us;
+    int64_t start_us;
+    double speed;
+    ivi_input_replay_done_func done;
+    void *done_data;
+};
+
+static uint64_t
+timespec_to_us(const struct timespec *time)
+{
+    return (uint64_t)time->tv_sec * 1000000 + time->tv_nsec / 1000;
+}
+
+struct ivi_input_recorder *
+ivi_input_recorder_create(const char *path)
+{
+    struct ivi_input_recorder *recorder;
+    struct ivi_input_record_header header = {
+        .magic = IVI_INPUT_RECORD_MAGIC,
+        .version = IVI_INPUT_RECORD_VERSION,
+        .record_size = sizeof(struct ivi_input_record),
+    };
+
+    recorder = calloc(1, sizeof *recorder);
+    if (recorder == NULL) {
+        weston_log("%s: Failed to allocate memory for input recorder\n",
+                   __FUNCTION__);
+        return NULL;
+    }
+
+    wl_array_init(&recorder->seats);
+
+    recorder->file = fopen(path, "we");
+    if (recorder->file == NULL ||
+        fwrite(&header, sizeof header, 1, recorder->file) != 1) {
+        weston_log("%s: Failed to write input trace %s\n",
+                   __FUNCTION__, path);
+        ivi_input_recorder_destroy(recorder);
+        return NULL;
+    }
+
+    weston_log("ivi-input-controller: recording input to %s\n", path);
+
+    return recorder;
+}
+
+void
+ivi_input_recorder_destroy(struct ivi_input_recorder *recorder)
+{
+    char **name;
+
+    if (recorder->file)
+        fclose(recorder->file);
+
+    wl_array_for_each(name, &recorder->seats)
+        free(*name);
+    wl_array_release(&recorder->seats);
+    free(recorder);
+}
+
+/* Index of the seat in the trace, written with its name on first use */
+static int
+recorder_get_seat(struct ivi_input_recorder *recorder,
+                  struct weston_seat *seat)
+{
+    static const char padding[8];
+    struct ivi_input_record record = { 0 };
+    char **names = recorder->seats.data;
+    int count = recorder->seats.size / sizeof *names;
+    size_t length;
+    char **name;
+    int i;
+
+    for (i = 0; i < count; i++) {
+        if (strcmp(names[i], seat->seat_name) == 0)
+            return i;
+    }
+
+    length = strlen(seat->seat_name);
+    if (count > UINT16_MAX || length == 0 || length > MAX_SEAT_NAME)
+        return -1;
+
+    name = wl_array_add(&recorder->seats, sizeof *name);
+    if (name == NULL)
+        return -1;
+
+    *name = strdup(seat->seat_name);
+    if (*name == NULL) {
+        recorder->seats.size -= sizeof *name;
+        return -1;
+    }
+
+    record.time_us = recorder->time_us;
+    record.type = IVI_INPUT_RECORD_SEAT;
+    record.seat = count;
+    record.args[0] = length;
+
+    fwrite(&record, sizeof record, 1, recorder->file);
+    fwrite(seat->seat_name, length, 1, recorder->file);
+    fwrite(padding, (8 - length % 8) % 8, 1, recorder->file);
+
+    return count;
+}
+
+void
+ivi_input_recorder_add(struct ivi_input_recorder *recorder,
+                       struct weston_seat *seat,
+                       enum ivi_input_record_type type,
+                       const struct timespec *time,
+                       int32_t arg0, int32_t arg1, int32_t arg2)
+{
+    struct ivi_input_record record = { 0 };
+    int index;
+
+    if (time)
+        recorder->time_us = timespec_to_us(time);
+
+    index = recorder_get_seat(recorder, seat);
+    if (index < 0)
+        return;
+
+    record.time_us = recorder->time_us;
+    record.type = type;
+    record.seat = index;
+    record.args[0] = arg0;
+    record.args[1] = arg1;
+    record.args[2] = arg2;
+
+    fwrite(&record, sizeof record, 1, recorder->file);
+}
+
+static void
+player_reset(struct ivi_input_player *player)
+{
+    char **name;
+
+    if (player->file)
+        fclose(player->file);
+    player->file = NULL;
+    free(player->buffer);
+    player->buffer = NULL;
+
+    wl_array_for_each(name, &player->trace_seats)
+        free(*name);
+    player->trace_seats.size = 0;
+    player->records.size = 0;
+    player->next = 0;
+    player->events = 0;
+    player->eof = false;
+    player->timed = false;
+    player->running = false;
+    player->done = NULL;
+    player->done_data = NULL;
+}
+
+/* Reads the next records of the trace into player->records
+ *
+ * \return 0 on success, also at the end of the trace, -1 if the trace is
+ *         invalid
+ */
+static int
+read_chunk(struct ivi_input_player *player)
+{
+    struct ivi_input_record *record;
+    char **trace_seat;
+    char name[MAX_SEAT_NAME + 8];
+    size_t length;
+
+    player->records.size = 0;
+    player->next = 0;
+
+    while (player->records.size / sizeof *record < REPLAY_CHUNK_RECORDS) {
+        if (fread(player->buffer, player->record_size, 1,
+                  player->file) != 1) {
+            player->eof = true;
+            return feof(player->file) ? 0 : -1;
+        }
+        record = (struct ivi_input_record *)player->buffer;
+
+        if (record->type == IVI_INPUT_RECORD_SEAT) {
+            length = record->args[0];
+            if (length == 0 || length > MAX_SEAT_NAME ||
+                fread(name, (length + 7) & ~7u, 1, player->file) != 1)
+                return -1;
+            name[length] = '\0';
+
+            trace_seat = wl_array_add(&player->trace_seats,
+                                      sizeof *trace_seat);
+            if (trace_seat == NULL)
+                return -1;
+            *trace_seat = strdup(name);
+            if (*trace_seat == NULL) {
+                player->trace_seats.size -= sizeof *trace_seat;
+                return -1;
+            }
+            continue;
+        }
+
+        if (record->type == 0 ||
+            record->type > IVI_INPUT_RECORD_TOUCH_CANCEL ||
+            record->seat >= player->trace_seats.size / sizeof(char *)) {
+            weston_log("%s: invalid record of type %u\n",
+                       __FUNCTION__, record->type);
+            return -1;
+        }
+
+        record = wl_array_add(&player->records, sizeof *record);
+        if (record == NULL)
+            return -1;
+        memcpy(record, player->buffer, sizeof *record);
+    }
+
+    return 0;
+}
+
+static int64_t
+current_time_us(struct ivi_input_player *player)
+{
+    struct timespec now;
+
+    clock_gettime(player->compositor->presentation_clock, &now);
+    return timespec_to_us(&now);
+}
+
+/* The seat named like the seat of the trace, or the default seat */
+static struct weston_seat *
+player_get_seat(struct ivi_input_player *player, const char *name)
+{
+    struct weston_seat *seat;
+    struct weston_seat *fallback = NULL;
+
+    wl_list_for_each(seat, &player->compositor->seat_list, link) {
+        if (strcmp(seat->seat_name, name) == 0)
+            return seat;
+        if (player->default_seat &&
+            strcmp(seat->seat_name, player->default_seat) == 0)
+            fallback = seat;
+    }
+
+    return fallback;
+}
+
+/* Feeds a record to the active grab of the device, as libweston does for
+ * the events of a backend. Events of devices the seat does not have are
+ * dropped.
+ *
+ * \return true if the event was injected
+ */
+static bool
+inject_record(struct ivi_input_player *player,
+              const struct ivi_input_record *record)
+{
+    char **trace_seats = player->trace_seats.data;
+    struct weston_seat *seat = player_get_seat(player,
+                                               trace_seats[record->seat]);
+    struct weston_keyboard *keyboard;
+    struct weston_pointer *pointer;
+    struct weston_touch *touch;
+    struct weston_pointer_motion_event motion = { 0 };
+    struct weston_pointer_axis_event axis = { 0 };
+    struct weston_coord_global pos;
+    struct timespec now;
+
+    if (seat == NULL)
+        return false;
+
+    keyboard = weston_seat_get_keyboard(seat);
+    pointer = weston_seat_get_pointer(seat);
+    touch = weston_seat_get_touch(seat);
+
+    /* stamped like the events of libinput */
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    switch (record->type) {
+    case IVI_INPUT_RECORD_KEY:
+        if (keyboard == NULL)
+            return false;
+        keyboard->grab->interface->key(keyboard->grab, &now,
+                                       record->args[0], record->args[1]);
+        return true;
+
+    case IVI_INPUT_RECORD_POINTER_MOTION:
+        if (pointer == NULL)
+            return false;
+        motion.mask = WESTON_POINTER_MOTION_ABS;
+        motion.abs.c = weston_coord_from_fixed(record->args[0],
+                                               record->args[1]);
+        pointer->grab->interface->motion(pointer->grab, &now, &motion);
+        return true;
+
+    case IVI_INPUT_RECORD_BUTTON:
+        if (pointer == NULL)
+            return false;
+        if (record->args[1] == WL_POINTER_BUTTON_STATE_PRESSED) {
+            if (pointer->button_count == 0) {
+                pointer->grab_button = record->args[0];
+                pointer->grab_time = now;
+                pointer->grab_pos = pointer->pos;
+            }
+            pointer->button_count++;
+        } else if (pointer->button_count > 0) {
+            pointer->button_count--;
+        }
+        pointer->grab->interface->button(pointer->grab, &now,
+                                         record->args[0], record->args[1]);
+        if (pointer->button_count == 1)
+            pointer->grab_serial =
+                wl_display_get_serial(player->compositor->wl_display);
+        return true;
+
+    case IVI_INPUT_RECORD_AXIS:
+        if (pointer == NULL)
+            return false;
+        axis.axis = record->args[0];
+        axis.value = wl_fixed_to_double(record->args[1]);
+        pointer->grab->interface->axis(pointer->grab, &now, &axis);
+        return true;
+
+    case IVI_INPUT_RECORD_AXIS_SOURCE:
+        if (pointer == NULL)
+            return false;
+        pointer->grab->interface->axis_source(pointer->grab,
+                                              record->args[0]);
+        return true;
+
+    case IVI_INPUT_RECORD_POINTER_FRAME:
+        if (pointer == NULL)
+            return false;
+        pointer->grab->interface->frame(pointer->grab);
+        return true;
+
+    case IVI_INPUT_RECORD_TOUCH_DOWN:
+        if (touch == NULL)
+            return false;
+        pos.c = weston_coord_from_fixed(record->args[1], record->args[2]);
+        touch->num_tp++;
+        if (touch->num_tp == 1) {
+            weston_touch_set_focus(touch,
+                    weston_compositor_pick_view(player->compositor, pos));
+        } else if (touch->focus == NULL) {
+            return false;
+        }
+        touch->grab->interface->down(touch->grab, &now, record->args[0],
+                                     record->args[1], record->args[2]);
+        if (touch->num_tp == 1) {
+            touch->grab_serial =
+                wl_display_get_serial(player->compositor->wl_display);
+            touch->grab_touch_id = record->args[0];
+            touch->grab_time = now;
+            touch->grab_pos = pos;
+        }
+        return true;
+
+    case IVI_INPUT_RECORD_TOUCH_MOTION:
+        if (touch == NULL || touch->focus == NULL)
+            return false;
+        touch->grab->interface->motion(touch->grab, &now, record->args[0],
+                                       record->args[1], record->args[2]);
+        return true;
+
+    case IVI_INPUT_RECORD_TOUCH_UP:
+        if (touch == NULL || touch->num_tp == 0)
+            return false;
+        touch->num_tp--;
+        touch->grab->interface->up(touch->grab, &now, record->args[0]);
+        if (touch->num_tp == 0)
+            weston_touch_set_focus(touch, NULL);
+        return true;
+
+    case IVI_INPUT_RECORD_TOUCH_FRAME:
+        if (touch == NULL)
+            return false;
+        touch->grab->interface->frame(touch->grab);
+        return true;
+
+    case IVI_INPUT_RECORD_TOUCH_CANCEL:
+        if (touch == NULL)
+            return false;
+        touch->grab->interface->cancel(touch->grab);
+        return true;
+
+    default:
+        return false;
+    }
+}
+
+static void
+player_finish(struct ivi_input_player *player, bool success)
+{
+    ivi_input_replay_done_func done = player->done;
+    void *done_data = player->done_data;
+    uint32_t events = player->events;
+
+    player_reset(player);
+
+    if (done)
+        done(done_data, events, success);
+}
+
+/* Injects the due records of the current chunk, and reads the next chunk
+ * in the next iteration of the event loop */
+static int
+replay_next(void *data)
+{
+    struct ivi_input_player *player = data;
+    struct ivi_input_record *records;
+    uint32_t count;
+    int64_t due_us, now_us;
+
+    if (player->next == player->records.size / sizeof *records) {
+        if (player->eof) {
+            player_finish(player, true);
+            return 0;
+        }
+        if (read_chunk(player) < 0) {
+            weston_log("%s: the trace is invalid\n", __FUNCTION__);
+            player_finish(player, false);
+            return 0;
+        }
+    }
+
+    records = player->records.data;
+    count = player->records.size / sizeof *records;
+
+    if (!player->timed && count > 0) {
+        player->first_time_us = records[0].time_us;
+        player->start_us = current_time_us(player);
+        player->timed = true;
+    }
+
+    while (player->next < count) {
+        if (player->speed > 0) {
+            due_us = player->start_us +
+                     (int64_t)((int64_t)(records[player->next].time_us -
+                                         player->first_time_us) /
+                               player->speed);
+            now_us = current_time_us(player);
+            if (due_us > now_us) {
+                wl_event_source_timer_update(player->timer,
+                        (int)((due_us - now_us + 999) / 1000));
+                return 0;
+            }
+        }
+
+        if (inject_record(player, &records[player->next]))
+            player->events++;
+        player->next++;
+    }
+
+    /* the next chunk, or the end, after the loop dispatched other events */
+    wl_event_source_timer_update(player->timer, 1);
+
+    return 0;
+}
+
+struct ivi_input_player *
+ivi_input_player_create(struct weston_compositor *compositor,
+                        const char *default_seat)
+{
+    struct ivi_input_player *player;
+    struct wl_event_loop *loop;
+
+    player = calloc(1, sizeof *player);
+    if (player == NULL) {
+        weston_log("%s: Failed to allocate memory for input player\n",
+                   __FUNCTION__);
+        return NULL;
+    }
+
+    if (default_seat) {
+        player->default_seat = strdup(default_seat);
+        if (player->default_seat == NULL) {
+            free(player);
+            return NULL;
+        }
+    }
+
+    loop = wl_display_get_event_loop(compositor->wl_display);
+    player->timer = wl_event_loop_add_timer(loop, replay_next, player);
+    if (player->timer == NULL) {
+        free(player->default_seat);
+        free(player);
+        return NULL;
+    }
+
+    player->compositor = compositor;
+    wl_array_init(&player->records);
+    wl_array_init(&player->trace_seats);
+
+    return player;
+}
+
+void
+ivi_input_player_destroy(struct ivi_input_player *player)
+{
+    wl_event_source_remove(player->timer);
+
+    player_reset(player);
+    wl_array_release(&player->records);
+    wl_array_release(&player->trace_seats);
+    free(player->default_seat);
+    free(player);
+}
+
+int
+ivi_input_player_start(struct ivi_input_player *player, int fd, double speed,
+                       ivi_input_replay_done_func done, void *data)
+{
+    struct ivi_input_record_header header;
+    struct stat st;
+    int trace_fd;
+
+    if (player->running) {
+        weston_log("%s: a replay is running already\n", __FUNCTION__);
+        return -1;
+    }
+
+    /* a pipe or socket could block the compositor in read_chunk */
+    if (fstat(fd, &st) < 0 || !S_ISREG(st.st_mode)) {
+        weston_log("%s: the trace is not a regular file\n", __FUNCTION__);
+        return -1;
+    }
+
+    if (st.st_size > REPLAY_MAX_TRACE_SIZE) {
+        weston_log("%s: the trace is larger than %d bytes\n",
+                   __FUNCTION__, REPLAY_MAX_TRACE_SIZE);
+        return -1;
+    }
+
+    trace_fd = dup(fd);
+    player->file = trace_fd >= 0 ? fdopen(trace_fd, "r") : NULL;
+    if (player->file == NULL) {
+        if (trace_fd >= 0)
+            close(trace_fd);
+        return -1;
+    }
+
+    if (fread(&header, sizeof header, 1, player->file) != 1 ||
+        header.magic != IVI_INPUT_RECORD_MAGIC ||
+        header.version != IVI_INPUT_RECORD_VERSION ||
+        header.record_size < sizeof(struct ivi_input_record) ||
+        header.record_size > st.st_size) {
+        weston_log("%s: not an input trace\n", __FUNCTION__);
+        player_reset(player);
+        return -1;
+    }
+
+    /* records may grow in later versions of the format */
+    player->record_size = header.record_size;
+    player->buffer = malloc(header.record_size);
+    if (player->buffer == NULL) {
+        player_reset(player);
+        return -1;
+    }
+
+    player->speed = speed;
+    player->done = done;
+    player->done_data = data;
+    player->running = true;
+
+    /* the records are read from the event loop, after the caller returned */
+    wl_event_source_timer_update(player->timer, 1);
+
+    return 0;
+}
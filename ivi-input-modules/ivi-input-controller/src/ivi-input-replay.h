@@ -0,0 +1,84 @@
+/*
+ * Copyright (C) 2017 Advanced Driver Information Technology Joint Venture GmbH
+ *
+ * Permission to use, copy, modify, distribute, and sell this software and
+ * its documentation for any purpose is hereby granted without fee, provided
+ * that the above copyright notice appear in all copies and that both that
+ * copyright notice and this permission notice appear in supporting
+ * documentation, and that the name of the copyright holders not be used in
+ * advertising or publicity pertaining to distribution of the software
+ * without specific, written prior permission.  The copyright holders make
+ * no representations about the suitability of this software for any
+ * purpose.  It is provided "as is" without express or implied warranty.
+ *
+ * THE COPYRIGHT HOLDERS DISCLAIM ALL WARRANTIES WITH REGARD TO THIS
+ * SOFTWARE, INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND
+ * FITNESS, IN NO EVENT SHALL THE COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * SPECIAL, INDIRECT OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER
+ * RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF
+ * CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+ * CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#ifndef IVI_INPUT_MODULES_IVI_INPUT_CONTROLLER_SRC_IVI_INPUT_REPLAY_H_
+#define IVI_INPUT_MODULES_IVI_INPUT_CONTROLLER_SRC_IVI_INPUT_REPLAY_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <time.h>
+
+#include "ivi-input-record.h"
+
+struct weston_compositor;
+struct weston_seat;
+
+/* Writes the input events reaching the grabs of ivi-input-controller to
+ * a trace file, in the format of protocol/ivi-input-record.h */
+struct ivi_input_recorder;
+
+struct ivi_input_recorder *
+ivi_input_recorder_create(const char *path);
+
+void
+ivi_input_recorder_destroy(struct ivi_input_recorder *recorder);
+
+/* Append an event of a seat, time NULL for the time of the last event */
+void
+ivi_input_recorder_add(struct ivi_input_recorder *recorder,
+                       struct weston_seat *seat,
+                       enum ivi_input_record_type type,
+                       const struct timespec *time,
+                       int32_t arg0, int32_t arg1, int32_t arg2);
+
+/* Injects the events of a trace into the active grabs of the seats named
+ * like the recorded seats, or of the default seat if there is no such
+ * seat. Events of devices the seat does not have are dropped. */
+struct ivi_input_player;
+
+/* Called when a replay ends, with the number of injected events, and
+ * whether the whole trace was valid */
+typedef void (*ivi_input_replay_done_func)(void *data, uint32_t events,
+                                           bool success);
+
+struct ivi_input_player *
+ivi_input_player_create(struct weston_compositor *compositor,
+                        const char *default_seat);
+
+void
+ivi_input_player_destroy(struct ivi_input_player *player);
+
+/* Replay the trace read from fd, with the recorded timing divided by
+ * speed, or all at once if speed is 0. The events get the time they are
+ * injected at. The trace is read in chunks from the event loop, so done
+ * is called after this returned. The player does not take the fd, which
+ * has to refer to a regular file of at most 16 MiB.
+ *
+ * \return 0 if the replay started, -1 if the trace header is invalid, the
+ *         file is not a regular file or too large, or another replay is
+ *         running
+ */
+int
+ivi_input_player_start(struct ivi_input_player *player, int fd, double speed,
+                       ivi_input_replay_done_func done, void *data);
+
+#endif /* IVI_INPUT_MODULES_IVI_INPUT_CONTROLLER_SRC_IVI_INPUT_REPLAY_H_ */
@@ -0,0 +1,273 @@
+/*
+ * Copyright (C) 2017 Advanced Driver Information Technology Joint Venture GmbH
+ *
+ * Permission to use, copy, modify, distribute, and sell this software and
+ * its documentation for any purpose is hereby granted without fee, provided
+ * that the above copyright notice appear in all copies and that both that
+ * copyright notice and this permission notice appear in supporting
+ * documentation, and that the name of the copyright holders not be used in
+ * advertising or publicity pertaining to distribution of the software
+ * without specific, written prior permission.  The copyright holders make
+ * no representations about the suitability of this software for any
+ * purpose.  It is provided "as is" without express or implied warranty.
+ *
+ * THE COPYRIGHT HOLDERS DISCLAIM ALL WARRANTIES WITH REGARD TO THIS
+ * SOFTWARE, INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND
+ * FITNESS, IN NO EVENT SHALL THE COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * SPECIAL, INDIRECT OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER
+ * RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF
+ * CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+ * CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+
+#include <string.h>
+
+#include "ivi-input-resample.h"
+
+/* Interval of the two latest samples for which they are extrapolated.
+ * Closer samples are too noisy, farther ones are too old. */
+#define MIN_PREDICTION_DELTA_US 2000
+#define MAX_PREDICTION_DELTA_US 20000
+
+void
+ivi_input_resampler_init(struct ivi_input_resampler *resampler)
+{
+    wl_array_init(&resampler->points);
+    resampler->latency_us = IVI_INPUT_RESAMPLE_LATENCY_US;
+    resampler->max_prediction_us = IVI_INPUT_RESAMPLE_MAX_PREDICTION_US;
+}
+
+void
+ivi_input_resampler_release(struct ivi_input_resampler *resampler)
+{
+    wl_array_release(&resampler->points);
+    wl_array_init(&resampler->points);
+}
+
+void
+ivi_input_resampler_clear(struct ivi_input_resampler *resampler)
+{
+    resampler->points.size = 0;
+}
+
+static struct ivi_input_resample_point *
+find_point(struct ivi_input_resampler *resampler, int touch_id)
+{
+    struct ivi_input_resample_point *point;
+
+    wl_array_for_each(point, &resampler->points) {
+        if (point->touch_id == touch_id)
+            return point;
+    }
+    return NULL;
+}
+
+static struct ivi_input_resample_point *
+add_point(struct ivi_input_resampler *resampler, int touch_id)
+{
+    struct ivi_input_resample_point *point;
+
+    point = wl_array_add(&resampler->points, sizeof *point);
+    if (point == NULL)
+        return NULL;
+
+    memset(point, 0, sizeof *point);
+    point->touch_id = touch_id;
+    point->sent_us = INT64_MIN;
+    return point;
+}
+
+static void
+add_sample(struct ivi_input_resample_point *point, int64_t time_us,
+           double x, double y)
+{
+    struct ivi_input_resample_sample *sample;
+
+    if (point->count == IVI_INPUT_RESAMPLE_HISTORY) {
+        memmove(&point->samples[0], &point->samples[1],
+                (IVI_INPUT_RESAMPLE_HISTORY - 1) * sizeof point->samples[0]);
+        point->count--;
+    }
+
+    /* a timestamp out of order would make the interpolation go back */
+    if (point->count > 0 &&
+        time_us < point->samples[point->count - 1].time_us)
+        time_us = point->samples[point->count - 1].time_us;
+
+    sample = &point->samples[point->count++];
+    sample->time_us = time_us;
+    sample->x = x;
+    sample->y = y;
+}
+
+int
+ivi_input_resampler_down(struct ivi_input_resampler *resampler, int touch_id,
+                         int64_t time_us, double x, double y)
+{
+    struct ivi_input_resample_point *point;
+
+    point = find_point(resampler, touch_id);
+    if (point == NULL)
+        point = add_point(resampler, touch_id);
+    if (point == NULL)
+        return -1;
+
+    point->count = 0;
+    add_sample(point, time_us, x, y);
+    point->sent_us = time_us;
+    point->pending = false;
+    return 0;
+}
+
+int
+ivi_input_resampler_motion(struct ivi_input_resampler *resampler,
+                           int touch_id, int64_t time_us, double x, double y)
+{
+    struct ivi_input_resample_point *point;
+    int merged;
+
+    point = find_point(resampler, touch_id);
+    if (point == NULL)
+        point = add_point(resampler, touch_id);
+    if (point == NULL)
+        return -1;
+
+    merged = point->pending ? 1 : 0;
+    add_sample(point, time_us, x, y);
+    point->pending = true;
+    return merged;
+}
+
+void
+ivi_input_resampler_up(struct ivi_input_resampler *resampler, int touch_id)
+{
+    struct ivi_input_resample_point *point;
+    struct ivi_input_resample_point *last;
+
+    point = find_point(resampler, touch_id);
+    if (point == NULL)
+        return;
+
+    last = (struct ivi_input_resample_point *)
+        ((char *)resampler->points.data + resampler->points.size) - 1;
+    if (point != last)
+        *point = *last;
+    resampler->points.size -= sizeof *point;
+}
+
+static void
+interpolate(const struct ivi_input_resample_sample *a,
+            const struct ivi_input_resample_sample *b,
+            int64_t time_us, struct ivi_input_resample_sample *out)
+{
+    double alpha;
+
+    if (b->time_us == a->time_us) {
+        *out = *b;
+    } else {
+        alpha = (double)(time_us - a->time_us) /
+                (double)(b->time_us - a->time_us);
+        out->x = a->x + (b->x - a->x) * alpha;
+        out->y = a->y + (b->y - a->y) * alpha;
+    }
+    out->time_us = time_us;
+}
+
+bool
+ivi_input_resampler_sample(struct ivi_input_resampler *resampler,
+                           struct ivi_input_resample_point *point,
+                           int64_t frame_us,
+                           struct ivi_input_resample_sample *out)
+{
+    const struct ivi_input_resample_sample *latest;
+    const struct ivi_input_resample_sample *previous;
+    int64_t time_us = frame_us - resampler->latency_us;
+    int64_t limit_us;
+    int64_t delta_us;
+    uint32_t i;
+
+    if (point->count == 0)
+        return false;
+
+    latest = &point->samples[point->count - 1];
+    if (!point->pending && point->sent_us >= latest->time_us)
+        return false;
+
+    if (time_us < point->sent_us)
+        time_us = point->sent_us;
+
+    if (time_us >= latest->time_us) {
+        limit_us = latest->time_us;
+        previous = point->count > 1 ? &point->samples[point->count - 2] : NULL;
+        if (previous != NULL) {
+            delta_us = latest->time_us - previous->time_us;
+            if (delta_us >= MIN_PREDICTION_DELTA_US &&
+                delta_us <= MAX_PREDICTION_DELTA_US)
+                limit_us += delta_us / 2 < resampler->max_prediction_us ?
+                            delta_us / 2 : resampler->max_prediction_us;
+        }
+
+        if (time_us > limit_us)
+            time_us = limit_us;
+        if (previous != NULL && time_us > latest->time_us)
+            interpolate(previous, latest, time_us, out);
+        else
+            *out = *latest;
+    } else {
+        for (i = point->count - 1; i > 0; i--) {
+            if (point->samples[i - 1].time_us <= time_us)
+                break;
+        }
+
+        if (i == 0)
+            *out = point->samples[0];
+        else
+            interpolate(&point->samples[i - 1], &point->samples[i],
+                        time_us, out);
+    }
+
+    /* a late sample moves the point, but not back in time */
+    if (out->time_us < point->sent_us)
+        out->time_us = point->sent_us;
+
+    point->sent_us = out->time_us;
+    point->pending = false;
+    return true;
+}
+
+bool
+ivi_input_resampler_settle(struct ivi_input_resample_point *point,
+                           struct ivi_input_resample_sample *out)
+{
+    const struct ivi_input_resample_sample *latest;
+
+    if (point->count == 0)
+        return false;
+
+    latest = &point->samples[point->count - 1];
+    if (!point->pending && point->sent_us >= latest->time_us)
+        return false;
+
+    *out = *latest;
+    if (out->time_us < point->sent_us)
+        out->time_us = point->sent_us;
+
+    point->sent_us = out->time_us;
+    point->pending = false;
+    return true;
+}
+
+bool
+ivi_input_resampler_has_pending(struct ivi_input_resampler *resampler)
+{
+    struct ivi_input_resample_point *point;
+
+    wl_array_for_each(point, &resampler->points) {
+        if (point->count > 0 &&
+            (point->pending ||
+             point->sent_us < point->samples[point->count - 1].time_us))
+            return true;
+    }
+    return false;
+}
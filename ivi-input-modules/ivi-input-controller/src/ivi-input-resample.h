@@ -0,0 +1,123 @@
+/*
+ * Copyright (C) 2017 Advanced Driver Information Technology Joint Venture GmbH
+ *
+ * Permission to use, copy, modify, distribute, and sell this software and
+ * its documentation for any purpose is hereby granted without fee, provided
+ * that the above copyright notice appear in all copies and that both that
+ * copyright notice and this permission notice appear in supporting
+ * documentation, and that the name of the copyright holders not be used in
+ * advertising or publicity pertaining to distribution of the software
+ * without specific, written prior permission.  The copyright holders make
+ * no representations about the suitability of this software for any
+ * purpose.  It is provided "as is" without express or implied warranty.
+ *
+ * THE COPYRIGHT HOLDERS DISCLAIM ALL WARRANTIES WITH REGARD TO THIS
+ * SOFTWARE, INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND
+ * FITNESS, IN NO EVENT SHALL THE COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * SPECIAL, INDIRECT OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER
+ * RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF
+ * CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+ * CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#ifndef IVI_INPUT_MODULES_IVI_INPUT_CONTROLLER_SRC_IVI_INPUT_RESAMPLE_H_
+#define IVI_INPUT_MODULES_IVI_INPUT_CONTROLLER_SRC_IVI_INPUT_RESAMPLE_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <wayland-util.h>
+
+/* Resampling of touch motion to the frames of an output
+ *
+ * Touch samples arrive out of phase with the repaints of an output. The
+ * resampler keeps the latest samples of every touch point, and gives the
+ * position of a point at the frame time minus latency_us: interpolated
+ * between the samples around that time, or extrapolated from the two
+ * latest samples by at most half their interval and max_prediction_us.
+ * Times never go backwards for a point, so a late sample which is older
+ * than a prediction moves the point without going back in time.
+ */
+
+#define IVI_INPUT_RESAMPLE_HISTORY 4
+
+/* defaults of struct ivi_input_resampler */
+#define IVI_INPUT_RESAMPLE_LATENCY_US 5000
+#define IVI_INPUT_RESAMPLE_MAX_PREDICTION_US 8000
+
+struct ivi_input_resample_sample {
+    int64_t time_us;
+    double x, y;
+};
+
+struct ivi_input_resample_point {
+    int touch_id;
+    /* latest samples, the oldest first */
+    struct ivi_input_resample_sample samples[IVI_INPUT_RESAMPLE_HISTORY];
+    uint32_t count;
+    /* time of the last position taken with sample or settle */
+    int64_t sent_us;
+    /* samples were added since the last position was taken */
+    bool pending;
+};
+
+struct ivi_input_resampler {
+    /* struct ivi_input_resample_point of the touch points which are down */
+    struct wl_array points;
+    int64_t latency_us;
+    int64_t max_prediction_us;
+};
+
+void
+ivi_input_resampler_init(struct ivi_input_resampler *resampler);
+
+void
+ivi_input_resampler_release(struct ivi_input_resampler *resampler);
+
+/* Forget all touch points */
+void
+ivi_input_resampler_clear(struct ivi_input_resampler *resampler);
+
+/* Start a touch point at a position which was sent already
+ *
+ * \return 0 on success, -1 if out of memory
+ */
+int
+ivi_input_resampler_down(struct ivi_input_resampler *resampler, int touch_id,
+                         int64_t time_us, double x, double y);
+
+/* Add a motion sample of a touch point
+ *
+ * \return 1 if an earlier sample of the point was not taken yet, 0 if
+ *         not, -1 if out of memory
+ */
+int
+ivi_input_resampler_motion(struct ivi_input_resampler *resampler,
+                           int touch_id, int64_t time_us, double x, double y);
+
+void
+ivi_input_resampler_up(struct ivi_input_resampler *resampler, int touch_id);
+
+/* Position of the point for a frame at frame_us
+ *
+ * \return false if the point did not move since the last position taken
+ */
+bool
+ivi_input_resampler_sample(struct ivi_input_resampler *resampler,
+                           struct ivi_input_resample_point *point,
+                           int64_t frame_us,
+                           struct ivi_input_resample_sample *out);
+
+/* Latest sample of the point, to send before another event of the point
+ *
+ * \return false if the position of the latest sample was taken already
+ */
+bool
+ivi_input_resampler_settle(struct ivi_input_resample_point *point,
+                           struct ivi_input_resample_sample *out);
+
+/* Whether a point has a sample which was not reached yet */
+bool
+ivi_input_resampler_has_pending(struct ivi_input_resampler *resampler);
+
+#endif /* IVI_INPUT_MODULES_IVI_INPUT_CONTROLLER_SRC_IVI_INPUT_RESAMPLE_H_ */
@@ -136,6 +136,41 @@ typedef unsigned int ilmInputDevice;
 #define ILM_INPUT_DEVICE_TOUCH      ((ilmInputDevice) 1 << 2)
 #define ILM_INPUT_DEVICE_ALL        ((ilmInputDevice) ~0)
 
+/**
+ * \brief Number of buckets of the histogram in ilmInputLatencyStatistics
+ * \ingroup ilmControl
+ **/
+#define ILM_INPUT_LATENCY_BUCKETS 16
+
+/**
+ * \brief Typedef for representing the latency of the input events of one
+ * device type of a seat, from the timestamp of an event until the
+ * compositor sends it to a client. buckets[0] counts events sent within
+ * 64 microseconds, buckets[i] events sent within 64 << i microseconds but
+ * not within the limit of buckets[i - 1], and the last bucket all slower
+ * events.
+ * \ingroup ilmControl
+ **/
+struct ilmInputLatencyStatistics
+{
+    t_ilm_uint count;               /*!< events sent to clients */
+    t_ilm_uint meanLatency;         /*!< mean latency in microseconds */
+    t_ilm_uint maxLatency;          /*!< highest latency in microseconds */
+    t_ilm_uint buckets[ILM_INPUT_LATENCY_BUCKETS]; /*!< histogram of the latency */
+};
+
+/**
+ * \brief Typedef for representing a change of the input acceptance of a
+ * surface for one seat
+ * \ingroup ilmControl
+ **/
+struct ilmInputAcceptance
+{
+    t_ilm_surface surfaceId;        /*!< surface accepting the seat */
+    t_ilm_const_string seatName;    /*!< name of the seat */
+    t_ilm_bool accepted;            /*!< ILM_TRUE to accept the seat, ILM_FALSE to stop */
+};
+
 /**
  * \brief Typedef for representing a layer
  * \ingroup ilmClient
@@ -199,6 +234,17 @@ struct ilmSurfaceProperties
     t_ilm_uint frameCounter;                /*!< already rendered frames of surface */
     t_ilm_int  creatorPid;                  /*!< process id of application that created this surface */
     ilmInputDevice focus;                   /*!< bitmask of every type of device that this surface has focus in */
+    t_ilm_float commitRate;                 /*!< commits per second over the recent commits of the surface */
+    t_ilm_uint minCommitInterval;           /*!< shortest interval between two commits in microseconds */
+    t_ilm_uint avgCommitInterval;           /*!< average interval between two commits in microseconds */
+    t_ilm_uint maxCommitInterval;           /*!< longest interval between two commits in microseconds */
+    t_ilm_uint p99CommitInterval;           /*!< 99th percentile of the interval between two commits in microseconds */
+    t_ilm_uint supersededCommits;           /*!< commits replaced by a newer commit before they were presented */
+    t_ilm_uint lastCommitTime;              /*!< time of the last commit in milliseconds of the compositor clock */
+    t_ilm_bool occluded;                    /*!< ILM_TRUE if no part of the surface is shown on any screen */
+    t_ilm_uint frameRateLimit;              /*!< requested limit of frame callbacks per second, 0 if there is none */
+    t_ilm_float enforcedFrameRate;          /*!< frame callbacks per second the compositor completes at most */
+    t_ilm_uint pacedFrames;                 /*!< frame callbacks delayed to keep within frameRateLimit */
 };
 
 /**
@@ -232,6 +278,108 @@ struct ilmScreenProperties
     t_ilm_char connectorName[256];  /*!< name of the connector of the screen */
 };
 
+/**
+ * \brief Number of frame time buckets in ilmScreenStatistics
+ * \ingroup ilmControl
+ **/
+#define ILM_SCREEN_FRAME_TIME_BUCKETS 6
+
+/**
+ * \brief Typedef for representing the repaint statistics of a screen
+ * \ingroup ilmControl
+ **/
+struct ilmScreenStatistics
+{
+    t_ilm_uint frames;              /*!< number of presented frames */
+    t_ilm_uint missedVblanks;       /*!< number of missed vertical blanks */
+    t_ilm_uint presentDelayAvg;     /*!< average time from the submission of a repainted frame to its presentation in microseconds */
+    t_ilm_uint presentDelayMax;     /*!< longest time from the submission of a repainted frame to its presentation in microseconds */
+    t_ilm_uint frameTimeHistogram[ILM_SCREEN_FRAME_TIME_BUCKETS]; /*!< frames with a frame time up to 8, 17, 34, 50, 100 and more than 100 milliseconds */
+};
+
+/**
+ * \brief Typedef for representing the statistics of the requests of a client
+ * \ingroup ilmControl
+ **/
+struct ilmRequestStatistics
+{
+    t_ilm_uint skippedRequests;     /*!< property requests dropped, because they set the committed value */
+    t_ilm_uint commits;             /*!< commits which applied changes of controllers */
+    t_ilm_uint skippedCommits;      /*!< commits without changes of controllers, still forwarded */
+};
+
+/**
+ * \brief Number of request opcodes counted in ilmClientStatistics
+ * \ingroup ilmControl
+ **/
+#define ILM_CLIENT_REQUEST_OPCODES 32
+
+/**
+ * \brief Typedef for representing the requests and events of a client
+ * \ingroup ilmControl
+ **/
+struct ilmClientStatistics
+{
+    t_ilm_uint requests[ILM_CLIENT_REQUEST_OPCODES]; /*!< requests received by the compositor, indexed by ivi_wm request opcode */
+    t_ilm_uint events;              /*!< events sent by the compositor */
+    t_ilm_uint eventBytes;          /*!< size of the events sent by the compositor in bytes */
+    t_ilm_uint commitRate;          /*!< commits applied in the last full second */
+    t_ilm_uint deferredCommits;     /*!< commits deferred to the next second, because they exceeded the commit budget */
+    t_ilm_uint coalescedCommits;    /*!< commits applied together with a deferred commit */
+};
+
+/**
+ * \brief Typedef for representing a screen in a scene snapshot
+ * \ingroup ilmControl
+ **/
+struct ilmSceneScreen
+{
+    t_ilm_uint screenId;            /*!< id of the screen */
+    t_ilm_uint screenWidth;         /*!< width value of screen in pixels */
+    t_ilm_uint screenHeight;        /*!< height value of screen in pixels */
+    t_ilm_uint layerCount;          /*!< number of layers displayed on the screen */
+    t_ilm_layer* layerIds;          /*!< render order of the screen, bottom first */
+};
+
+/**
+ * \brief Typedef for representing a layer in a scene snapshot
+ * \ingroup ilmControl
+ **/
+struct ilmSceneLayer
+{
+    t_ilm_layer layerId;            /*!< id of the layer */
+    struct ilmLayerProperties prop; /*!< properties of the layer */
+    t_ilm_uint surfaceCount;        /*!< number of surfaces on the layer */
+    t_ilm_surface* surfaceIds;      /*!< render order of the layer, bottom first */
+};
+
+/**
+ * \brief Typedef for representing a surface in a scene snapshot
+ * \ingroup ilmControl
+ **/
+struct ilmSceneSurface
+{
+    t_ilm_surface surfaceId;          /*!< id of the surface */
+    struct ilmSurfaceProperties prop; /*!< geometry, opacity, visibility, frameCounter, creatorPid and occluded of the surface */
+};
+
+/**
+ * \brief Typedef for representing a consistent snapshot of the whole scene
+ * \ingroup ilmControl
+ **/
+struct ilmSceneSnapshot
+{
+    t_ilm_uint generation;          /*!< incremented by the compositor for every snapshot */
+    t_ilm_bool truncated;           /*!< ILM_TRUE if the scene did not fit into the shared memory */
+    t_ilm_uint screenCount;         /*!< number of screens */
+    struct ilmSceneScreen* screens; /*!< array of screens */
+    t_ilm_uint layerCount;          /*!< number of layers */
+    struct ilmSceneLayer* layers;   /*!< array of layers */
+    t_ilm_uint surfaceCount;        /*!< number of surfaces */
+    struct ilmSceneSurface* surfaces; /*!< array of surfaces */
+    t_ilm_uint* ids;                /*!< storage of the render orders */
+};
+
 /**
  * enum representing the possible flags for changed properties in notification callbacks.
  */
@@ -316,4 +464,39 @@ typedef ilmErrorTypes(*screenshotDoneNotificationFunc)(void *user_data,
 typedef void(*screenshotErrorNotificationFunc)(void *user_data,
                                         t_ilm_uint error,
                                         const char *message);
+
+/**
+ * position of a surface thumbnail in the image of ilm_takeAsyncSurfacesThumbnail
+ */
+struct ilmThumbnail
+{
+    t_ilm_surface surfaceId;        /*!< id of the surface */
+    t_ilm_uint x;                   /*!< horizontal position in the image */
+    t_ilm_uint y;                   /*!< vertical position in the image */
+    t_ilm_uint width;               /*!< width of the thumbnail, 0 if the surface could not be captured */
+    t_ilm_uint height;              /*!< height of the thumbnail, 0 if the surface could not be captured */
+};
+
+/**
+ * Typedef for notification callback on surfaces thumbnail done event
+ * @param user_data the use data, be passed when call the thumbnail api
+ * @param fd fd for file containing image data, don't close it in callback,
+ * it will be closed and shouldn't be accessed any longer after the callback execution.
+ * @param width image width in pixels
+ * @param height image height in pixels
+ * @param stride number of bytes per pixel row
+ * @param format image format of type wl_shm.format
+ * @param count number of entries in thumbnails
+ * @param thumbnails position of each thumbnail in the image, in request order
+ * @param timestamp timestamp in milliseconds
+ */
+typedef ilmErrorTypes(*thumbnailDoneNotificationFunc)(void *user_data,
+                                        t_ilm_int fd,
+                                        t_ilm_uint width,
+                                        t_ilm_uint height,
+                                        t_ilm_uint stride,
+                                        t_ilm_uint format,
+                                        t_ilm_uint count,
+                                        const struct ilmThumbnail *thumbnails,
+                                        t_ilm_uint timestamp);
 #endif /* _ILM_TYPES_H_*/
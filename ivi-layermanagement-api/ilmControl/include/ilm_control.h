@@ -56,6 +56,59 @@ ilmErrorTypes ilm_getPropertiesOfLayer(t_ilm_uint layerID, struct ilmLayerProper
  */
 ilmErrorTypes ilm_getPropertiesOfScreen(t_ilm_display screenID, struct ilmScreenProperties* pScreenProperties);
 
+/**
+ * \brief Get the repaint timing statistics of a screen
+ * \ingroup ilmControl
+ * \param[in] screenID screen Indentifier
+ * \param[out] pStatistics pointer where the screen statistics should be stored
+ * \return ILM_SUCCESS if the method call was successful
+ * \return ILM_ERROR_NOT_IMPLEMENTED if the compositor does not support screen statistics
+ * \return ILM_FAILED if the client can not get the statistics.
+ */
+ilmErrorTypes ilm_getScreenStatistics(t_ilm_uint screenID, struct ilmScreenStatistics* pStatistics);
+
+/**
+ * \brief Get the statistics of the requests of this client
+ * The compositor drops requests which set a property to its committed
+ * value, and counts commits without any change of a controller apart.
+ * \ingroup ilmControl
+ * \param[out] pStatistics pointer where the request statistics should be stored
+ * \return ILM_SUCCESS if the method call was successful
+ * \return ILM_ERROR_NOT_IMPLEMENTED if the compositor does not support request statistics
+ * \return ILM_FAILED if the client can not get the statistics.
+ */
+ilmErrorTypes ilm_getRequestStatistics(struct ilmRequestStatistics* pStatistics);
+
+/**
+ * \brief Get the counters of the requests and events of this client
+ * \ingroup ilmControl
+ * \param[out] pStatistics pointer where the client statistics should be stored
+ * \return ILM_SUCCESS if the method call was successful
+ * \return ILM_ERROR_NOT_IMPLEMENTED if the compositor does not support client statistics
+ * \return ILM_FAILED if the client can not get the statistics.
+ */
+ilmErrorTypes ilm_getClientStatistics(struct ilmClientStatistics* pStatistics);
+
+/**
+ * \brief Get a consistent snapshot of all screens, layers and surfaces
+ * The first call maps the scene the compositor keeps in shared memory,
+ * later calls read it without any request to the compositor.
+ * \ingroup ilmControl
+ * \param[out] pSnapshot pointer where the snapshot should be stored,
+ *             to be released with ilm_freeSceneSnapshot
+ * \return ILM_SUCCESS if the method call was successful
+ * \return ILM_ERROR_NOT_IMPLEMENTED if the compositor does not export the scene
+ * \return ILM_FAILED if the client can not get the snapshot.
+ */
+ilmErrorTypes ilm_getSceneSnapshot(struct ilmSceneSnapshot* pSnapshot);
+
+/**
+ * \brief Release the arrays of a snapshot returned by ilm_getSceneSnapshot
+ * \ingroup ilmControl
+ * \param[in] pSnapshot pointer to the snapshot
+ */
+void ilm_freeSceneSnapshot(struct ilmSceneSnapshot* pSnapshot);
+
 /**
  * \brief Get the screen Ids
  * \ingroup ilmControl
@@ -343,6 +396,23 @@ ilmErrorTypes ilm_surfaceSetDestinationRectangle(t_ilm_surface surfaceId, t_ilm_
  */
 ilmErrorTypes ilm_surfaceSetType(t_ilm_surface surfaceId, ilmSurfaceType type);
 
+/**
+ * \brief Limit the frame rate of a surface
+ * The compositor completes the frame callbacks of the surface at most
+ * frameRate times per second, which paces applications drawing a frame
+ * per frame callback. The limit replaces a limit configured for the
+ * application and takes effect without ilm_commitChanges.
+ * The limit and the rate enforced by the compositor are reported in
+ * ilmSurfaceProperties.
+ * \ingroup ilmControl
+ * \param[in] surfaceId Id of the surface to limit
+ * \param[in] frameRate frame callbacks per second, 0 removes the limit
+ * \return ILM_SUCCESS if the method call was successful
+ * \return ILM_FAILED if the client can not call the method on the service.
+ * \return ILM_ERROR_NOT_IMPLEMENTED if the compositor does not support limits
+ */
+ilmErrorTypes ilm_surfaceSetFrameRateLimit(t_ilm_surface surfaceId, t_ilm_uint frameRate);
+
 /**
  * \brief Sets render order of layers on a display
  * \ingroup ilmControl
@@ -411,6 +481,81 @@ ilmErrorTypes ilm_takeAsyncSurfaceScreenshot(t_ilm_surface surfaceid,
 						screenshotErrorNotificationFunc callback_error,
 						void *user_data);
 
+/**
+ * \brief Set the pixel format of the following surface and layer screenshots
+ * The compositor converts the pixels while copying them, so smaller
+ * formats reduce the data written to the screenshot buffer and files.
+ * Screen screenshots and thumbnails are not affected.
+ * \ingroup ilmControl
+ * \param[in] pixelFormat one of ILM_PIXELFORMAT_RGBA_8888 (default),
+ *            ILM_PIXELFORMAT_RGB_888, ILM_PIXELFORMAT_RGB_565 or
+ *            ILM_PIXELFORMAT_R_8 (luminance)
+ * \return ILM_SUCCESS if the method call was successful
+ * \return ILM_FAILED if the client can not call the method on the service.
+ * \return ILM_ERROR_INVALID_ARGUMENTS if the format is not supported
+ * \return ILM_ERROR_NOT_IMPLEMENTED if the compositor does not support the conversion
+ */
+ilmErrorTypes ilm_setScreenshotPixelFormat(ilmPixelFormat pixelFormat);
+
+/**
+ * \brief Take a screenshot of a certain layer composited on its own
+ * The visible surfaces of the layer are composited in software, without
+ * any other layer. The screenshot is saved as bmp file with the
+ * corresponding filename.
+ * \ingroup ilmControl
+ * \param[in] filename Location where the screenshot should be stored
+ * \param[in] layerid Identifier of the layer to take the screenshot of
+ * \return ILM_SUCCESS if the method call was successful
+ * \return ILM_FAILED if the client can not call the method on the service.
+ * \return ILM_ERROR_NOT_IMPLEMENTED if the compositor does not support layer screenshots
+ */
+ilmErrorTypes ilm_takeLayerScreenshot(t_ilm_const_string filename, t_ilm_layer layerid);
+
+/**
+ * \brief Take a screenshot of a certain layer with non-blocking.
+ * The function allows to setup callbacks when capturing a layer,
+ * It helps to avoid a blocking, user can handle screenshot data or error in
+ * the callbacks.
+ * \ingroup ilmControl
+ * \param[in] layerid Identifier of the layer to take the screenshot of
+ * \param[in] callback_done callback called when screenshot is acquired
+ * \param[in] callback_error callback called when screenshot acqusition failed
+ * \param[in] user_data callback user data passed in by called
+ * \return ILM_SUCCESS if the method call was successful
+ * \return ILM_FAILED if the client can not call the method on the service.
+ * \return ILM_ERROR_NOT_IMPLEMENTED if the compositor does not support layer screenshots
+ */
+ilmErrorTypes ilm_takeAsyncLayerScreenshot(t_ilm_layer layerid,
+						screenshotDoneNotificationFunc callback_done,
+						screenshotErrorNotificationFunc callback_error,
+						void *user_data);
+
+/**
+ * \brief Take downscaled screenshots of several surfaces with non-blocking.
+ * The compositor packs a thumbnail of each surface into one image, made of
+ * cells of thumbWidth x thumbHeight pixels. Each surface is downscaled to
+ * fit into its cell keeping its aspect ratio.
+ * \ingroup ilmControl
+ * \param[in] number number of surface ids in the given array
+ * \param[in] pSurfaceId array of surface ids
+ * \param[in] thumbWidth width of a thumbnail cell in pixels
+ * \param[in] thumbHeight height of a thumbnail cell in pixels
+ * \param[in] callback_done callback called when the thumbnails are acquired
+ * \param[in] callback_error callback called when thumbnail acquisition failed
+ * \param[in] user_data callback user data passed in by called
+ * \return ILM_SUCCESS if the method call was successful
+ * \return ILM_FAILED if the client can not call the method on the service.
+ * \return ILM_ERROR_INVALID_ARGUMENTS if an argument is not valid
+ * \return ILM_ERROR_NOT_IMPLEMENTED if the compositor does not support thumbnails
+ */
+ilmErrorTypes ilm_takeAsyncSurfacesThumbnail(t_ilm_uint number,
+						const t_ilm_surface *pSurfaceId,
+						t_ilm_uint thumbWidth,
+						t_ilm_uint thumbHeight,
+						thumbnailDoneNotificationFunc callback_done,
+						screenshotErrorNotificationFunc callback_error,
+						void *user_data);
+
 /**
  * \brief register for notification on property changes of layer
  * \ingroup ilmControl
@@ -46,9 +46,22 @@ struct wayland_context {
     ilmErrorTypes error_flag;
 
     struct ivi_input *input_controller;
+    /* result of the last ivi_input.replay_input */
+    bool replay_done;
+    int32_t replay_success;
+    uint32_t replay_events;
 
     struct wl_shm *wl_shm;
     bool has_argb8888;
+    /* wl_shm format of surface and layer screenshots */
+    uint32_t screenshot_format;
+
+    struct ilmRequestStatistics request_stats;
+    struct ilmClientStatistics client_stats;
+
+    /* scene exported by the compositor, mapped read-only */
+    struct ivi_scene_export_header *scene_export;
+    uint32_t scene_export_size;
 };
 
 struct ilm_control_context {
@@ -66,16 +79,19 @@ struct ilm_control_context {
     void *notification_user_data;
 };
 
+/* seat_context::id before the compositor sent it */
+#define SEAT_ID_INVALID UINT32_MAX
+
 struct seat_context {
     struct wl_list link;
     char *seat_name;
+    /* id from ivi_input.seat_id, assigned by the client for compositors
+     * without seat ids */
+    uint32_t id;
     bool is_default;
     ilmInputDevice capabilities;
-};
-
-struct accepted_seat {
-    struct wl_list link;
-    char *seat_name;
+    /* indexed by the bit of the ILM_INPUT_DEVICE_* */
+    struct ilmInputLatencyStatistics latency[3];
 };
 
 struct surface_context {
@@ -83,12 +99,50 @@ struct surface_context {
 
     t_ilm_uint id_surface;
     struct ilmSurfaceProperties prop;
-    struct wl_list list_accepted_seats;
+    /* ids of the accepted seats, see seat_mask_test() */
+    struct wl_array accepted_seats;
     surfaceNotificationFunc notification;
 
     struct wayland_context *ctx;
 };
 
+/* Sets of seat ids, as bits of uint32_t words */
+static inline bool
+seat_mask_test(const struct wl_array *mask, uint32_t id)
+{
+    const uint32_t *words = (const uint32_t *)mask->data;
+
+    if (id / 32 >= mask->size / sizeof *words)
+        return false;
+    return (words[id / 32] & (1u << (id % 32))) != 0;
+}
+
+static inline int
+seat_mask_set(struct wl_array *mask, uint32_t id)
+{
+    uint32_t *words;
+
+    while (id / 32 >= mask->size / sizeof *words) {
+        words = (uint32_t *)wl_array_add(mask, sizeof *words);
+        if (words == NULL)
+            return -1;
+        *words = 0;
+    }
+
+    words = (uint32_t *)mask->data;
+    words[id / 32] |= 1u << (id % 32);
+    return 0;
+}
+
+static inline void
+seat_mask_clear(struct wl_array *mask, uint32_t id)
+{
+    uint32_t *words = (uint32_t *)mask->data;
+
+    if (id / 32 < mask->size / sizeof *words)
+        words[id / 32] &= ~(1u << (id % 32));
+}
+
 ilmErrorTypes impl_sync_and_acquire_instance(struct ilm_control_context *ctx);
 
 void release_instance(void);
@@ -73,6 +73,35 @@ create_info_header(struct BITMAPINFOHEADER *info_header, int32_t image_size, int
     info_header->biSizeImage = htole32(image_size);
 }
 
+/* Store a pixel of an image with packed rows as B, G, R */
+static void
+unpack_pixel_bgr(const char *buffer, uint32_t format, int32_t offset,
+                 char *bgr)
+{
+    const uint8_t *p;
+    uint16_t pixel;
+
+    switch (format) {
+    case WL_SHM_FORMAT_RGB888:
+        p = (const uint8_t *)buffer + offset * 3;
+        bgr[0] = p[0];
+        bgr[1] = p[1];
+        bgr[2] = p[2];
+        break;
+    case WL_SHM_FORMAT_RGB565:
+        p = (const uint8_t *)buffer + offset * 2;
+        pixel = p[0] | (p[1] << 8);
+        bgr[0] = ((pixel & 0x1f) << 3) | ((pixel & 0x1f) >> 2);
+        bgr[1] = (((pixel >> 5) & 0x3f) << 2) | (((pixel >> 5) & 0x3f) >> 4);
+        bgr[2] = ((pixel >> 11) << 3) | ((pixel >> 11) >> 2);
+        break;
+    case WL_SHM_FORMAT_R8:
+        p = (const uint8_t *)buffer + offset;
+        bgr[0] = bgr[1] = bgr[2] = p[0];
+        break;
+    }
+}
+
 static int
 write_bitmap(const char *filename,
              const struct BITMAPFILEHEADER *file_header,
@@ -109,8 +138,9 @@ save_as_bitmap(const char *filename,
     int32_t i = 0;
     int32_t j = 0;
     int bytes_per_pixel;
-    bool flip_order;
+    bool flip_order = false;
     bool has_alpha;
+    bool packed = false;
 
     if ((filename == NULL) || (buffer == NULL)) {
         return -1;
@@ -133,6 +163,13 @@ save_as_bitmap(const char *filename,
         flip_order = false;
         has_alpha = false;
         break;
+    case WL_SHM_FORMAT_RGB888:
+    case WL_SHM_FORMAT_RGB565:
+    case WL_SHM_FORMAT_R8:
+        /* written as 24 bit bitmap */
+        packed = true;
+        has_alpha = false;
+        break;
     default:
         fprintf(stderr, "unsupported pixelformat 0x%x\n", format);
         return -1;
@@ -153,6 +190,11 @@ save_as_bitmap(const char *filename,
     for (row = 0; row < height; ++row) {
         for (col = 0; col < width; ++col) {
             offset = (height - row - 1) * width + col;
+            if (packed) {
+                unpack_pixel_bgr(buffer, format, offset,
+                                 &image_buffer[row * image_stride + col * 3]);
+                continue;
+            }
             uint32_t pixel = htonl(((uint32_t*)buffer)[offset]);
             char * pixel_p = (char*) &pixel;
             image_offset = row * image_stride + col * bytes_per_pixel;
@@ -37,6 +37,7 @@
 #include "wayland-util.h"
 #include "ivi-wm-client-protocol.h"
 #include "ivi-input-client-protocol.h"
+#include "ivi-scene-export.h"
 
 struct layer_context {
     struct wl_list link;
@@ -61,6 +62,7 @@ struct screen_context {
     int32_t transform;
 
     struct ilmScreenProperties prop;
+    struct ilmScreenStatistics stats;
 
     struct wl_array render_order;
 
@@ -71,6 +73,7 @@ struct ivi_buffer {
     struct wl_buffer *wl_buffer;
     uint32_t width;
     uint32_t height;
+    uint32_t stride;
     uint32_t format;
     size_t size;
     int fd;
@@ -84,6 +87,9 @@ struct screenshot_context {
     screenshotDoneNotificationFunc callback_done;
     screenshotErrorNotificationFunc callback_error;
     void *callback_priv;
+    /* surfaces thumbnail only */
+    thumbnailDoneNotificationFunc callback_thumbnail;
+    struct wl_array thumbnails;
 };
 
 static inline void lock_context(struct ilm_control_context *ctx)
@@ -562,6 +568,29 @@ wm_listener_surface_stats(void *data, struct ivi_wm *controller,
     ctx_surf->prop.creatorPid = (t_ilm_uint)pid;
 }
 
+static void
+wm_listener_surface_frame_stats(void *data, struct ivi_wm *controller,
+                                uint32_t surface_id, wl_fixed_t commit_rate,
+                                uint32_t interval_min, uint32_t interval_avg,
+                                uint32_t interval_max, uint32_t interval_p99,
+                                uint32_t superseded, uint32_t last_commit_time)
+{
+    struct wayland_context *ctx = data;
+    struct surface_context *ctx_surf;
+
+    ctx_surf = get_surface_context(ctx, surface_id);
+    if(!ctx_surf)
+        return;
+
+    ctx_surf->prop.commitRate = (t_ilm_float)wl_fixed_to_double(commit_rate);
+    ctx_surf->prop.minCommitInterval = (t_ilm_uint)interval_min;
+    ctx_surf->prop.avgCommitInterval = (t_ilm_uint)interval_avg;
+    ctx_surf->prop.maxCommitInterval = (t_ilm_uint)interval_max;
+    ctx_surf->prop.p99CommitInterval = (t_ilm_uint)interval_p99;
+    ctx_surf->prop.supersededCommits = (t_ilm_uint)superseded;
+    ctx_surf->prop.lastCommitTime = (t_ilm_uint)last_commit_time;
+}
+
 static void
 wm_listener_surface_created(void *data, struct ivi_wm *controller,
                             uint32_t surface_id)
@@ -583,7 +612,7 @@ wm_listener_surface_created(void *data, struct ivi_wm *controller,
     ctx_surf->ctx = ctx;
 
     wl_list_insert(&ctx->list_surface, &ctx_surf->link);
-    wl_list_init(&ctx_surf->list_accepted_seats);
+    wl_array_init(&ctx_surf->accepted_seats);
 
     if (ctx->notification != NULL) {
         ilmObjectType surface = ILM_SURFACE;
@@ -598,7 +627,6 @@ wm_listener_surface_destroyed(void *data, struct ivi_wm *controller,
 {
     struct wayland_context *ctx = data;
     struct surface_context *ctx_surf;
-    struct accepted_seat *seat, *seat_next;
 
     ctx_surf = get_surface_context(ctx, surface_id);
     if(!ctx_surf)
@@ -616,12 +644,7 @@ wm_listener_surface_destroyed(void *data, struct ivi_wm *controller,
                                     ctx_surf->ctx->notification_user_data);
     }
 
-    wl_list_for_each_safe(seat, seat_next, &ctx_surf->list_accepted_seats, link) {
-        wl_list_remove(&seat->link);
-        free(seat->seat_name);
-        free(seat);
-    }
-
+    wl_array_release(&ctx_surf->accepted_seats);
     wl_list_remove(&ctx_surf->link);
     free(ctx_surf);
 }
@@ -659,6 +682,112 @@ wm_listener_surface_error(void *data, struct ivi_wm *controller,
         ctx->error_flag = error_code;
 }
 
+static void
+wm_listener_surface_occlusion(void *data, struct ivi_wm *controller,
+                              uint32_t surface_id, uint32_t occluded)
+{
+    struct wayland_context *ctx = data;
+    struct surface_context *ctx_surf;
+
+    ctx_surf = get_surface_context(ctx, surface_id);
+    if(!ctx_surf)
+        return;
+
+    ctx_surf->prop.occluded = occluded ? ILM_TRUE : ILM_FALSE;
+}
+
+static void
+wm_listener_surface_frame_rate(void *data, struct ivi_wm *controller,
+                               uint32_t surface_id, uint32_t requested,
+                               wl_fixed_t enforced, uint32_t paced)
+{
+    struct wayland_context *ctx = data;
+    struct surface_context *ctx_surf;
+
+    ctx_surf = get_surface_context(ctx, surface_id);
+    if(!ctx_surf)
+        return;
+
+    ctx_surf->prop.frameRateLimit = (t_ilm_uint)requested;
+    ctx_surf->prop.enforcedFrameRate = (t_ilm_float)wl_fixed_to_double(enforced);
+    ctx_surf->prop.pacedFrames = (t_ilm_uint)paced;
+}
+
+static void
+wm_listener_request_stats(void *data, struct ivi_wm *controller,
+                          uint32_t skipped_requests, uint32_t commits,
+                          uint32_t skipped_commits)
+{
+    struct wayland_context *ctx = data;
+
+    ctx->request_stats.skippedRequests = (t_ilm_uint)skipped_requests;
+    ctx->request_stats.commits = (t_ilm_uint)commits;
+    ctx->request_stats.skippedCommits = (t_ilm_uint)skipped_commits;
+}
+
+static void
+wm_listener_scene_export(void *data, struct ivi_wm *controller,
+                         int32_t fd, uint32_t size)
+{
+    struct wayland_context *ctx = data;
+    struct ivi_scene_export_header *header;
+
+    header = mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (header == MAP_FAILED) {
+        fprintf(stderr, "failed to map the scene export\n");
+        return;
+    }
+
+    if (size < sizeof *header ||
+        header->magic != IVI_SCENE_EXPORT_MAGIC ||
+        header->version != IVI_SCENE_EXPORT_VERSION ||
+        header->buffer_offset + 2 * (uint64_t)header->buffer_size > size) {
+        fprintf(stderr, "invalid scene export\n");
+        munmap(header, size);
+        return;
+    }
+
+    if (ctx->scene_export)
+        munmap(ctx->scene_export, ctx->scene_export_size);
+
+    ctx->scene_export = header;
+    ctx->scene_export_size = size;
+}
+
+static void
+wm_listener_client_stats(void *data, struct ivi_wm *controller,
+                         struct wl_array *requests, uint32_t events,
+                         uint32_t event_bytes, uint32_t commit_rate,
+                         uint32_t deferred_commits, uint32_t coalesced_commits)
+{
+    struct wayland_context *ctx = data;
+    uint32_t *count;
+    int i = 0;
+
+    memset(&ctx->client_stats, 0, sizeof ctx->client_stats);
+    wl_array_for_each(count, requests) {
+        if (i == ILM_CLIENT_REQUEST_OPCODES)
+            break;
+        ctx->client_stats.requests[i++] = (t_ilm_uint)*count;
+    }
+
+    ctx->client_stats.events = (t_ilm_uint)events;
+    ctx->client_stats.eventBytes = (t_ilm_uint)event_bytes;
+    ctx->client_stats.commitRate = (t_ilm_uint)commit_rate;
+    ctx->client_stats.deferredCommits = (t_ilm_uint)deferred_commits;
+    ctx->client_stats.coalescedCommits = (t_ilm_uint)coalesced_commits;
+}
+
+static void
+wm_listener_initial_state_done(void *data, struct ivi_wm *controller)
+{
+    /* Every object and its properties of the initial state have already
+     * been stored by the other listeners, nothing is left to do. */
+    (void)data;
+    (void)controller;
+}
+
 static struct ivi_wm_listener wm_listener=
 {
     wm_listener_surface_visibility,
@@ -678,6 +807,13 @@ static struct ivi_wm_listener wm_listener=
     wm_listener_surface_size,
     wm_listener_surface_stats,
     wm_listener_layer_surface_added,
+    wm_listener_surface_frame_stats,
+    wm_listener_initial_state_done,
+    wm_listener_surface_occlusion,
+    wm_listener_surface_frame_rate,
+    wm_listener_request_stats,
+    wm_listener_scene_export,
+    wm_listener_client_stats,
 };
 
 static void
@@ -745,12 +881,37 @@ wm_screen_listener_error(void *data, struct ivi_wm_screen *controller,
         ctx_screen->ctx->error_flag = error_code;
 }
 
+static void
+wm_screen_listener_stats(void *data, struct ivi_wm_screen *controller,
+                         uint32_t frames, uint32_t missed_vblanks,
+                         uint32_t present_delay_avg, uint32_t present_delay_max,
+                         struct wl_array *frame_time_histogram)
+{
+    struct screen_context *ctx_screen = data;
+    uint32_t *count;
+    t_ilm_uint i = 0;
+
+    ctx_screen->stats.frames = frames;
+    ctx_screen->stats.missedVblanks = missed_vblanks;
+    ctx_screen->stats.presentDelayAvg = present_delay_avg;
+    ctx_screen->stats.presentDelayMax = present_delay_max;
+
+    memset(ctx_screen->stats.frameTimeHistogram, 0,
+           sizeof ctx_screen->stats.frameTimeHistogram);
+    wl_array_for_each(count, frame_time_histogram) {
+        if (i >= ILM_SCREEN_FRAME_TIME_BUCKETS)
+            break;
+        ctx_screen->stats.frameTimeHistogram[i++] = *count;
+    }
+}
+
 static struct ivi_wm_screen_listener wm_screen_listener=
 {
     wm_screen_listener_screen_id,
     wm_screen_listener_layer_added,
     wm_screen_listener_connector_name,
-    wm_screen_listener_error
+    wm_screen_listener_error,
+    wm_screen_listener_stats
 };
 
 static struct seat_context *
@@ -764,6 +925,19 @@ find_seat(struct wl_list *list, const char *name)
     return NULL;
 }
 
+static struct seat_context *
+find_seat_by_id(struct wl_list *list, uint32_t id)
+{
+    struct seat_context *seat;
+    if (id == SEAT_ID_INVALID)
+        return NULL;
+    wl_list_for_each(seat, list, link) {
+        if (seat->id == id)
+            return seat;
+    }
+    return NULL;
+}
+
 static void
 input_listener_seat_created(void *data,
                             struct ivi_input *ivi_input,
@@ -787,9 +961,50 @@ input_listener_seat_created(void *data,
     seat->seat_name = strdup(name);
     seat->capabilities = capabilities;
     seat->is_default = (is_default == ILM_TRUE) ? true : false;
+    seat->id = SEAT_ID_INVALID;
+
+    /* the lowest id not used by another seat, as the compositor would */
+    if (ivi_input_get_version(ivi_input) < IVI_INPUT_SEAT_ID_SINCE_VERSION) {
+        struct seat_context *other;
+        bool used;
+
+        seat->id = 0;
+        do {
+            used = false;
+            wl_list_for_each(other, &ctx->list_seat, link) {
+                if (other->id == seat->id) {
+                    used = true;
+                    seat->id++;
+                    break;
+                }
+            }
+        } while (used);
+    }
+
     wl_list_insert(&ctx->list_seat, &seat->link);
 }
 
+static void
+input_listener_seat_id(void *data,
+                       struct ivi_input *ivi_input,
+                       const char *name,
+                       uint32_t id)
+{
+    struct wayland_context *ctx = data;
+    struct seat_context *seat = find_seat(&ctx->list_seat, name);
+
+    if (seat == NULL || seat->id != SEAT_ID_INVALID) {
+        fprintf(stderr, "Warning: unexpected id for seat %s\n", name);
+        return;
+    }
+    /* ids are the lowest free numbers, bit sets do not grow large */
+    if (id > UINT16_MAX) {
+        fprintf(stderr, "Warning: id %u of seat %s is too large\n", id, name);
+        return;
+    }
+    seat->id = id;
+}
+
 static void
 input_listener_seat_capabilities(void *data,
                                  struct ivi_input *ivi_input,
@@ -812,10 +1027,17 @@ input_listener_seat_destroyed(void *data,
 {
     struct wayland_context *ctx = data;
     struct seat_context *seat = find_seat(&ctx->list_seat, name);
+    struct surface_context *surface_ctx;
     if (seat == NULL) {
         fprintf(stderr, "Warning: Cannot find seat %s to delete it\n", name);
         return;
     }
+    /* the compositor drops the acceptance of the seat silently, and may
+     * give its id to another seat */
+    if (seat->id != SEAT_ID_INVALID) {
+        wl_list_for_each(surface_ctx, &ctx->list_surface, link)
+            seat_mask_clear(&surface_ctx->accepted_seats, seat->id);
+    }
     free(seat->seat_name);
     wl_list_remove(&seat->link);
     free(seat);
@@ -840,17 +1062,12 @@ input_listener_input_focus(void *data,
 }
 
 static void
-input_listener_input_acceptance(void *data,
-                                struct ivi_input *ivi_input,
-                                uint32_t surface,
-                                const char *seat,
-                                int32_t accepted)
+set_input_acceptance(struct wayland_context *ctx, uint32_t surface,
+                     struct seat_context *seat_ctx, int32_t accepted)
 {
-    struct accepted_seat *accepted_seat, *next;
-    struct wayland_context *ctx = data;
     struct surface_context *surface_ctx = NULL;
     int surface_found = 0;
-    int accepted_seat_found = 0;
+    bool accepted_seat_found;
 
     wl_list_for_each(surface_ctx, &ctx->list_surface, link) {
         if (surface_ctx->id_surface == surface) {
@@ -865,39 +1082,131 @@ input_listener_input_acceptance(void *data,
         return;
     }
 
-    wl_list_for_each_safe(accepted_seat, next,
-                          &surface_ctx->list_accepted_seats, link) {
-        if (strcmp(accepted_seat->seat_name, seat) != 0)
-            continue;
-
-        if (accepted != ILM_TRUE) {
-            /* Remove this from the accepted seats */
-            free(accepted_seat->seat_name);
-            wl_list_remove(&accepted_seat->link);
-            free(accepted_seat);
-            return;
-        }
-        accepted_seat_found = 1;
-    }
+    accepted_seat_found = seat_mask_test(&surface_ctx->accepted_seats,
+                                         seat_ctx->id);
 
     if (accepted_seat_found && accepted == ILM_TRUE) {
         fprintf(stderr, "Warning: input acceptance event trying to add seat "
-                "%s, that is already in surface %d\n", seat, surface);
+                "%s, that is already in surface %d\n", seat_ctx->seat_name,
+                surface);
         return;
     }
     if (!accepted_seat_found && accepted != ILM_TRUE) {
         fprintf(stderr, "Warning: input acceptance event trying to remove "
-                "seat %s, that is not in surface %d\n", seat, surface);
+                "seat %s, that is not in surface %d\n", seat_ctx->seat_name,
+                surface);
         return;
     }
 
-    accepted_seat = calloc(1, sizeof(*accepted_seat));
-    if (accepted_seat == NULL) {
+    if (accepted != ILM_TRUE) {
+        seat_mask_clear(&surface_ctx->accepted_seats, seat_ctx->id);
+        return;
+    }
+
+    if (seat_mask_set(&surface_ctx->accepted_seats, seat_ctx->id) < 0)
         fprintf(stderr, "Failed to allocate memory for accepted seat\n");
+}
+
+static void
+input_listener_input_acceptance(void *data,
+                                struct ivi_input *ivi_input,
+                                uint32_t surface,
+                                const char *seat,
+                                int32_t accepted)
+{
+    struct wayland_context *ctx = data;
+    struct seat_context *seat_ctx = find_seat(&ctx->list_seat, seat);
+
+    if (seat_ctx == NULL || seat_ctx->id == SEAT_ID_INVALID) {
+        fprintf(stderr, "Warning: input acceptance event received for "
+                "unknown seat %s\n", seat);
         return;
     }
-    accepted_seat->seat_name = strdup(seat);
-    wl_list_insert(&surface_ctx->list_accepted_seats, &accepted_seat->link);
+
+    set_input_acceptance(ctx, surface, seat_ctx, accepted);
+}
+
+static void
+input_listener_latency_stats(void *data,
+                             struct ivi_input *ivi_input,
+                             const char *name,
+                             uint32_t device,
+                             uint32_t count,
+                             uint32_t mean_us,
+                             uint32_t max_us,
+                             struct wl_array *buckets)
+{
+    struct wayland_context *ctx = data;
+    struct seat_context *seat = find_seat(&ctx->list_seat, name);
+    struct ilmInputLatencyStatistics *latency;
+    size_t size;
+    int index;
+
+    if (seat == NULL)
+        return;
+
+    switch (device) {
+    case ILM_INPUT_DEVICE_KEYBOARD:
+        index = 0;
+        break;
+    case ILM_INPUT_DEVICE_POINTER:
+        index = 1;
+        break;
+    case ILM_INPUT_DEVICE_TOUCH:
+        index = 2;
+        break;
+    default:
+        return;
+    }
+
+    latency = &seat->latency[index];
+    memset(latency, 0, sizeof *latency);
+    latency->count = count;
+    latency->meanLatency = mean_us;
+    latency->maxLatency = max_us;
+
+    size = buckets->size < sizeof latency->buckets ?
+           buckets->size : sizeof latency->buckets;
+    memcpy(latency->buckets, buckets->data, size);
+}
+
+static void
+input_listener_input_replayed(void *data,
+                              struct ivi_input *ivi_input,
+                              uint32_t events,
+                              int32_t success)
+{
+    struct wayland_context *ctx = data;
+
+    ctx->replay_events = events;
+    ctx->replay_success = success;
+    ctx->replay_done = true;
+}
+
+static void
+input_listener_input_acceptance_batch(void *data,
+                                      struct ivi_input *ivi_input,
+                                      struct wl_array *entries)
+{
+    struct wayland_context *ctx = data;
+    struct seat_context *seat_ctx;
+    /* surface id, accepted and seat id */
+    const uint32_t *entry = entries->data;
+    const uint32_t *end = entry + entries->size / sizeof *entry / 3 * 3;
+
+    if (entries->size % (3 * sizeof *entry))
+        fprintf(stderr, "Warning: incomplete input acceptance entry\n");
+
+    for (; entry < end; entry += 3) {
+        seat_ctx = find_seat_by_id(&ctx->list_seat, entry[2]);
+        if (seat_ctx == NULL) {
+            fprintf(stderr, "Warning: input acceptance event received for "
+                    "unknown seat id %u\n", entry[2]);
+            continue;
+        }
+
+        set_input_acceptance(ctx, entry[0], seat_ctx, (int32_t)entry[1]);
+    }
 }
 
 static struct ivi_input_listener input_listener = {
@@ -905,7 +1214,11 @@ static struct ivi_input_listener input_listener = {
     input_listener_seat_capabilities,
     input_listener_seat_destroyed,
     input_listener_input_focus,
-    input_listener_input_acceptance
+    input_listener_input_acceptance,
+    input_listener_latency_stats,
+    input_listener_input_replayed,
+    input_listener_seat_id,
+    input_listener_input_acceptance_batch
 };
 
 static void
@@ -927,10 +1240,9 @@ registry_handle_control(void *data,
                        uint32_t version)
 {
     struct wayland_context *ctx = data;
-    (void)version;
     if (strcmp(interface, "ivi_wm") == 0) {
-        ctx->controller = wl_registry_bind(registry, name,
-                                           &ivi_wm_interface, 2);
+        ctx->controller = wl_registry_bind(registry, name, &ivi_wm_interface,
+                                           version < 3 ? version : 3);
         if (ctx->controller == NULL) {
             fprintf(stderr, "Failed to registry bind ivi_wm\n");
             return;
@@ -940,7 +1252,8 @@ registry_handle_control(void *data,
 
     } else if (strcmp(interface, "ivi_input") == 0) {
         ctx->input_controller =
-            wl_registry_bind(registry, name, &ivi_input_interface, 2);
+            wl_registry_bind(registry, name, &ivi_input_interface,
+                             version < 3 ? version : 3);
 
         if (ctx->input_controller == NULL) {
             fprintf(stderr, "Failed to registry bind input controller\n");
@@ -1049,14 +1362,8 @@ static void destroy_control_resources(void)
         {
             struct surface_context *l;
             struct surface_context *n;
-            struct accepted_seat *seat, *seat_next;
             wl_list_for_each_safe(l, n, &ctx->wl.list_surface, link) {
-                wl_list_for_each_safe(seat, seat_next, &l->list_accepted_seats, link) {
-                    wl_list_remove(&seat->link);
-                    free(seat->seat_name);
-                    free(seat);
-                }
-
+                wl_array_release(&l->accepted_seats);
                 wl_list_remove(&l->link);
                 free(l);
             }
@@ -1089,6 +1396,11 @@ static void destroy_control_resources(void)
         wl_display_flush(ctx->wl.display);
     }
 
+    if (ctx->wl.scene_export) {
+        munmap(ctx->wl.scene_export, ctx->wl.scene_export_size);
+        ctx->wl.scene_export = NULL;
+    }
+
     if (ctx->wl.wl_shm) {
         wl_shm_destroy(ctx->wl.wl_shm);
         ctx->wl.wl_shm = NULL;
@@ -1330,6 +1642,7 @@ init_control(void)
 
     wl->has_argb8888 = false;
     wl->wl_shm = NULL;
+    wl->screenshot_format = WL_SHM_FORMAT_ABGR8888;
 
     wl->queue = wl_display_create_queue(wl->display);
     if (! wl->queue) {
@@ -1521,6 +1834,15 @@ ilm_getPropertiesOfLayer(t_ilm_uint layerID,
     return returnValue;
 }
 
+/* Drop a render order, which was pushed by the compositor without being
+ * requested, e.g. as part of the initial state, before asking again. */
+static void
+reset_render_order(struct wl_array *render_order)
+{
+    wl_array_release(render_order);
+    wl_array_init(render_order);
+}
+
 static void
 create_layerids(struct screen_context *ctx_screen,
                 t_ilm_layer **layer_ids, t_ilm_uint *layer_count)
@@ -1570,6 +1892,7 @@ ilm_getPropertiesOfScreen(t_ilm_display screenID,
     struct screen_context *ctx_screen = NULL;
     ctx_screen = get_screen_context_by_id(&ctx->wl, (uint32_t)screenID);
     if (ctx_screen != NULL) {
+        reset_render_order(&ctx_screen->render_order);
         ivi_wm_screen_get(ctx_screen->controller, IVI_WM_PARAM_RENDER_ORDER);
 
         if (wl_display_roundtrip_queue(ctx->wl.display, ctx->wl.queue) != -1 ) {
@@ -1584,6 +1907,284 @@ ilm_getPropertiesOfScreen(t_ilm_display screenID,
     return returnValue;
 }
 
+ILM_EXPORT ilmErrorTypes
+ilm_getScreenStatistics(t_ilm_uint screenID,
+                        struct ilmScreenStatistics* pStatistics)
+{
+    ilmErrorTypes returnValue = ILM_FAILED;
+    struct ilm_control_context *const ctx = &ilm_context;
+    struct screen_context *ctx_screen = NULL;
+
+    if (! pStatistics)
+    {
+        return ILM_ERROR_INVALID_ARGUMENTS;
+    }
+
+    lock_context(ctx);
+    ctx_screen = get_screen_context_by_id(&ctx->wl, (uint32_t)screenID);
+    if (ctx_screen != NULL) {
+        if (ivi_wm_screen_get_version(ctx_screen->controller) <
+            IVI_WM_SCREEN_STATS_SINCE_VERSION) {
+            returnValue = ILM_ERROR_NOT_IMPLEMENTED;
+        } else {
+            ivi_wm_screen_get(ctx_screen->controller, IVI_WM_PARAM_STATS);
+
+            if (wl_display_roundtrip_queue(ctx->wl.display, ctx->wl.queue) != -1) {
+                *pStatistics = ctx_screen->stats;
+                returnValue = ILM_SUCCESS;
+            }
+        }
+    }
+
+    unlock_context(ctx);
+    return returnValue;
+}
+
+ILM_EXPORT ilmErrorTypes
+ilm_getRequestStatistics(struct ilmRequestStatistics* pStatistics)
+{
+    ilmErrorTypes returnValue = ILM_FAILED;
+    struct ilm_control_context *const ctx = &ilm_context;
+
+    if (! pStatistics)
+    {
+        return ILM_ERROR_INVALID_ARGUMENTS;
+    }
+
+    lock_context(ctx);
+    if (ctx->wl.controller) {
+        if (ivi_wm_get_version(ctx->wl.controller) <
+            IVI_WM_REQUEST_STATS_SINCE_VERSION) {
+            returnValue = ILM_ERROR_NOT_IMPLEMENTED;
+        } else {
+            ivi_wm_get_request_stats(ctx->wl.controller);
+
+            if (wl_display_roundtrip_queue(ctx->wl.display, ctx->wl.queue) != -1) {
+                *pStatistics = ctx->wl.request_stats;
+                returnValue = ILM_SUCCESS;
+            }
+        }
+    }
+
+    unlock_context(ctx);
+    return returnValue;
+}
+
+ILM_EXPORT ilmErrorTypes
+ilm_getClientStatistics(struct ilmClientStatistics* pStatistics)
+{
+    ilmErrorTypes returnValue = ILM_FAILED;
+    struct ilm_control_context *const ctx = &ilm_context;
+
+    if (! pStatistics)
+    {
+        return ILM_ERROR_INVALID_ARGUMENTS;
+    }
+
+    lock_context(ctx);
+    if (ctx->wl.controller) {
+        if (ivi_wm_get_version(ctx->wl.controller) <
+            IVI_WM_CLIENT_STATS_SINCE_VERSION) {
+            returnValue = ILM_ERROR_NOT_IMPLEMENTED;
+        } else {
+            ivi_wm_get_client_stats(ctx->wl.controller);
+
+            if (wl_display_roundtrip_queue(ctx->wl.display, ctx->wl.queue) != -1) {
+                *pStatistics = ctx->wl.client_stats;
+                returnValue = ILM_SUCCESS;
+            }
+        }
+    }
+
+    unlock_context(ctx);
+    return returnValue;
+}
+
+/* Copies the current snapshot of the scene export. The compositor may
+ * overwrite the buffer meanwhile, which the sequence counter reveals. */
+static struct ivi_scene_export_snapshot *
+copy_scene_snapshot(struct ivi_scene_export_header *header)
+{
+    struct ivi_scene_export_snapshot *snap, *copy;
+    uint32_t index, seq, retries;
+    size_t size;
+
+    copy = malloc(header->buffer_size);
+    if (!copy)
+        return NULL;
+
+    for (retries = 0; retries < 1000; retries++) {
+        index = __atomic_load_n(&header->current, __ATOMIC_ACQUIRE);
+        snap = ivi_scene_export_buffer(header, index & 1);
+
+        seq = __atomic_load_n(&snap->seq, __ATOMIC_ACQUIRE);
+        if (seq & 1)
+            continue;
+
+        memcpy(copy, snap, sizeof *copy);
+        size = sizeof *copy +
+               copy->screen_count * sizeof(struct ivi_scene_export_screen) +
+               copy->layer_count * sizeof(struct ivi_scene_export_layer) +
+               copy->surface_count * sizeof(struct ivi_scene_export_surface) +
+               copy->id_count * sizeof(uint32_t);
+        if (size <= header->buffer_size)
+            memcpy(copy, snap, size);
+
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&snap->seq, __ATOMIC_RELAXED) == seq &&
+            size <= header->buffer_size)
+            return copy;
+    }
+
+    free(copy);
+    return NULL;
+}
+
+ILM_EXPORT void
+ilm_freeSceneSnapshot(struct ilmSceneSnapshot* pSnapshot)
+{
+    if (! pSnapshot)
+    {
+        return;
+    }
+
+    free(pSnapshot->screens);
+    free(pSnapshot->layers);
+    free(pSnapshot->surfaces);
+    free(pSnapshot->ids);
+    memset(pSnapshot, 0, sizeof *pSnapshot);
+}
+
+static ilmErrorTypes
+fill_scene_snapshot(struct ilmSceneSnapshot *pSnapshot,
+                    const struct ivi_scene_export_snapshot *snap)
+{
+    const struct ivi_scene_export_screen *screens =
+        (const struct ivi_scene_export_screen *)(snap + 1);
+    const struct ivi_scene_export_layer *layers =
+        (const struct ivi_scene_export_layer *)(screens + snap->screen_count);
+    const struct ivi_scene_export_surface *surfaces =
+        (const struct ivi_scene_export_surface *)(layers + snap->layer_count);
+    const uint32_t *ids = (const uint32_t *)(surfaces + snap->surface_count);
+    uint32_t i;
+
+    memset(pSnapshot, 0, sizeof *pSnapshot);
+    pSnapshot->generation = snap->generation;
+    pSnapshot->truncated = snap->truncated ? ILM_TRUE : ILM_FALSE;
+    pSnapshot->screens = calloc(snap->screen_count + 1, sizeof *pSnapshot->screens);
+    pSnapshot->layers = calloc(snap->layer_count + 1, sizeof *pSnapshot->layers);
+    pSnapshot->surfaces = calloc(snap->surface_count + 1, sizeof *pSnapshot->surfaces);
+    pSnapshot->ids = calloc(snap->id_count + 1, sizeof *pSnapshot->ids);
+    if (!pSnapshot->screens || !pSnapshot->layers ||
+        !pSnapshot->surfaces || !pSnapshot->ids) {
+        ilm_freeSceneSnapshot(pSnapshot);
+        return ILM_FAILED;
+    }
+
+    for (i = 0; i < snap->id_count; i++)
+        pSnapshot->ids[i] = ids[i];
+
+    for (i = 0; i < snap->screen_count; i++) {
+        struct ilmSceneScreen *screen = &pSnapshot->screens[i];
+
+        if (screens[i].first_id + (uint64_t)screens[i].layer_count > snap->id_count)
+            goto invalid;
+
+        screen->screenId = screens[i].id;
+        screen->screenWidth = screens[i].width;
+        screen->screenHeight = screens[i].height;
+        screen->layerCount = screens[i].layer_count;
+        screen->layerIds = &pSnapshot->ids[screens[i].first_id];
+    }
+    pSnapshot->screenCount = snap->screen_count;
+
+    for (i = 0; i < snap->layer_count; i++) {
+        struct ilmSceneLayer *layer = &pSnapshot->layers[i];
+
+        if (layers[i].first_id + (uint64_t)layers[i].surface_count > snap->id_count)
+            goto invalid;
+
+        layer->layerId = layers[i].id;
+        layer->prop.opacity = (t_ilm_float)wl_fixed_to_double(layers[i].opacity);
+        layer->prop.sourceX = layers[i].source_x;
+        layer->prop.sourceY = layers[i].source_y;
+        layer->prop.sourceWidth = layers[i].source_width;
+        layer->prop.sourceHeight = layers[i].source_height;
+        layer->prop.destX = layers[i].dest_x;
+        layer->prop.destY = layers[i].dest_y;
+        layer->prop.destWidth = layers[i].dest_width;
+        layer->prop.destHeight = layers[i].dest_height;
+        layer->prop.visibility = layers[i].visibility ? ILM_TRUE : ILM_FALSE;
+        layer->surfaceCount = layers[i].surface_count;
+        layer->surfaceIds = &pSnapshot->ids[layers[i].first_id];
+    }
+    pSnapshot->layerCount = snap->layer_count;
+
+    for (i = 0; i < snap->surface_count; i++) {
+        struct ilmSceneSurface *surface = &pSnapshot->surfaces[i];
+
+        surface->surfaceId = surfaces[i].id;
+        surface->prop.opacity = (t_ilm_float)wl_fixed_to_double(surfaces[i].opacity);
+        surface->prop.sourceX = surfaces[i].source_x;
+        surface->prop.sourceY = surfaces[i].source_y;
+        surface->prop.sourceWidth = surfaces[i].source_width;
+        surface->prop.sourceHeight = surfaces[i].source_height;
+        surface->prop.origSourceWidth = surfaces[i].width;
+        surface->prop.origSourceHeight = surfaces[i].height;
+        surface->prop.destX = surfaces[i].dest_x;
+        surface->prop.destY = surfaces[i].dest_y;
+        surface->prop.destWidth = surfaces[i].dest_width;
+        surface->prop.destHeight = surfaces[i].dest_height;
+        surface->prop.visibility = surfaces[i].visibility ? ILM_TRUE : ILM_FALSE;
+        surface->prop.frameCounter = surfaces[i].frame_count;
+        surface->prop.creatorPid = surfaces[i].pid;
+        surface->prop.occluded = surfaces[i].occluded ? ILM_TRUE : ILM_FALSE;
+    }
+    pSnapshot->surfaceCount = snap->surface_count;
+
+    return ILM_SUCCESS;
+
+invalid:
+    ilm_freeSceneSnapshot(pSnapshot);
+    return ILM_FAILED;
+}
+
+ILM_EXPORT ilmErrorTypes
+ilm_getSceneSnapshot(struct ilmSceneSnapshot* pSnapshot)
+{
+    ilmErrorTypes returnValue = ILM_FAILED;
+    struct ilm_control_context *const ctx = &ilm_context;
+    struct ivi_scene_export_snapshot *snap;
+
+    if (! pSnapshot)
+    {
+        return ILM_ERROR_INVALID_ARGUMENTS;
+    }
+
+    lock_context(ctx);
+    if (ctx->wl.controller && !ctx->wl.scene_export) {
+        if (ivi_wm_get_version(ctx->wl.controller) <
+            IVI_WM_SCENE_EXPORT_SINCE_VERSION) {
+            unlock_context(ctx);
+            return ILM_ERROR_NOT_IMPLEMENTED;
+        }
+
+        ivi_wm_get_scene_export(ctx->wl.controller);
+        wl_display_roundtrip_queue(ctx->wl.display, ctx->wl.queue);
+    }
+
+    if (ctx->wl.scene_export) {
+        snap = copy_scene_snapshot(ctx->wl.scene_export);
+        if (snap) {
+            returnValue = fill_scene_snapshot(pSnapshot, snap);
+            free(snap);
+        }
+    }
+
+    unlock_context(ctx);
+    return returnValue;
+}
+
 ILM_EXPORT ilmErrorTypes
 ilm_getScreenIDs(t_ilm_uint* pNumberOfIDs, t_ilm_uint** ppIDs)
 {
@@ -1684,6 +2285,7 @@ ilm_getLayerIDsOnScreen(t_ilm_uint screenId,
             *pLength = 0;
             *ppArray = NULL;
 
+            reset_render_order(&ctx_screen->render_order);
             ivi_wm_screen_get(ctx_screen->controller, IVI_WM_PARAM_RENDER_ORDER);
 
             if (wl_display_roundtrip_queue(ctx->wl.display, ctx->wl.queue) != -1 ) {
@@ -1751,6 +2353,7 @@ ilm_getSurfaceIDsOnLayer(t_ilm_layer layer,
         return ILM_FAILED;
     }
 
+    reset_render_order(&ctx_layer->render_order);
     ivi_wm_layer_get(ctx->wl.controller, layer, IVI_WM_PARAM_RENDER_ORDER);
     int ret = wl_display_roundtrip_queue(ctx->wl.display, ctx->wl.queue);
 
@@ -2127,6 +2730,29 @@ ilm_surfaceSetType(t_ilm_surface surfaceId, ilmSurfaceType type)
     return returnValue;
 }
 
+ILM_EXPORT ilmErrorTypes
+ilm_surfaceSetFrameRateLimit(t_ilm_surface surfaceId, t_ilm_uint frameRate)
+{
+    ilmErrorTypes returnValue = ILM_FAILED;
+    struct ilm_control_context *const ctx = &ilm_context;
+
+    lock_context(ctx);
+    if (ctx->wl.controller) {
+        if (ivi_wm_get_version(ctx->wl.controller) <
+            IVI_WM_SET_SURFACE_FRAME_RATE_LIMIT_SINCE_VERSION) {
+            returnValue = ILM_ERROR_NOT_IMPLEMENTED;
+        } else {
+            ivi_wm_set_surface_frame_rate_limit(ctx->wl.controller,
+                                                surfaceId, frameRate);
+            wl_display_flush(ctx->wl.display);
+            returnValue = ILM_SUCCESS;
+        }
+    }
+    unlock_context(ctx);
+
+    return returnValue;
+}
+
 ILM_EXPORT ilmErrorTypes
 ilm_displaySetRenderOrder(t_ilm_display display,
                           t_ilm_layer *pLayerId, const t_ilm_uint number)
@@ -2204,13 +2830,32 @@ destroy_shm_buffer(struct ivi_buffer *ivi_buffer)
     }
 }
 
+static size_t
+screenshot_format_bpp(uint32_t format)
+{
+    switch (format) {
+    case WL_SHM_FORMAT_ARGB8888:
+    case WL_SHM_FORMAT_ABGR8888:
+        return 4;
+    case WL_SHM_FORMAT_RGB888:
+        return 3;
+    case WL_SHM_FORMAT_RGB565:
+        return 2;
+    case WL_SHM_FORMAT_R8:
+        return 1;
+    default:
+        return 0;
+    }
+}
+
 static struct ivi_buffer *
-create_shm_buffer(uint32_t width, uint32_t height, t_ilm_bool is_surfdump)
+create_shm_buffer(uint32_t width, uint32_t height, uint32_t format)
 {
     struct ilm_control_context *const ctx = &ilm_context;
     struct ivi_buffer *ivi_buffer = NULL;
     struct wl_shm_pool *pool = NULL;
-    const size_t bytes_pp = 4U; /* bytes per pixel of ABGR32 is 4 */
+    const size_t bytes_pp = screenshot_format_bpp(format);
+    uint32_t buffer_width;
 
     /* Check wl_shm global and abgr32 is supported */
     if ((!ctx->wl.has_argb8888) || (!ctx->wl.wl_shm)) {
@@ -2218,7 +2863,7 @@ create_shm_buffer(uint32_t width, uint32_t height, t_ilm_bool is_surfdump)
         return NULL;
     }
     /* width and heigth must be bigger than 0 */
-    if ((width == 0) || (height == 0)) {
+    if ((width == 0) || (height == 0) || (bytes_pp == 0)) {
         fprintf(stderr, "create_shm_buffer: wrong input\n");
         return NULL;
     }
@@ -2228,11 +2873,15 @@ create_shm_buffer(uint32_t width, uint32_t height, t_ilm_bool is_surfdump)
         fprintf(stderr, "create_shm_buffer: no memory\n");
         return NULL;
     }
+    /* The wl_buffer is always created as ARGB32, only wide enough to
+     * hold the tightly packed rows of smaller formats.
+     */
+    buffer_width = (width * bytes_pp + 3) / 4;
     ivi_buffer->width = width;
     ivi_buffer->height = height;
-    ivi_buffer->size = (ivi_buffer->width * bytes_pp) * ivi_buffer->height;
-    ivi_buffer->format = is_surfdump ?
-            WL_SHM_FORMAT_ABGR8888 : WL_SHM_FORMAT_ARGB8888;
+    ivi_buffer->stride = width * bytes_pp;
+    ivi_buffer->size = (buffer_width * 4) * ivi_buffer->height;
+    ivi_buffer->format = format;
     /* create the screenshot file (shm file) */
     ivi_buffer->fd = create_screenshot_file(ivi_buffer->size);
     if (ivi_buffer->fd < 0) {
@@ -2255,8 +2904,8 @@ create_shm_buffer(uint32_t width, uint32_t height, t_ilm_bool is_surfdump)
      * size of bytes per pixel. Only need to notices the correctly format to user.
      */
     ivi_buffer->wl_buffer = wl_shm_pool_create_buffer(pool,
-            0, ivi_buffer->width, ivi_buffer->height,
-            ivi_buffer->width * bytes_pp, WL_SHM_FORMAT_ARGB8888);
+            0, buffer_width, ivi_buffer->height,
+            buffer_width * 4, WL_SHM_FORMAT_ARGB8888);
     if (ivi_buffer->wl_buffer == NULL) {
         fprintf(stderr, "wl_shm_create_buffer failed: %s\n", strerror(errno));
         destroy_shm_buffer(ivi_buffer);
@@ -2282,9 +2931,16 @@ screenshot_done(void *data,
     if (ctx_scrshot->callback_done)
         ctx_scrshot->callback_done(ctx_scrshot->callback_priv,
                 ivi_buffer->fd, ivi_buffer->width, ivi_buffer->height,
-                ivi_buffer->width*4, ivi_buffer->format, timestamp);
+                ivi_buffer->stride, ivi_buffer->format, timestamp);
+    if (ctx_scrshot->callback_thumbnail)
+        ctx_scrshot->callback_thumbnail(ctx_scrshot->callback_priv,
+                ivi_buffer->fd, ivi_buffer->width, ivi_buffer->height,
+                ivi_buffer->stride, ivi_buffer->format,
+                ctx_scrshot->thumbnails.size / sizeof(struct ilmThumbnail),
+                ctx_scrshot->thumbnails.data, timestamp);
     // if filename is null, free resource and return
     if (!filename) {
+        wl_array_release(&ctx_scrshot->thumbnails);
         destroy_shm_buffer(ctx_scrshot->ivi_buffer);
         free(ctx_scrshot);
         return;
@@ -2329,14 +2985,41 @@ screenshot_error(void *data, struct ivi_screenshot *ivi_screenshot,
 
     // free resource
     if (!filename) {
+        wl_array_release(&ctx_scrshot->thumbnails);
         destroy_shm_buffer(ctx_scrshot->ivi_buffer);
         free(ctx_scrshot);
     }
 }
 
+static void
+screenshot_thumbnail_layout(void *data, struct ivi_screenshot *ivi_screenshot,
+        struct wl_array *layout)
+{
+    struct screenshot_context *ctx_scrshot = data;
+    struct ilmThumbnail *thumbnail;
+    uint32_t *entry = layout->data;
+    size_t count = layout->size / (5 * sizeof(uint32_t));
+    size_t i;
+    (void)ivi_screenshot;
+
+    for (i = 0; i < count; ++i, entry += 5) {
+        thumbnail = wl_array_add(&ctx_scrshot->thumbnails, sizeof *thumbnail);
+        if (!thumbnail) {
+            fprintf(stderr, "Failed to allocate memory for thumbnail layout\n");
+            return;
+        }
+        thumbnail->surfaceId = entry[0];
+        thumbnail->x = entry[1];
+        thumbnail->y = entry[2];
+        thumbnail->width = entry[3];
+        thumbnail->height = entry[4];
+    }
+}
+
 static struct ivi_screenshot_listener screenshot_listener = {
     screenshot_done,
     screenshot_error,
+    screenshot_thumbnail_layout,
 };
 
 static ilmErrorTypes
@@ -2369,7 +3052,8 @@ ilm_takeShoot(t_ilm_uint screen, t_ilm_const_string filename,
         ctx_scrshot->callback_priv = user_data;
 
         ctx_scrshot->ivi_buffer = create_shm_buffer( 
-                ctx_scrn->prop.screenWidth, ctx_scrn->prop.screenHeight, ILM_FALSE);
+                ctx_scrn->prop.screenWidth, ctx_scrn->prop.screenHeight,
+                WL_SHM_FORMAT_ARGB8888);
         if (ctx_scrshot->ivi_buffer == NULL) {
             fprintf(stderr, "create_shm_buffer got a failure\n");
             free(ctx_scrshot);
@@ -2457,7 +3141,8 @@ ilm_takeSurfaceShoot(t_ilm_surface surfaceid, t_ilm_const_string filename,
         }
 
         ctx_scrshot->ivi_buffer = create_shm_buffer(
-                    surfCtx->prop.origSourceWidth, surfCtx->prop.origSourceHeight, ILM_TRUE);
+                    surfCtx->prop.origSourceWidth, surfCtx->prop.origSourceHeight,
+                    ctx->wl.screenshot_format);
         if (ctx_scrshot->ivi_buffer == NULL) {
             fprintf(stderr, "create_shm_buffer got a failure\n");
             free(ctx_scrshot);
@@ -2506,6 +3191,236 @@ ilm_takeSurfaceScreenshot(t_ilm_const_string filename,
     return ilm_takeSurfaceShoot(surfaceid, filename, NULL, NULL, NULL);
 }
 
+static ilmErrorTypes
+ilm_takeLayerShoot(t_ilm_layer layerid, t_ilm_const_string filename,
+                screenshotDoneNotificationFunc callback_done,
+                screenshotErrorNotificationFunc callback_error,
+                void *user_data)
+{
+    ilmErrorTypes returnValue = ILM_FAILED;
+    struct ilm_control_context *const ctx = &ilm_context;
+    struct layer_context *ctx_layer = NULL;
+
+    // if filename, callback_done and callback_error are null, don't do anything, then return success
+    if (!filename && !callback_done && !callback_error)
+        return ILM_SUCCESS;
+
+    lock_context(ctx);
+    if (ctx->wl.controller) {
+        if (ivi_wm_get_version(ctx->wl.controller) <
+            IVI_WM_LAYER_SCREENSHOT_SINCE_VERSION) {
+            returnValue = ILM_ERROR_NOT_IMPLEMENTED;
+            goto exit;
+        }
+
+        struct screenshot_context *ctx_scrshot = calloc(1, sizeof(struct screenshot_context));
+
+        if (!ctx_scrshot) {
+            fprintf(stderr, "Failed to allocate memory for screenshot_context\n");
+            goto exit;
+        }
+        ctx_scrshot->filename = filename;
+        ctx_scrshot->result = ILM_FAILED;
+        ctx_scrshot->callback_done = callback_done;
+        ctx_scrshot->callback_error = callback_error;
+        ctx_scrshot->callback_priv = user_data;
+
+        ivi_wm_layer_get(ctx->wl.controller, layerid, IVI_WM_PARAM_SIZE);
+        int ret = wl_display_roundtrip_queue(ctx->wl.display, ctx->wl.queue);
+        ctx_layer = (struct layer_context*)
+                    wayland_controller_get_layer_context(
+                        &ctx->wl, (uint32_t)layerid);
+
+        /* check the layer properties and layer id are existed */
+        if (!ctx_layer || ret == -1) {
+            fprintf(stderr, "ilm_takeLayerScreenshot: wrong layer id or can't get layer properties\n");
+            free(ctx_scrshot);
+            goto exit;
+        }
+
+        ctx_scrshot->ivi_buffer = create_shm_buffer(
+                    ctx_layer->prop.destWidth, ctx_layer->prop.destHeight,
+                    ctx->wl.screenshot_format);
+        if (ctx_scrshot->ivi_buffer == NULL) {
+            fprintf(stderr, "create_shm_buffer got a failure\n");
+            free(ctx_scrshot);
+            goto exit;
+        }
+        struct ivi_screenshot *scrshot =
+                ivi_wm_layer_screenshot(ctx->wl.controller, ctx_scrshot->ivi_buffer->wl_buffer, layerid);
+        if (scrshot) {
+            ivi_screenshot_add_listener(scrshot, &screenshot_listener, ctx_scrshot);
+            // don't need to wait if file name is empty
+            if (!filename) {
+                wl_display_flush(ctx->wl.display);
+                returnValue = ILM_SUCCESS;
+                goto exit;
+            }
+            // dispatch until filename has been reset in done or error callback
+            int ret;
+            do {
+                ret =
+                    wl_display_dispatch_queue(ctx->wl.display, ctx->wl.queue);
+            } while ((ret != -1) && ctx_scrshot->filename);
+
+            returnValue = ctx_scrshot->result;
+        }
+        destroy_shm_buffer(ctx_scrshot->ivi_buffer);
+        free(ctx_scrshot);
+    }
+exit:
+    unlock_context(ctx);
+    return returnValue;
+}
+
+ILM_EXPORT ilmErrorTypes
+ilm_takeAsyncLayerScreenshot(t_ilm_layer layerid,
+                        screenshotDoneNotificationFunc callback_done,
+                        screenshotErrorNotificationFunc callback_error,
+                        void *user_data)
+{
+    return ilm_takeLayerShoot(layerid, NULL, callback_done, callback_error, user_data);
+}
+
+ILM_EXPORT ilmErrorTypes
+ilm_takeLayerScreenshot(t_ilm_const_string filename,
+                        t_ilm_layer layerid)
+{
+    return ilm_takeLayerShoot(layerid, filename, NULL, NULL, NULL);
+}
+
+ILM_EXPORT ilmErrorTypes
+ilm_setScreenshotPixelFormat(ilmPixelFormat pixelFormat)
+{
+    ilmErrorTypes returnValue = ILM_FAILED;
+    struct ilm_control_context *const ctx = &ilm_context;
+    uint32_t format;
+
+    switch (pixelFormat) {
+    case ILM_PIXELFORMAT_RGBA_8888:
+        format = WL_SHM_FORMAT_ABGR8888;
+        break;
+    case ILM_PIXELFORMAT_RGB_888:
+        format = WL_SHM_FORMAT_RGB888;
+        break;
+    case ILM_PIXELFORMAT_RGB_565:
+        format = WL_SHM_FORMAT_RGB565;
+        break;
+    case ILM_PIXELFORMAT_R_8:
+        format = WL_SHM_FORMAT_R8;
+        break;
+    default:
+        return ILM_ERROR_INVALID_ARGUMENTS;
+    }
+
+    lock_context(ctx);
+    if (ctx->wl.controller) {
+        if (ivi_wm_get_version(ctx->wl.controller) <
+            IVI_WM_SET_SCREENSHOT_FORMAT_SINCE_VERSION) {
+            /* older compositors only write the default format */
+            if (format == WL_SHM_FORMAT_ABGR8888)
+                returnValue = ILM_SUCCESS;
+            else
+                returnValue = ILM_ERROR_NOT_IMPLEMENTED;
+        } else {
+            ivi_wm_set_screenshot_format(ctx->wl.controller, format);
+            ctx->wl.screenshot_format = format;
+            wl_display_flush(ctx->wl.display);
+            returnValue = ILM_SUCCESS;
+        }
+    }
+    unlock_context(ctx);
+
+    return returnValue;
+}
+
+ILM_EXPORT ilmErrorTypes
+ilm_takeAsyncSurfacesThumbnail(t_ilm_uint number,
+                        const t_ilm_surface *pSurfaceId,
+                        t_ilm_uint thumbWidth,
+                        t_ilm_uint thumbHeight,
+                        thumbnailDoneNotificationFunc callback_done,
+                        screenshotErrorNotificationFunc callback_error,
+                        void *user_data)
+{
+    ilmErrorTypes returnValue = ILM_FAILED;
+    struct ilm_control_context *const ctx = &ilm_context;
+    struct screenshot_context *ctx_scrshot = NULL;
+    struct ivi_screenshot *scrshot = NULL;
+    struct wl_array ids;
+    uint32_t *id;
+    t_ilm_uint columns, rows, i;
+
+    if (!number || !pSurfaceId || !thumbWidth || !thumbHeight ||
+        !callback_done)
+        return ILM_ERROR_INVALID_ARGUMENTS;
+
+    /* as square as possible, e.g. 40 thumbnails in 7 columns and 6 rows */
+    for (columns = 1; columns * columns < number; ++columns)
+        ;
+    rows = (number + columns - 1) / columns;
+
+    lock_context(ctx);
+    if (!ctx->wl.controller) {
+        goto exit;
+    }
+
+    if (ivi_wm_get_version(ctx->wl.controller) <
+        IVI_WM_SURFACES_THUMBNAIL_SINCE_VERSION) {
+        returnValue = ILM_ERROR_NOT_IMPLEMENTED;
+        goto exit;
+    }
+
+    ctx_scrshot = calloc(1, sizeof(struct screenshot_context));
+    if (!ctx_scrshot) {
+        fprintf(stderr, "Failed to allocate memory for screenshot_context\n");
+        goto exit;
+    }
+    ctx_scrshot->result = ILM_FAILED;
+    ctx_scrshot->callback_thumbnail = callback_done;
+    ctx_scrshot->callback_error = callback_error;
+    ctx_scrshot->callback_priv = user_data;
+    wl_array_init(&ctx_scrshot->thumbnails);
+
+    ctx_scrshot->ivi_buffer = create_shm_buffer(columns * thumbWidth,
+                                                rows * thumbHeight,
+                                                WL_SHM_FORMAT_ABGR8888);
+    if (ctx_scrshot->ivi_buffer == NULL) {
+        fprintf(stderr, "create_shm_buffer got a failure\n");
+        free(ctx_scrshot);
+        goto exit;
+    }
+
+    wl_array_init(&ids);
+    for (i = 0; i < number; ++i) {
+        id = wl_array_add(&ids, sizeof *id);
+        if (!id) {
+            fprintf(stderr, "Failed to allocate memory for surface ids\n");
+            wl_array_release(&ids);
+            destroy_shm_buffer(ctx_scrshot->ivi_buffer);
+            free(ctx_scrshot);
+            goto exit;
+        }
+        *id = pSurfaceId[i];
+    }
+
+    scrshot = ivi_wm_surfaces_thumbnail(ctx->wl.controller,
+            ctx_scrshot->ivi_buffer->wl_buffer, thumbWidth, thumbHeight, &ids);
+    wl_array_release(&ids);
+    if (scrshot) {
+        ivi_screenshot_add_listener(scrshot, &screenshot_listener, ctx_scrshot);
+        wl_display_flush(ctx->wl.display);
+        returnValue = ILM_SUCCESS;
+    } else {
+        destroy_shm_buffer(ctx_scrshot->ivi_buffer);
+        free(ctx_scrshot);
+    }
+
+exit:
+    unlock_context(ctx);
+    return returnValue;
+}
+
 ILM_EXPORT ilmErrorTypes
 ilm_layerAddNotification(t_ilm_layer layer,
                              layerNotificationFunc callback)
@@ -2571,7 +3486,7 @@ create_surface_context(struct wayland_context *ctx, uint32_t id_surface)
     ctx_surf->ctx = ctx;
 
     wl_list_insert(&ctx->list_surface, &ctx_surf->link);
-    wl_list_init(&ctx_surf->list_accepted_seats);
+    wl_array_init(&ctx_surf->accepted_seats);
 
     return ctx_surf;
 }
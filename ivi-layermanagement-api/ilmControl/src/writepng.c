@@ -82,6 +82,14 @@ create_png_header(image_info *info,
         color_type = PNG_COLOR_TYPE_RGB;
         png_set_bgr(info->png_ptr);
         break;
+    case WL_SHM_FORMAT_RGB888:
+    case WL_SHM_FORMAT_RGB565:
+        /* unpacked to R, G, B by save_as_png */
+        color_type = PNG_COLOR_TYPE_RGB;
+        break;
+    case WL_SHM_FORMAT_R8:
+        color_type = PNG_COLOR_TYPE_GRAY;
+        break;
     default:
         fprintf(stderr, "unsupported pixelformat 0x%x\n", format);
         return -1;
@@ -147,6 +155,35 @@ write_png_file(image_info *info,
     return 0;
 }
 
+/* Store a pixel of an image with packed rows as R, G, B, or as the
+ * luminance for R8 */
+static void
+unpack_pixel(const char *buffer, uint32_t format, int32_t offset,
+             char *out)
+{
+    const uint8_t *p;
+    uint16_t pixel;
+
+    switch (format) {
+    case WL_SHM_FORMAT_RGB888:
+        p = (const uint8_t *)buffer + offset * 3;
+        out[0] = p[2];
+        out[1] = p[1];
+        out[2] = p[0];
+        break;
+    case WL_SHM_FORMAT_RGB565:
+        p = (const uint8_t *)buffer + offset * 2;
+        pixel = p[0] | (p[1] << 8);
+        out[0] = ((pixel >> 11) << 3) | ((pixel >> 11) >> 2);
+        out[1] = (((pixel >> 5) & 0x3f) << 2) | (((pixel >> 5) & 0x3f) >> 4);
+        out[2] = ((pixel & 0x1f) << 3) | ((pixel & 0x1f) >> 2);
+        break;
+    case WL_SHM_FORMAT_R8:
+        out[0] = buffer[offset];
+        break;
+    }
+}
+
 int
 save_as_png(const char *filename,
             const char *buffer,
@@ -163,6 +200,7 @@ save_as_png(const char *filename,
     int32_t offset = 0;
     int bytes_per_pixel = 0;
     bool has_alpha = false;
+    bool packed = false;
     image_info info;
 
     if ((filename == NULL) || (buffer == NULL)) {
@@ -180,13 +218,24 @@ save_as_png(const char *filename,
     case WL_SHM_FORMAT_ABGR8888:
         has_alpha = true;
         break;
+    case WL_SHM_FORMAT_RGB888:
+    case WL_SHM_FORMAT_RGB565:
+    case WL_SHM_FORMAT_R8:
+        packed = true;
+        break;
     default:
         has_alpha = false;
         break;
     }
 
     bytes_per_pixel = has_alpha ? 4 : 3;
-    image_stride = (((width * bytes_per_pixel) + 3) & ~3);
+    if (format == WL_SHM_FORMAT_R8)
+        bytes_per_pixel = 1;
+    /* rows of packed formats are written as they are stored */
+    if (packed)
+        image_stride = width * bytes_per_pixel;
+    else
+        image_stride = (((width * bytes_per_pixel) + 3) & ~3);
     image_size = image_stride * height;
 
     image_buffer = malloc(image_size);
@@ -199,6 +248,11 @@ save_as_png(const char *filename,
     for (row = 0; row < height; ++row) {
         for (col = 0; col < width; ++col) {
             offset = row * width + col;
+            if (packed) {
+                unpack_pixel(buffer, format, offset,
+                             &image_buffer[row * image_stride + col * bytes_per_pixel]);
+                continue;
+            }
             uint32_t pixel = htonl(((uint32_t*)buffer)[offset]);
             char * pixel_p = (char*) &pixel;
             image_offset = row * image_stride + col * bytes_per_pixel;
@@ -55,6 +55,21 @@ ilmErrorTypes
 ilm_getInputAcceptanceOn(t_ilm_surface surfaceID, t_ilm_uint *num_seats,
                          t_ilm_string **seats);
 
+/**
+ * \brief      Set the input acceptance of many surfaces and seats at once
+ * \ingroup    ilmControl
+ * \param[in]  count       The number of entries
+ * \param[in]  entries     An array of changes, applied in order. Other than
+ *                         ilm_setInputAcceptanceOn, seats of a surface which
+ *                         are not mentioned keep their acceptance.
+ * \return     ILM_SUCCESS if the method call was successful
+ * \return     ILM_FAILED  if a surface or seat does not exist, or the changes
+ *                         could not be sent
+ */
+ilmErrorTypes
+ilm_setInputAcceptanceBatch(t_ilm_uint count,
+                            const struct ilmInputAcceptance *entries);
+
 /**
  * \brief      Get the list of seats that support the device types specified in
  *             bitmask
@@ -129,6 +144,42 @@ ilm_getInputFocus(t_ilm_surface **surfaceIDs, ilmInputDevice** bitmasks,
 ilmErrorTypes
 ilm_getDefaultSeat(t_ilm_string *seat_name);
 
+/**
+ * \brief      get the latency of the input events of a seat
+ * \ingroup    ilmControl
+ * \param[in]  seat_name   The name of the seat
+ * \param[in]  device      One of ILM_INPUT_DEVICE_KEYBOARD,
+ *                         ILM_INPUT_DEVICE_POINTER or ILM_INPUT_DEVICE_TOUCH
+ * \param[out] stats       A pointer to the memory where the latency of the
+ *                         events of this device type is stored
+ * \return     ILM_SUCCESS if the method call was successful
+ * \return     ILM_ERROR_NOT_IMPLEMENTED if the compositor does not measure
+ *                         the input latency
+ * \return     ILM_FAILED  if the seat does not exist or an argument is invalid
+ */
+ilmErrorTypes
+ilm_getInputLatencyStats(t_ilm_const_string seat_name, ilmInputDevice device,
+                         struct ilmInputLatencyStatistics *stats);
+
+/**
+ * \brief      inject the input events of a trace recorded by the compositor
+ * \ingroup    ilmControl
+ * \param[in]  path        The path of the trace, written by the compositor
+ *                         when input-record is set in weston.ini
+ * \param[in]  speed       The factor the recorded timing is sped up by, or
+ *                         0 to inject all events at once
+ * \param[out] events      A pointer to the memory where the number of
+ *                         injected events is stored, or NULL
+ * \return     ILM_SUCCESS if the method call was successful, after the
+ *                         replay ended
+ * \return     ILM_ERROR_NOT_IMPLEMENTED if the compositor cannot replay input
+ * \return     ILM_FAILED  if the trace could not be read or replayed, or
+ *                         input-replay is not enabled in weston.ini
+ */
+ilmErrorTypes
+ilm_replayInputEvents(t_ilm_const_string path, t_ilm_float speed,
+                      t_ilm_uint *events);
+
 #ifdef __cplusplus
 } /**/
 #endif /* __cplusplus */
@@ -17,9 +17,11 @@
  *
  ****************************************************************************/
 
+#include <fcntl.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <unistd.h>
 
 #include "ivi-input-client-protocol.h"
 #include "ilm_input.h"
@@ -27,6 +29,9 @@
 
 extern struct ilm_control_context ilm_context;
 
+/* bytes of entries sent with one ivi_input.set_input_acceptance_batch */
+#define MAX_ACCEPTANCE_BATCH_SIZE 2048
+
 ILM_EXPORT ilmErrorTypes
 ilm_setInputAcceptanceOn(t_ilm_surface surfaceID, t_ilm_uint num_seats,
                          t_ilm_string *seats)
@@ -34,10 +39,11 @@ ilm_setInputAcceptanceOn(t_ilm_surface surfaceID, t_ilm_uint num_seats,
     struct ilm_control_context *ctx;
     t_ilm_uint i;
     struct surface_context *surface_ctx = NULL;
-    struct accepted_seat *accepted_seat;
     struct seat_context *seat;
+    struct wl_array requested;
     int surface_found = 0;
     int seat_found = 0;
+    bool accepted;
 
     if ((seats == NULL) && (num_seats != 0)) {
         fprintf(stderr, "Invalid Argument\n");
@@ -59,53 +65,151 @@ ilm_setInputAcceptanceOn(t_ilm_surface surfaceID, t_ilm_uint num_seats,
         return ILM_FAILED;
     }
 
+    /* ids of the seats in 'seats' */
+    wl_array_init(&requested);
     for(i = 0; i < num_seats; i++) {
         wl_list_for_each(seat, &ctx->wl.list_seat, link) {
-            if (strcmp(seat->seat_name, seats[i]) == 0)
-                    seat_found = 1;
+            if (strcmp(seat->seat_name, seats[i]) == 0 &&
+                seat->id != SEAT_ID_INVALID) {
+                seat_found = 1;
+                break;
+            }
         }
 
         if (!seat_found) {
             fprintf(stderr, "seat: %s not found\n", seats[i]);
+            wl_array_release(&requested);
+            release_instance();
+            return ILM_FAILED;
+        }
+
+        if (seat_mask_set(&requested, seat->id) < 0) {
+            fprintf(stderr, "Failed to allocate memory for seat ids\n");
+            wl_array_release(&requested);
             release_instance();
             return ILM_FAILED;
         }
 
         seat_found = 0;
     }
+
     /* Send events to add input acceptance for every seat in 'seats', but
-     * not on the surface's list */
-    for(i = 0; i < num_seats; i++) {
-        int has_seat = 0;
+     * not accepted by the surface, and to remove it for every seat accepted
+     * by the surface but not in 'seats' */
+    wl_list_for_each(seat, &ctx->wl.list_seat, link) {
+        if (seat->id == SEAT_ID_INVALID)
+            continue;
 
-        wl_list_for_each(accepted_seat, &surface_ctx->list_accepted_seats,
-                         link) {
-            if (strcmp(accepted_seat->seat_name, seats[i]) == 0)
-                has_seat = 1;
-        }
+        accepted = seat_mask_test(&surface_ctx->accepted_seats, seat->id);
+        if (seat_mask_test(&requested, seat->id) == accepted)
+            continue;
 
-        if (!has_seat) {
-            ivi_input_set_input_acceptance(ctx->wl.input_controller,
-                                                      surfaceID, seats[i],
-                                                      ILM_TRUE);
+        ivi_input_set_input_acceptance(ctx->wl.input_controller,
+                                       surfaceID, seat->seat_name,
+                                       accepted ? ILM_FALSE : ILM_TRUE);
+    }
+
+    wl_array_release(&requested);
+    release_instance();
+    return ILM_SUCCESS;
+}
+
+ILM_EXPORT ilmErrorTypes
+ilm_setInputAcceptanceBatch(t_ilm_uint count,
+                            const struct ilmInputAcceptance *entries)
+{
+    struct ilm_control_context *ctx;
+    struct surface_context *surface_ctx;
+    struct seat_context *seat;
+    struct wl_array batch;
+    struct wl_array chunk;
+    size_t offset;
+    size_t max;
+    t_ilm_uint i;
+    uint32_t *entry;
+    int found;
+
+    if ((entries == NULL) && (count != 0)) {
+        fprintf(stderr, "Invalid Argument\n");
+        return ILM_FAILED;
+    }
+
+    for (i = 0; i < count; i++) {
+        if (entries[i].seatName == NULL) {
+            fprintf(stderr, "Invalid Argument\n");
+            return ILM_FAILED;
         }
     }
 
-    /* Send events to remove input acceptance for every seat on the surface's
-     * list but not in 'seats' */
-    wl_list_for_each(accepted_seat, &surface_ctx->list_accepted_seats, link) {
-        int has_seat = 0;
-        for (i = 0; i < num_seats; i++) {
-            if (strcmp(accepted_seat->seat_name, seats[i]) == 0)
-                has_seat = 1;
+    ctx = sync_and_acquire_instance();
+
+    /* entries of the batch: surface id, accepted and seat id */
+    wl_array_init(&batch);
+    for (i = 0; i < count; i++) {
+        found = 0;
+        wl_list_for_each(surface_ctx, &ctx->wl.list_surface, link) {
+            if (surface_ctx->id_surface == entries[i].surfaceId) {
+                found = 1;
+                break;
+            }
+        }
+        if (!found) {
+            fprintf(stderr, "surface ID %d not found\n", entries[i].surfaceId);
+            wl_array_release(&batch);
+            release_instance();
+            return ILM_FAILED;
+        }
+
+        found = 0;
+        wl_list_for_each(seat, &ctx->wl.list_seat, link) {
+            if (strcmp(seat->seat_name, entries[i].seatName) == 0 &&
+                seat->id != SEAT_ID_INVALID) {
+                found = 1;
+                break;
+            }
         }
-        if (!has_seat)
+        if (!found) {
+            fprintf(stderr, "seat: %s not found\n", entries[i].seatName);
+            wl_array_release(&batch);
+            release_instance();
+            return ILM_FAILED;
+        }
+
+        entry = wl_array_add(&batch, 3 * sizeof *entry);
+        if (entry == NULL) {
+            fprintf(stderr, "Failed to allocate memory for batch\n");
+            wl_array_release(&batch);
+            release_instance();
+            return ILM_FAILED;
+        }
+        entry[0] = entries[i].surfaceId;
+        entry[1] = entries[i].accepted ? ILM_TRUE : ILM_FALSE;
+        entry[2] = seat->id;
+    }
+
+    /* compositors without batches get one request per entry */
+    if (ivi_input_get_version(ctx->wl.input_controller) <
+        IVI_INPUT_SET_INPUT_ACCEPTANCE_BATCH_SINCE_VERSION) {
+        for (i = 0; i < count; i++) {
             ivi_input_set_input_acceptance(ctx->wl.input_controller,
-                                                      surfaceID,
-                                                      accepted_seat->seat_name,
-                                                      ILM_FALSE);
+                    entries[i].surfaceId, entries[i].seatName,
+                    entries[i].accepted ? ILM_TRUE : ILM_FALSE);
+        }
+        wl_array_release(&batch);
+        release_instance();
+        return ILM_SUCCESS;
     }
 
+    /* keep every request within the size limit of wayland messages */
+    max = MAX_ACCEPTANCE_BATCH_SIZE / (3 * sizeof *entry) * 3 * sizeof *entry;
+    chunk.alloc = 0;
+    for (offset = 0; offset < batch.size; offset += chunk.size) {
+        chunk.data = (char *)batch.data + offset;
+        chunk.size = batch.size - offset < max ? batch.size - offset : max;
+        ivi_input_set_input_acceptance_batch(ctx->wl.input_controller, &chunk);
+    }
+
+    wl_array_release(&batch);
     release_instance();
     return ILM_SUCCESS;
 }
@@ -116,7 +220,7 @@ ilm_getInputAcceptanceOn(t_ilm_surface surfaceID, t_ilm_uint *num_seats,
 {
     struct ilm_control_context *ctx;
     struct surface_context *surface_ctx;
-    struct accepted_seat *accepted_seat;
+    struct seat_context *seat;
     int surface_found = 0;
     int i;
 
@@ -140,7 +244,13 @@ ilm_getInputAcceptanceOn(t_ilm_surface surfaceID, t_ilm_uint *num_seats,
         return ILM_FAILED;
     }
 
-    *num_seats = wl_list_length(&surface_ctx->list_accepted_seats);
+    *num_seats = 0;
+    wl_list_for_each(seat, &ctx->wl.list_seat, link) {
+        if (seat->id != SEAT_ID_INVALID &&
+            seat_mask_test(&surface_ctx->accepted_seats, seat->id))
+            (*num_seats)++;
+    }
+
     *seats = calloc(*num_seats, sizeof **seats);
     if (*seats == NULL) {
         fprintf(stderr, "Failed to allocate memory for seat array\n");
@@ -149,12 +259,16 @@ ilm_getInputAcceptanceOn(t_ilm_surface surfaceID, t_ilm_uint *num_seats,
     }
 
     i = 0;
-    wl_list_for_each(accepted_seat, &surface_ctx->list_accepted_seats, link) {
-        (*seats)[i] = strdup(accepted_seat->seat_name);
+    wl_list_for_each(seat, &ctx->wl.list_seat, link) {
+        if (seat->id == SEAT_ID_INVALID ||
+            !seat_mask_test(&surface_ctx->accepted_seats, seat->id))
+            continue;
+
+        (*seats)[i] = strdup(seat->seat_name);
         if ((*seats)[i] == NULL) {
             int j;
             fprintf(stderr, "Failed to copy seat name %s\n",
-                    accepted_seat->seat_name);
+                    seat->seat_name);
             release_instance();
             for (j = 0; j < i; j++)
                 free((*seats)[j]);
@@ -356,3 +470,117 @@ ilm_getDefaultSeat(t_ilm_string *seat_name)
     release_instance();
     return (*seat_name) ? ILM_SUCCESS : ILM_FAILED;
 }
+
+ILM_EXPORT ilmErrorTypes
+ilm_getInputLatencyStats(t_ilm_const_string seat_name, ilmInputDevice device,
+                         struct ilmInputLatencyStatistics *stats)
+{
+    ilmErrorTypes returnValue = ILM_FAILED;
+    struct ilm_control_context *ctx;
+    struct seat_context *seat;
+    int index;
+
+    switch (device) {
+    case ILM_INPUT_DEVICE_KEYBOARD:
+        index = 0;
+        break;
+    case ILM_INPUT_DEVICE_POINTER:
+        index = 1;
+        break;
+    case ILM_INPUT_DEVICE_TOUCH:
+        index = 2;
+        break;
+    default:
+        index = -1;
+        break;
+    }
+
+    if ((seat_name == NULL) || (stats == NULL) || (index < 0)) {
+        fprintf(stderr, "Invalid Argument\n");
+        return ILM_FAILED;
+    }
+
+    ctx = sync_and_acquire_instance();
+
+    if (ctx->wl.input_controller == NULL) {
+        release_instance();
+        return ILM_FAILED;
+    }
+
+    if (ivi_input_get_version(ctx->wl.input_controller) <
+        IVI_INPUT_GET_LATENCY_STATS_SINCE_VERSION) {
+        release_instance();
+        return ILM_ERROR_NOT_IMPLEMENTED;
+    }
+
+    ivi_input_get_latency_stats(ctx->wl.input_controller);
+
+    if (wl_display_roundtrip_queue(ctx->wl.display, ctx->wl.queue) != -1) {
+        wl_list_for_each(seat, &ctx->wl.list_seat, link) {
+            if (strcmp(seat_name, seat->seat_name) == 0) {
+                *stats = seat->latency[index];
+                returnValue = ILM_SUCCESS;
+                break;
+            }
+        }
+    }
+
+    release_instance();
+    return returnValue;
+}
+
+ILM_EXPORT ilmErrorTypes
+ilm_replayInputEvents(t_ilm_const_string path, t_ilm_float speed,
+                      t_ilm_uint *events)
+{
+    ilmErrorTypes returnValue = ILM_FAILED;
+    struct ilm_control_context *ctx;
+    int fd;
+    int ret;
+
+    if ((path == NULL) || (speed < 0)) {
+        fprintf(stderr, "Invalid Argument\n");
+        return ILM_FAILED;
+    }
+
+    fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        fprintf(stderr, "failed to open %s\n", path);
+        return ILM_FAILED;
+    }
+
+    ctx = sync_and_acquire_instance();
+
+    if (ctx->wl.input_controller == NULL) {
+        release_instance();
+        close(fd);
+        return ILM_FAILED;
+    }
+
+    if (ivi_input_get_version(ctx->wl.input_controller) <
+        IVI_INPUT_REPLAY_INPUT_SINCE_VERSION) {
+        release_instance();
+        close(fd);
+        return ILM_ERROR_NOT_IMPLEMENTED;
+    }
+
+    ctx->wl.replay_done = false;
+    ivi_input_replay_input(ctx->wl.input_controller, fd,
+                           wl_fixed_from_double(speed));
+    /* the request carries a duplicate of fd */
+    close(fd);
+
+    // dispatch until the compositor reports the end of the replay
+    do {
+        ret = wl_display_dispatch_queue(ctx->wl.display, ctx->wl.queue);
+    } while ((ret != -1) && !ctx->wl.replay_done);
+
+    if (ctx->wl.replay_done && ctx->wl.replay_success) {
+        if (events)
+            *events = ctx->wl.replay_events;
+        returnValue = ILM_SUCCESS;
+    }
+
+    release_instance();
+    return returnValue;
+}
@@ -32,8 +32,8 @@ class TestEnvChecking
     struct ivi_input *mpInputController;
     bool mCheck;
 
-    static constexpr uint32_t IVI_CONTROLLER_VERSION{2U};
-    static constexpr uint32_t IVI_INPUT_VERSION{2U};
+    static constexpr uint32_t IVI_CONTROLLER_VERSION{3U};
+    static constexpr uint32_t IVI_INPUT_VERSION{3U};
 
     static TestEnvChecking *GetInstance();
     ~TestEnvChecking();
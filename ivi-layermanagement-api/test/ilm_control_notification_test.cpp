@@ -28,6 +28,7 @@
 #include <stdlib.h>
 #include <signal.h>
 #include <assert.h>
+#include <vector>
 
 extern "C" {
     #include "ilm_control.h"
@@ -37,6 +38,7 @@ struct screenshot_data_t {
     std::atomic<int32_t> fd;
     std::atomic<uint32_t> error;
     ilmErrorTypes result = ILM_SUCCESS;
+    std::vector<ilmThumbnail> thumbnails;
 };
 
 void add_nsecs(struct timespec *tv, long nsec)
@@ -247,6 +249,17 @@ public:
         return screenshotData->result;
     }
 
+    static ilmErrorTypes ThumbnailDoneCallbackFunc(void *user_data, t_ilm_int fd, t_ilm_uint width, t_ilm_uint height, t_ilm_uint stride, t_ilm_uint format, t_ilm_uint count, const ilmThumbnail *thumbnails, t_ilm_uint timestamp)
+    {
+        PthreadMutexLock lock(notificationMutex);
+        screenshot_data_t *screenshotData = static_cast<screenshot_data_t*>(user_data);
+        screenshotData->fd.store(fd);
+        screenshotData->thumbnails.assign(thumbnails, thumbnails + count);
+        timesCalled++;
+        pthread_cond_signal( &waiterVariable );
+        return screenshotData->result;
+    }
+
     static void ScreenshotErrorCallbackFunc(void *user_data, t_ilm_uint error, const char *message)
     {
         PthreadMutexLock lock(notificationMutex);
@@ -774,6 +787,82 @@ TEST_F(NotificationTest, getNotificationWhenScreenshotDone)
     ASSERT_NE(screenshotData.fd.load(), -1);
 }
 
+TEST_F(NotificationTest, getNotificationWhenSurfacesThumbnailDone)
+{
+    /* Call ilm_takeAsyncSurfacesThumbnail with an existing and a wrong
+     * surface id. Thumbnail done callback should be triggered with a
+     * thumbnail of the existing surface only.
+     */
+    t_ilm_surface surfaces[] = {surface, 0xdeadbeef};
+    screenshot_data_t screenshotData;
+    screenshotData.fd.store(-1);
+    ASSERT_EQ(ILM_SUCCESS, ilm_takeAsyncSurfacesThumbnail(2, surfaces, 16, 16, ThumbnailDoneCallbackFunc, ScreenshotErrorCallbackFunc, &screenshotData));
+    assertCallbackcalled();
+    ASSERT_NE(screenshotData.fd.load(), -1);
+    ASSERT_EQ(2u, screenshotData.thumbnails.size());
+
+    EXPECT_EQ(surface, screenshotData.thumbnails[0].surfaceId);
+    EXPECT_GT(screenshotData.thumbnails[0].width, 0u);
+    EXPECT_LE(screenshotData.thumbnails[0].width, 16u);
+    EXPECT_GT(screenshotData.thumbnails[0].height, 0u);
+    EXPECT_LE(screenshotData.thumbnails[0].height, 16u);
+
+    EXPECT_EQ(0xdeadbeef, screenshotData.thumbnails[1].surfaceId);
+    EXPECT_EQ(0u, screenshotData.thumbnails[1].width);
+    EXPECT_EQ(0u, screenshotData.thumbnails[1].height);
+
+    /* no surfaces or an empty cell are rejected right away */
+    EXPECT_EQ(ILM_ERROR_INVALID_ARGUMENTS, ilm_takeAsyncSurfacesThumbnail(0, surfaces, 16, 16, ThumbnailDoneCallbackFunc, ScreenshotErrorCallbackFunc, &screenshotData));
+    EXPECT_EQ(ILM_ERROR_INVALID_ARGUMENTS, ilm_takeAsyncSurfacesThumbnail(2, surfaces, 0, 16, ThumbnailDoneCallbackFunc, ScreenshotErrorCallbackFunc, &screenshotData));
+}
+
+TEST_F(NotificationTest, surfaceScreenshotQueueAnswersEveryRequest)
+{
+    /* IVI_SCREENSHOT_ERROR_BUSY of ivi-wm.xml */
+    const uint32_t errorBusy = 7;
+    /* larger than the default screenshot-queue-depth of 4 */
+    const int burst = 16;
+    const uint32_t noError = 0xffffffff;
+    screenshot_data_t screenshotData[burst];
+    int done = 0;
+    int busy = 0;
+
+    /* Screenshots requested one after the other are all taken */
+    for (int i = 0; i < 8; ++i)
+    {
+        screenshotData[0].fd.store(-1);
+        screenshotData[0].error.store(noError);
+        ASSERT_EQ(ILM_SUCCESS, ilm_takeAsyncSurfaceScreenshot(surface, ScreenshotDoneCallbackFunc, ScreenshotErrorCallbackFunc, &screenshotData[0]));
+        assertCallbackcalled();
+        ASSERT_NE(screenshotData[0].fd.load(), -1);
+        ASSERT_EQ(noError, screenshotData[0].error.load());
+    }
+
+    /* A burst fills the queue, the requests which do not fit into it are
+     * answered with the busy error instead of being dropped */
+    for (int i = 0; i < burst; ++i)
+    {
+        screenshotData[i].fd.store(-1);
+        screenshotData[i].error.store(noError);
+        ASSERT_EQ(ILM_SUCCESS, ilm_takeAsyncSurfaceScreenshot(surface, ScreenshotDoneCallbackFunc, ScreenshotErrorCallbackFunc, &screenshotData[i]));
+    }
+    assertCallbackcalled(burst);
+
+    for (int i = 0; i < burst; ++i)
+    {
+        /* each request got exactly one answer */
+        EXPECT_NE(screenshotData[i].fd.load() != -1,
+                  screenshotData[i].error.load() != noError);
+        if (screenshotData[i].fd.load() != -1)
+            done++;
+        else if (screenshotData[i].error.load() == errorBusy)
+            busy++;
+    }
+    EXPECT_GT(done, 0);
+    EXPECT_GT(busy, 0);
+    EXPECT_EQ(burst, done + busy);
+}
+
 TEST_F(NotificationTest, invalidInputsIsNotToReceiveNotificationsScreenshot)
 {
     /* Call ilm_takeAsyncScreenshot with wrong screen id
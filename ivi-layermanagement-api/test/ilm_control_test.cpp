@@ -72,6 +72,33 @@ public:
         EXPECT_EQ(ILM_SUCCESS, ilm_commitChanges());
         EXPECT_EQ(ILM_SUCCESS, ilm_destroy());
     }
+
+    // Shows the surface at the destination rectangle on a visible layer of
+    // 800x480, which is the only layer of the first screen
+    void showSurfaceOnScreen(t_ilm_layer layer, t_ilm_surface surface,
+                             t_ilm_uint x, t_ilm_uint y,
+                             t_ilm_uint width, t_ilm_uint height,
+                             t_ilm_uint* screen = NULL)
+    {
+        t_ilm_uint* screenIDs = NULL;
+        t_ilm_uint numberOfScreens = 0;
+
+        ASSERT_EQ(ILM_SUCCESS, ilm_getScreenIDs(&numberOfScreens, &screenIDs));
+        ASSERT_LT(0u, numberOfScreens);
+        if (screen)
+            *screen = screenIDs[0];
+
+        ASSERT_EQ(ILM_SUCCESS, ilm_layerCreateWithDimension(&layer, 800, 480));
+        ASSERT_EQ(ILM_SUCCESS, ilm_layerSetSourceRectangle(layer, 0, 0, 800, 480));
+        ASSERT_EQ(ILM_SUCCESS, ilm_layerSetDestinationRectangle(layer, 0, 0, 800, 480));
+        ASSERT_EQ(ILM_SUCCESS, ilm_layerSetVisibility(layer, ILM_TRUE));
+        ASSERT_EQ(ILM_SUCCESS, ilm_surfaceSetDestinationRectangle(surface, x, y, width, height));
+        ASSERT_EQ(ILM_SUCCESS, ilm_surfaceSetVisibility(surface, ILM_TRUE));
+        ASSERT_EQ(ILM_SUCCESS, ilm_layerAddSurface(layer, surface));
+        ASSERT_EQ(ILM_SUCCESS, ilm_displaySetRenderOrder(screenIDs[0], &layer, 1));
+        ASSERT_EQ(ILM_SUCCESS, ilm_commitChanges());
+        free(screenIDs);
+    }
 };
 
 TEST_F(IlmCommandTest, SetGetSurfaceOpacity) {
@@ -430,6 +457,37 @@ TEST_F(IlmCommandTest, ilm_layerAddSurface_ilm_layerRemoveSurface_ilm_getSurface
     ASSERT_EQ(length, 0);
 }
 
+TEST_F(IlmCommandTest, ilm_initialState_afterReconnect) {
+    uint layer = 3247;
+    uint surface1 = iviSurfaces[0].surface_id;
+    uint surface2 = iviSurfaces[1].surface_id;
+
+    ASSERT_EQ(ILM_SUCCESS, ilm_layerCreateWithDimension(&layer, 800, 480));
+    ASSERT_EQ(ILM_SUCCESS, ilm_layerSetOpacity(layer, 0.5));
+    ASSERT_EQ(ILM_SUCCESS, ilm_layerAddSurface(layer, surface1));
+    ASSERT_EQ(ILM_SUCCESS, ilm_layerAddSurface(layer, surface2));
+    ASSERT_EQ(ILM_SUCCESS, ilm_commitChanges());
+
+    // the initial state sent on bind must not add to the requested render order
+    ASSERT_EQ(ILM_SUCCESS, ilm_destroy());
+    ASSERT_EQ(ILM_SUCCESS, ilm_initWithNativedisplay((t_ilm_nativedisplay)wlDisplay));
+
+    t_ilm_int length;
+    t_ilm_uint* IDs;
+    ASSERT_EQ(ILM_SUCCESS, ilm_getSurfaceIDsOnLayer(layer, &length, &IDs));
+    EXPECT_EQ(length, 2);
+    if (length == 2)
+    {
+       EXPECT_EQ(surface1, IDs[0]);
+       EXPECT_EQ(surface2, IDs[1]);
+    }
+    free(IDs);
+
+    ilmLayerProperties layerProperties;
+    ASSERT_EQ(ILM_SUCCESS, ilm_getPropertiesOfLayer(layer, &layerProperties));
+    EXPECT_NEAR(0.5, layerProperties.opacity, 0.01);
+}
+
 TEST_F(IlmCommandTest, ilm_getSurfaceIDsOnLayer_InvalidInput) {
     uint layer = 0xdeadbeef;
 
@@ -499,6 +557,241 @@ TEST_F(IlmCommandTest, ilm_getPropertiesOfSurface_ilm_surfaceSetSourceRectangle_
     ASSERT_FALSE(surfaceProperties2.visibility);
 }
 
+TEST_F(IlmCommandTest, ilm_getPropertiesOfSurface_frameStatistics) {
+    uint surface = iviSurfaces[0].surface_id;
+
+    for (int i = 0; i < 5; ++i)
+    {
+        wl_surface_commit(wlSurfaces[0]);
+        wl_display_flush(wlDisplay);
+        usleep(10000);
+    }
+
+    ilmSurfaceProperties surfaceProperties;
+    ASSERT_EQ(ILM_SUCCESS, ilm_getPropertiesOfSurface(surface, &surfaceProperties));
+    EXPECT_LE(5u, surfaceProperties.frameCounter);
+    EXPECT_LT(0.0, surfaceProperties.commitRate);
+    EXPECT_LE(surfaceProperties.minCommitInterval, surfaceProperties.avgCommitInterval);
+    EXPECT_LE(surfaceProperties.avgCommitInterval, surfaceProperties.maxCommitInterval);
+    EXPECT_LE(surfaceProperties.p99CommitInterval, surfaceProperties.maxCommitInterval);
+    EXPECT_NE(0u, surfaceProperties.lastCommitTime);
+}
+
+TEST_F(IlmCommandTest, ilm_getPropertiesOfSurface_occlusion) {
+    uint surface = iviSurfaces[0].surface_id;
+    ilmSurfaceProperties surfaceProperties;
+
+    // a surface which is on no screen is not shown
+    ASSERT_EQ(ILM_SUCCESS, ilm_getPropertiesOfSurface(surface, &surfaceProperties));
+    EXPECT_TRUE(surfaceProperties.occluded);
+
+    ASSERT_NO_FATAL_FAILURE(showSurfaceOnScreen(0xbeef, surface, 0, 0, 100, 100));
+
+    ASSERT_EQ(ILM_SUCCESS, ilm_getPropertiesOfSurface(surface, &surfaceProperties));
+    EXPECT_FALSE(surfaceProperties.occluded);
+
+    ASSERT_EQ(ILM_SUCCESS, ilm_surfaceSetVisibility(surface, ILM_FALSE));
+    ASSERT_EQ(ILM_SUCCESS, ilm_commitChanges());
+
+    ASSERT_EQ(ILM_SUCCESS, ilm_getPropertiesOfSurface(surface, &surfaceProperties));
+    EXPECT_TRUE(surfaceProperties.occluded);
+}
+
+TEST_F(IlmCommandTest, ilm_commitChanges_dropsRedundantRequests) {
+    uint surface = iviSurfaces[0].surface_id;
+    t_ilm_layer layer = 0xbeef;
+    ilmRequestStatistics requestsBefore;
+    ilmRequestStatistics requestsAfter;
+    const int rounds = 10;
+
+    ASSERT_NO_FATAL_FAILURE(showSurfaceOnScreen(layer, surface, 0, 0, 100, 100));
+    ASSERT_EQ(ILM_SUCCESS, ilm_surfaceSetOpacity(surface, 0.5));
+    ASSERT_EQ(ILM_SUCCESS, ilm_commitChanges());
+
+    ASSERT_EQ(ILM_SUCCESS, ilm_getRequestStatistics(&requestsBefore));
+
+    // set every property to the value it has already
+    for (int i = 0; i < rounds; ++i)
+    {
+        ASSERT_EQ(ILM_SUCCESS, ilm_surfaceSetDestinationRectangle(surface, 0, 0, 100, 100));
+        ASSERT_EQ(ILM_SUCCESS, ilm_surfaceSetOpacity(surface, 0.5));
+        ASSERT_EQ(ILM_SUCCESS, ilm_surfaceSetVisibility(surface, ILM_TRUE));
+        ASSERT_EQ(ILM_SUCCESS, ilm_layerSetVisibility(layer, ILM_TRUE));
+        ASSERT_EQ(ILM_SUCCESS, ilm_commitChanges());
+    }
+
+    ASSERT_EQ(ILM_SUCCESS, ilm_getRequestStatistics(&requestsAfter));
+
+    EXPECT_EQ(requestsBefore.skippedRequests + rounds * 4, requestsAfter.skippedRequests);
+    EXPECT_EQ(requestsBefore.skippedCommits + rounds, requestsAfter.skippedCommits);
+    EXPECT_EQ(requestsBefore.commits, requestsAfter.commits);
+
+    // a real change is still applied
+    ASSERT_EQ(ILM_SUCCESS, ilm_surfaceSetOpacity(surface, 0.25));
+    ASSERT_EQ(ILM_SUCCESS, ilm_commitChanges());
+    ASSERT_EQ(ILM_SUCCESS, ilm_getRequestStatistics(&requestsAfter));
+    EXPECT_EQ(requestsBefore.commits + 1, requestsAfter.commits);
+
+    t_ilm_float opacity;
+    ASSERT_EQ(ILM_SUCCESS, ilm_surfaceGetOpacity(surface, &opacity));
+    EXPECT_NEAR(0.25, opacity, 0.01);
+
+    // setting the committed value back after a change is not dropped
+    ASSERT_EQ(ILM_SUCCESS, ilm_surfaceSetOpacity(surface, 0.75));
+    ASSERT_EQ(ILM_SUCCESS, ilm_surfaceSetOpacity(surface, 0.25));
+    ASSERT_EQ(ILM_SUCCESS, ilm_commitChanges());
+    ASSERT_EQ(ILM_SUCCESS, ilm_surfaceGetOpacity(surface, &opacity));
+    EXPECT_NEAR(0.25, opacity, 0.01);
+}
+
+TEST_F(IlmCommandTest, ilm_getClientStatistics) {
+    uint surface = iviSurfaces[0].surface_id;
+    ilmClientStatistics before;
+    ilmClientStatistics after;
+    const int rounds = 5;
+
+    ASSERT_EQ(ILM_SUCCESS, ilm_getClientStatistics(&before));
+
+    for (int i = 0; i < rounds; ++i)
+    {
+        ASSERT_EQ(ILM_SUCCESS, ilm_surfaceSetOpacity(surface, 0.2 + 0.1 * i));
+        ASSERT_EQ(ILM_SUCCESS, ilm_commitChanges());
+    }
+
+    ASSERT_EQ(ILM_SUCCESS, ilm_getClientStatistics(&after));
+
+    t_ilm_uint requestsBefore = 0;
+    t_ilm_uint requestsAfter = 0;
+    for (int i = 0; i < ILM_CLIENT_REQUEST_OPCODES; ++i)
+    {
+        EXPECT_LE(before.requests[i], after.requests[i]);
+        requestsBefore += before.requests[i];
+        requestsAfter += after.requests[i];
+    }
+
+    // the opacity requests, the commits and the query itself
+    EXPECT_LE(requestsBefore + 2 * rounds + 1, requestsAfter);
+    EXPECT_LT(before.events, after.events);
+    EXPECT_LE(before.eventBytes + 8 * (after.events - before.events),
+              after.eventBytes);
+    EXPECT_EQ(before.deferredCommits, after.deferredCommits);
+}
+
+TEST_F(IlmCommandTest, ilm_getClientStatistics_InvalidInput) {
+    ASSERT_EQ(ILM_ERROR_INVALID_ARGUMENTS, ilm_getClientStatistics(NULL));
+}
+
+TEST_F(IlmCommandTest, ilm_getSceneSnapshot) {
+    uint surface = iviSurfaces[0].surface_id;
+    t_ilm_layer layer = 0xbeef;
+    t_ilm_uint screen = 0;
+    ilmSceneSnapshot snapshot;
+    ilmSceneSnapshot updated;
+
+    ASSERT_NO_FATAL_FAILURE(showSurfaceOnScreen(layer, surface, 10, 20, 100, 200,
+                                                &screen));
+    ASSERT_EQ(ILM_SUCCESS, ilm_surfaceSetOpacity(surface, 0.5));
+    ASSERT_EQ(ILM_SUCCESS, ilm_commitChanges());
+
+    // the scene is published once the compositor is idle
+    usleep(100000);
+    ASSERT_EQ(ILM_SUCCESS, ilm_getSceneSnapshot(&snapshot));
+    EXPECT_EQ(ILM_FALSE, snapshot.truncated);
+
+    bool screenFound = false;
+    for (t_ilm_uint i = 0; i < snapshot.screenCount; ++i)
+    {
+        if (snapshot.screens[i].screenId != screen)
+            continue;
+        screenFound = true;
+        ASSERT_EQ(1u, snapshot.screens[i].layerCount);
+        EXPECT_EQ(layer, snapshot.screens[i].layerIds[0]);
+    }
+    EXPECT_TRUE(screenFound);
+
+    bool layerFound = false;
+    for (t_ilm_uint i = 0; i < snapshot.layerCount; ++i)
+    {
+        if (snapshot.layers[i].layerId != layer)
+            continue;
+        layerFound = true;
+        EXPECT_EQ(ILM_TRUE, snapshot.layers[i].prop.visibility);
+        ASSERT_EQ(1u, snapshot.layers[i].surfaceCount);
+        EXPECT_EQ(surface, snapshot.layers[i].surfaceIds[0]);
+    }
+    EXPECT_TRUE(layerFound);
+
+    bool surfaceFound = false;
+    for (t_ilm_uint i = 0; i < snapshot.surfaceCount; ++i)
+    {
+        if (snapshot.surfaces[i].surfaceId != surface)
+            continue;
+        surfaceFound = true;
+        EXPECT_EQ(10u, snapshot.surfaces[i].prop.destX);
+        EXPECT_EQ(20u, snapshot.surfaces[i].prop.destY);
+        EXPECT_EQ(100u, snapshot.surfaces[i].prop.destWidth);
+        EXPECT_EQ(200u, snapshot.surfaces[i].prop.destHeight);
+        EXPECT_NEAR(0.5, snapshot.surfaces[i].prop.opacity, 0.01);
+    }
+    EXPECT_TRUE(surfaceFound);
+
+    // a change is published in a newer snapshot
+    ASSERT_EQ(ILM_SUCCESS, ilm_surfaceSetOpacity(surface, 0.25));
+    ASSERT_EQ(ILM_SUCCESS, ilm_commitChanges());
+    usleep(100000);
+    ASSERT_EQ(ILM_SUCCESS, ilm_getSceneSnapshot(&updated));
+    EXPECT_LT(snapshot.generation, updated.generation);
+
+    for (t_ilm_uint i = 0; i < updated.surfaceCount; ++i)
+    {
+        if (updated.surfaces[i].surfaceId == surface)
+            EXPECT_NEAR(0.25, updated.surfaces[i].prop.opacity, 0.01);
+    }
+
+    ilm_freeSceneSnapshot(&snapshot);
+    ilm_freeSceneSnapshot(&updated);
+}
+
+TEST_F(IlmCommandTest, ilm_getSceneSnapshot_InvalidInput) {
+    ASSERT_EQ(ILM_ERROR_INVALID_ARGUMENTS, ilm_getSceneSnapshot(NULL));
+}
+
+TEST_F(IlmCommandTest, ilm_surfaceSetFrameRateLimit) {
+    uint surface = iviSurfaces[0].surface_id;
+    ilmSurfaceProperties surfaceProperties;
+
+    ASSERT_EQ(ILM_SUCCESS, ilm_getPropertiesOfSurface(surface, &surfaceProperties));
+    EXPECT_EQ(0u, surfaceProperties.frameRateLimit);
+
+    ASSERT_EQ(ILM_SUCCESS, ilm_surfaceSetFrameRateLimit(surface, 10));
+    ASSERT_EQ(ILM_SUCCESS, ilm_getPropertiesOfSurface(surface, &surfaceProperties));
+    EXPECT_EQ(10u, surfaceProperties.frameRateLimit);
+    EXPECT_GE(10.0, surfaceProperties.enforcedFrameRate);
+
+    /* an application drawing per frame callback on a screen is paced */
+    ASSERT_NO_FATAL_FAILURE(showSurfaceOnScreen(0xbeef, surface, 0, 0, 100, 100));
+
+    for (int i = 0; i < 5; ++i)
+    {
+        wl_callback_destroy(wl_surface_frame(wlSurfaces[0]));
+        wl_surface_commit(wlSurfaces[0]);
+        wl_display_flush(wlDisplay);
+    }
+    ASSERT_EQ(ILM_SUCCESS, ilm_getPropertiesOfSurface(surface, &surfaceProperties));
+    EXPECT_LE(1u, surfaceProperties.pacedFrames);
+
+    ASSERT_EQ(ILM_SUCCESS, ilm_surfaceSetFrameRateLimit(surface, 0));
+    ASSERT_EQ(ILM_SUCCESS, ilm_getPropertiesOfSurface(surface, &surfaceProperties));
+    EXPECT_EQ(0u, surfaceProperties.frameRateLimit);
+}
+
+TEST_F(IlmCommandTest, ilm_surfaceSetFrameRateLimit_InvalidInput) {
+    ilmSurfaceProperties surfaceProperties;
+
+    ASSERT_EQ(ILM_SUCCESS, ilm_surfaceSetFrameRateLimit(0xdeadbeef, 10));
+    ASSERT_NE(ILM_SUCCESS, ilm_getPropertiesOfSurface(0xdeadbeef, &surfaceProperties));
+}
+
 TEST_F(IlmCommandTest, ilm_getPropertiesOfLayer_ilm_layerSetSourceRectangle_ilm_layerSetDestinationRectangle) {
     t_ilm_uint layer = 0xbeef;
     ASSERT_EQ(ILM_SUCCESS, ilm_layerCreateWithDimension(&layer, 800, 480));
@@ -618,6 +911,77 @@ TEST_F(IlmCommandTest, ilm_takeSurfaceScreenshot_InvalidInputs) {
     ASSERT_NE(0, remove(outputFile));
 }
 
+TEST_F(IlmCommandTest, ilm_takeSurfaceScreenshot_PixelFormats) {
+    const char* outputFiles[] = {"/tmp/test.bmp", "/tmp/test.png"};
+    const ilmPixelFormat formats[] = {ILM_PIXELFORMAT_RGB_888,
+                                      ILM_PIXELFORMAT_RGB_565,
+                                      ILM_PIXELFORMAT_R_8,
+                                      ILM_PIXELFORMAT_RGBA_8888};
+    uint surface = iviSurfaces[0].surface_id;
+    ASSERT_EQ(ILM_SUCCESS, ilm_commitChanges());
+
+    for (unsigned int i = 0; i < sizeof(formats) / sizeof(formats[0]); ++i)
+    {
+        ASSERT_EQ(ILM_SUCCESS, ilm_setScreenshotPixelFormat(formats[i]));
+
+        for (unsigned int j = 0; j < sizeof(outputFiles) / sizeof(outputFiles[0]); ++j)
+        {
+            remove(outputFiles[j]);
+            ASSERT_EQ(ILM_SUCCESS, ilm_takeSurfaceScreenshot(outputFiles[j], surface));
+
+            FILE* f = fopen(outputFiles[j], "r");
+            ASSERT_TRUE(f!=NULL);
+            fclose(f);
+            remove(outputFiles[j]);
+        }
+    }
+}
+
+TEST_F(IlmCommandTest, ilm_setScreenshotPixelFormat_InvalidInput) {
+    ASSERT_EQ(ILM_ERROR_INVALID_ARGUMENTS, ilm_setScreenshotPixelFormat(ILM_PIXELFORMAT_RGBA_4444));
+    ASSERT_EQ(ILM_ERROR_INVALID_ARGUMENTS, ilm_setScreenshotPixelFormat(ILM_PIXEL_FORMAT_UNKNOWN));
+}
+
+TEST_F(IlmCommandTest, ilm_takeLayerScreenshot) {
+    const char* outputFile = "/tmp/test.bmp";
+    // make sure the file is not there before
+    FILE* f = fopen(outputFile, "r");
+    if (f!=NULL){
+        fclose(f);
+        int result = remove(outputFile);
+        ASSERT_EQ(0, result);
+    }
+
+    t_ilm_layer layer = 0xbeef;
+    uint surface = iviSurfaces[0].surface_id;
+    ASSERT_NO_FATAL_FAILURE(showSurfaceOnScreen(layer, surface, 10, 10, 50, 50));
+    ASSERT_EQ(ILM_SUCCESS, ilm_takeLayerScreenshot(outputFile, layer));
+
+    f = fopen(outputFile, "r");
+    ASSERT_TRUE(f!=NULL);
+    fclose(f);
+    remove(outputFile);
+
+    ASSERT_EQ(ILM_SUCCESS, ilm_layerRemove(layer));
+    ASSERT_EQ(ILM_SUCCESS, ilm_commitChanges());
+}
+
+TEST_F(IlmCommandTest, ilm_takeLayerScreenshot_InvalidInputs) {
+    const char* outputFile = "/tmp/test.bmp";
+    // make sure the file is not there before
+    FILE* f = fopen(outputFile, "r");
+    if (f!=NULL){
+        fclose(f);
+        ASSERT_EQ(0, remove(outputFile));
+    }
+
+    // try to dump an non-existing layer
+    ASSERT_EQ(ILM_FAILED, ilm_takeLayerScreenshot(outputFile, 0xdeadbeef));
+
+    // make sure, no layer dump file was created for invalid layer
+    ASSERT_NE(0, remove(outputFile));
+}
+
 TEST_F(IlmCommandTest, ilm_getPropertiesOfScreen) {
     t_ilm_uint numberOfScreens;
     t_ilm_uint* screenIDs;
@@ -658,6 +1022,37 @@ TEST_F(IlmCommandTest, ilm_getPropertiesOfScreen) {
     free(screenIDs);
 }
 
+TEST_F(IlmCommandTest, ilm_getScreenStatistics) {
+    t_ilm_uint numberOfScreens;
+    t_ilm_uint* screenIDs;
+    ASSERT_EQ(ILM_SUCCESS, ilm_getScreenIDs(&numberOfScreens, &screenIDs));
+    EXPECT_TRUE(numberOfScreens>0);
+
+    if (numberOfScreens > 0)
+    {
+        ilmScreenStatistics statistics;
+        t_ilm_uint histogramFrames = 0;
+
+        ASSERT_EQ(ILM_SUCCESS, ilm_getScreenStatistics(screenIDs[0], &statistics));
+        EXPECT_LE(statistics.presentDelayAvg, statistics.presentDelayMax);
+
+        for (int i = 0; i < ILM_SCREEN_FRAME_TIME_BUCKETS; ++i)
+        {
+            histogramFrames += statistics.frameTimeHistogram[i];
+        }
+        EXPECT_LE(histogramFrames, statistics.frames);
+    }
+
+    free(screenIDs);
+}
+
+TEST_F(IlmCommandTest, ilm_getScreenStatistics_InvalidInput) {
+    ilmScreenStatistics statistics;
+
+    ASSERT_NE(ILM_SUCCESS, ilm_getScreenStatistics(0xdeadbeef, &statistics));
+    ASSERT_EQ(ILM_ERROR_INVALID_ARGUMENTS, ilm_getScreenStatistics(0, NULL));
+}
+
 TEST_F(IlmCommandTest, DisplaySetRenderOrder_growing) {
     //prepare needed layers
     t_ilm_layer renderOrder[] = {0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF};
@@ -151,3 +151,31 @@ TEST_F(IlmNullPointerTest, ilm_get_input_device_capabilities_null_pointer) {
     EXPECT_EQ(ILM_FAILED, ilm_getInputDeviceCapabilities(NULL, &bitmask));
     EXPECT_EQ(ILM_FAILED, ilm_getInputDeviceCapabilities((t_ilm_string)seats, NULL));
 }
+
+TEST_F(IlmNullPointerTest, ilm_get_input_latency_stats_null_pointer) {
+    char const *seat = "default";
+    struct ilmInputLatencyStatistics stats;
+
+    EXPECT_EQ(ILM_FAILED, ilm_getInputLatencyStats(NULL,
+                                                   ILM_INPUT_DEVICE_KEYBOARD,
+                                                   &stats));
+    EXPECT_EQ(ILM_FAILED, ilm_getInputLatencyStats(seat,
+                                                   ILM_INPUT_DEVICE_KEYBOARD,
+                                                   NULL));
+    EXPECT_EQ(ILM_FAILED, ilm_getInputLatencyStats(seat,
+                                                   ILM_INPUT_DEVICE_ALL,
+                                                   &stats));
+}
+
+TEST_F(IlmNullPointerTest, ilm_replay_input_events_null_pointer) {
+    t_ilm_uint events;
+
+    EXPECT_EQ(ILM_FAILED, ilm_replayInputEvents(NULL, 1.0, &events));
+}
+
+TEST_F(IlmNullPointerTest, ilm_set_input_acceptance_batch_null_pointer) {
+    struct ilmInputAcceptance entry = {0, NULL, ILM_TRUE};
+
+    EXPECT_EQ(ILM_FAILED, ilm_setInputAcceptanceBatch(1, NULL));
+    EXPECT_EQ(ILM_FAILED, ilm_setInputAcceptanceBatch(1, &entry));
+}
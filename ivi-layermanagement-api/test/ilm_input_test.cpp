@@ -225,3 +225,231 @@ TEST_F(IlmInputTest, ilm_input_event_acceptance) {
 
     free(set_seats);
 }
+
+TEST_F(IlmInputTest, ilm_input_acceptance_of_all_surfaces) {
+    t_ilm_string set_seats[2] = {NULL, NULL};
+    t_ilm_uint num_seats = 0;
+    t_ilm_string *seats = NULL;
+
+    if (ilm_getDefaultSeat(&set_seats[0]) == ILM_FAILED) {
+        GTEST_SKIP() << "Skipping input acceptance, there isn't a default seat";
+    }
+    set_seats[1] = set_seats[0];
+
+    /* A seat named twice is accepted once, by every surface */
+    for (unsigned int i = 0; i < iviSurfaces.size(); i++)
+        ASSERT_EQ(ILM_SUCCESS, ilm_setInputAcceptanceOn(
+                                   iviSurfaces[i].surface_id, 2, set_seats));
+
+    for (unsigned int i = 0; i < iviSurfaces.size(); i++) {
+        ASSERT_EQ(ILM_SUCCESS, ilm_getInputAcceptanceOn(
+                                   iviSurfaces[i].surface_id,
+                                   &num_seats, &seats));
+        ASSERT_EQ(1u, num_seats);
+        EXPECT_STREQ(set_seats[0], seats[0]);
+        free(seats[0]);
+        free(seats);
+    }
+
+    /* Removing the seat from one surface keeps it on the others */
+    ASSERT_EQ(ILM_SUCCESS, ilm_setInputAcceptanceOn(iviSurfaces[0].surface_id,
+                                                    0, NULL));
+    for (unsigned int i = 0; i < iviSurfaces.size(); i++) {
+        ASSERT_EQ(ILM_SUCCESS, ilm_getInputAcceptanceOn(
+                                   iviSurfaces[i].surface_id,
+                                   &num_seats, &seats));
+        EXPECT_EQ(i == 0 ? 0u : 1u, num_seats);
+        for (unsigned int j = 0; j < num_seats; j++)
+            free(seats[j]);
+        free(seats);
+    }
+
+    free(set_seats[0]);
+}
+
+TEST_F(IlmInputTest, ilm_setInputAcceptanceBatch) {
+    std::vector<struct ilmInputAcceptance> entries(iviSurfaces.size());
+    t_ilm_string set_seats = NULL;
+    t_ilm_uint num_seats = 0;
+    t_ilm_string *seats = NULL;
+
+    if (ilm_getDefaultSeat(&set_seats) == ILM_FAILED) {
+        GTEST_SKIP() << "Skipping input acceptance batch, there isn't a default seat";
+    }
+
+    /* Can remove the default seat from all surfaces at once */
+    for (unsigned int i = 0; i < entries.size(); i++) {
+        entries[i].surfaceId = iviSurfaces[i].surface_id;
+        entries[i].seatName = set_seats;
+        entries[i].accepted = ILM_FALSE;
+    }
+    ASSERT_EQ(ILM_SUCCESS, ilm_setInputAcceptanceBatch(entries.size(),
+                                                       entries.data()));
+    for (unsigned int i = 0; i < entries.size(); i++) {
+        ASSERT_EQ(ILM_SUCCESS, ilm_getInputAcceptanceOn(entries[i].surfaceId,
+                                                        &num_seats, &seats));
+        EXPECT_EQ(0u, num_seats);
+        free(seats);
+    }
+
+    /* Entries are applied in order */
+    for (unsigned int i = 0; i < entries.size(); i++)
+        entries[i].accepted = (i % 2) ? ILM_TRUE : ILM_FALSE;
+    entries.push_back(entries[0]);
+    entries.back().accepted = ILM_TRUE;
+    ASSERT_EQ(ILM_SUCCESS, ilm_setInputAcceptanceBatch(entries.size(),
+                                                       entries.data()));
+    for (unsigned int i = 0; i < iviSurfaces.size(); i++) {
+        ASSERT_EQ(ILM_SUCCESS, ilm_getInputAcceptanceOn(entries[i].surfaceId,
+                                                        &num_seats, &seats));
+        if (i % 2 || i == 0) {
+            ASSERT_EQ(1u, num_seats);
+            EXPECT_STREQ(set_seats, seats[0]);
+            free(seats[0]);
+        } else {
+            EXPECT_EQ(0u, num_seats);
+        }
+        free(seats);
+    }
+
+    /* Nothing is applied if a seat does not exist */
+    entries[1].seatName = "not-a-seat";
+    EXPECT_EQ(ILM_FAILED, ilm_setInputAcceptanceBatch(entries.size(),
+                                                      entries.data()));
+
+    free(set_seats);
+}
+
+TEST_F(IlmInputTest, ilm_input_acceptance_of_new_surfaces) {
+    struct ilmInputAcceptance entries[2];
+    t_ilm_string default_seat = NULL;
+    t_ilm_uint num_seats = 0;
+    t_ilm_string *seats = NULL;
+
+    if (ilm_getDefaultSeat(&default_seat) == ILM_FAILED) {
+        GTEST_SKIP() << "Skipping input acceptance, there isn't a default seat";
+    }
+
+    /* A surface created again accepts the default seat again */
+    ivi_surface_destroy(iviSurfaces[0].surface);
+    iviSurfaces[0].surface = ivi_application_surface_create(
+        iviApp, iviSurfaces[0].surface_id, wlSurfaces[0]);
+    wl_display_flush(wlDisplay);
+
+    for (unsigned int i = 0; i < iviSurfaces.size(); i++) {
+        ASSERT_EQ(ILM_SUCCESS, ilm_getInputAcceptanceOn(
+                                   iviSurfaces[i].surface_id,
+                                   &num_seats, &seats));
+        ASSERT_EQ(1u, num_seats);
+        EXPECT_STREQ(default_seat, seats[0]);
+        free(seats[0]);
+        free(seats);
+    }
+
+    /* A change undone within one batch leaves the acceptance unchanged */
+    entries[0].surfaceId = iviSurfaces[1].surface_id;
+    entries[0].seatName = default_seat;
+    entries[0].accepted = ILM_FALSE;
+    entries[1] = entries[0];
+    entries[1].accepted = ILM_TRUE;
+    ASSERT_EQ(ILM_SUCCESS, ilm_setInputAcceptanceBatch(2, entries));
+    ASSERT_EQ(ILM_SUCCESS, ilm_getInputAcceptanceOn(iviSurfaces[1].surface_id,
+                                                    &num_seats, &seats));
+    ASSERT_EQ(1u, num_seats);
+    EXPECT_STREQ(default_seat, seats[0]);
+    free(seats[0]);
+    free(seats);
+
+    free(default_seat);
+}
+
+TEST_F(IlmInputTest, ilm_getInputLatencyStats) {
+    t_ilm_string seat = NULL;
+    const ilmInputDevice devices[] = {
+        ILM_INPUT_DEVICE_KEYBOARD,
+        ILM_INPUT_DEVICE_POINTER,
+        ILM_INPUT_DEVICE_TOUCH
+    };
+
+    if (ilm_getDefaultSeat(&seat) == ILM_FAILED) {
+        GTEST_SKIP() << "Skipping input latency, there isn't a default seat";
+    }
+
+    for (unsigned int i = 0; i < sizeof(devices) / sizeof(devices[0]); i++) {
+        struct ilmInputLatencyStatistics stats;
+        t_ilm_uint total = 0;
+
+        ASSERT_EQ(ILM_SUCCESS, ilm_getInputLatencyStats(seat, devices[i],
+                                                        &stats));
+        for (unsigned int j = 0; j < ILM_INPUT_LATENCY_BUCKETS; j++)
+            total += stats.buckets[j];
+
+        EXPECT_EQ(stats.count, total);
+        EXPECT_LE(stats.meanLatency, stats.maxLatency);
+    }
+
+    free(seat);
+}
+
+TEST_F(IlmInputTest, ilm_replayInputEvents) {
+    const char *trace = ILM_TEST_DATA_DIR "/input-replay.ivir";
+    t_ilm_surface surface = iviSurfaces[0].surface_id;
+    t_ilm_string default_seat = NULL;
+    t_ilm_layer layer = 0xbeef;
+    t_ilm_uint events = 0;
+    t_ilm_uint timed_events;
+    t_ilm_uint screen = 0;
+    t_ilm_surface *surfaceIDs;
+    ilmInputDevice *bitmasks;
+    ilmInputDevice capabilities = 0;
+    t_ilm_uint num_ids;
+    bool found = false;
+
+    if (ilm_getDefaultSeat(&default_seat) == ILM_FAILED) {
+        GTEST_SKIP() << "Skipping input replay, there isn't a default seat";
+    }
+
+    /* needs input-replay=true in the [ivi-shell] section of weston.ini;
+     * the trace moves the pointer of seat "replay" over this surface, which
+     * is replayed on the default seat as there is no seat of that name */
+    ASSERT_EQ(ILM_SUCCESS, ilm_layerCreateWithDimension(&layer, 800, 480));
+    ASSERT_EQ(ILM_SUCCESS, ilm_layerSetVisibility(layer, ILM_TRUE));
+    ASSERT_EQ(ILM_SUCCESS, ilm_layerSetRenderOrder(layer, &surface, 1));
+    ASSERT_EQ(ILM_SUCCESS, ilm_surfaceSetDestinationRectangle(surface, 0, 0,
+                                                              200, 200));
+    ASSERT_EQ(ILM_SUCCESS, ilm_surfaceSetVisibility(surface, ILM_TRUE));
+    ASSERT_EQ(ILM_SUCCESS, ilm_displaySetRenderOrder(screen, &layer, 1));
+    ASSERT_EQ(ILM_SUCCESS, ilm_commitChanges());
+
+    ASSERT_EQ(ILM_SUCCESS, ilm_getInputDeviceCapabilities(default_seat,
+                                                          &capabilities));
+    free(default_seat);
+    if (!(capabilities & ILM_INPUT_DEVICE_POINTER)) {
+        GTEST_SKIP() << "Skipping input replay, the default seat has no pointer";
+    }
+
+    /* All surfaces accept the default seat, the replayed motion focuses
+     * this one */
+    ASSERT_EQ(ILM_SUCCESS, ilm_replayInputEvents(trace, 4.0, &events));
+    EXPECT_GT(events, 0u);
+
+    ASSERT_EQ(ILM_SUCCESS, ilm_getInputFocus(&surfaceIDs, &bitmasks, &num_ids));
+    for (unsigned int i = 0; i < num_ids; i++) {
+        if (surfaceIDs[i] == surface) {
+            EXPECT_EQ(ILM_INPUT_DEVICE_POINTER,
+                      bitmasks[i] & ILM_INPUT_DEVICE_POINTER);
+            found = true;
+        }
+    }
+    free(surfaceIDs);
+    free(bitmasks);
+    EXPECT_TRUE(found);
+
+    /* Replaying all at once injects the same events */
+    timed_events = events;
+    ASSERT_EQ(ILM_SUCCESS, ilm_replayInputEvents(trace, 0, &events));
+    EXPECT_EQ(timed_events, events);
+
+    /* An invalid trace is not replayed */
+    EXPECT_EQ(ILM_FAILED, ilm_replayInputEvents("/dev/null", 0, &events));
+}
@@ -146,7 +146,7 @@ COMMAND("get screen|layer|surface <id>")
 }
 
 //=============================================================================
-COMMAND("dump screen|surface <id> to <file>")
+COMMAND("dump screen|layer|surface <id> to <file>")
 //=============================================================================
 {
     if (input->contains("screen"))
@@ -160,6 +160,17 @@ COMMAND("dump screen|surface <id> to <file>")
             return;
         }
     }
+    else if (input->contains("layer"))
+    {
+        ilmErrorTypes callResult = ilm_takeLayerScreenshot(input->getString("file").c_str(),
+                                                              input->getUint("id"));
+        if (ILM_SUCCESS != callResult)
+        {
+            cout << "LayerManagerService returned: " << ILM_ERROR_STRING(callResult) << "\n";
+            cout << "Failed to take screenshot of layer with ID " << input->getUint("id") << "\n";
+            return;
+        }
+    }
     else if (input->contains("surface"))
     {
         ilmErrorTypes callResult = ilm_takeSurfaceScreenshot(input->getString("file").c_str(),
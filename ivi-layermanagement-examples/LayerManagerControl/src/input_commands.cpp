@@ -250,3 +250,24 @@ COMMAND3(55,"get surface <surfaceid> input acceptance")
     }
     free(array);
 }
+
+//=============================================================================
+COMMAND3(56,"replay input events <file> at speed <speed>")
+//=============================================================================
+{
+    t_ilm_uint events = 0;
+    string file = input->getString("file");
+    double speed = input->getDouble("speed");
+
+    ilmErrorTypes callResult = ilm_replayInputEvents(file.c_str(), speed,
+                                                     &events);
+    if (ILM_SUCCESS != callResult)
+    {
+        cout << "LayerManagerService returned: " << ILM_ERROR_STRING(callResult)
+             << endl;
+        cout << "Failed to replay input events of " << file << endl;
+        return;
+    }
+
+    cout << "Replayed " << events << " input events" << endl;
+}
@@ -232,6 +232,12 @@ void printSurfaceProperties(unsigned int surfaceid, const char* prefix)
     cout << prefix << "- visibility:         " << p.visibility << "\n";
 
     cout << prefix << "- frame counter:      " << p.frameCounter << "\n";
+    cout << prefix << "- commit rate:        " << p.commitRate << " fps\n";
+    cout << prefix << "- commit interval:    min=" << p.minCommitInterval
+            << "us, avg=" << p.avgCommitInterval << "us, max="
+            << p.maxCommitInterval << "us, p99=" << p.p99CommitInterval << "us\n";
+    cout << prefix << "- superseded commits: " << p.supersededCommits << "\n";
+    cout << prefix << "- last commit:        " << p.lastCommitTime << "ms\n";
 
     cout << prefix << "- on layer:           ";
     int layerCount = 0;
@@ -0,0 +1,70 @@
+/*
+ * Copyright (C) 2017 Advanced Driver Information Technology Joint Venture GmbH
+ *
+ * Permission to use, copy, modify, distribute, and sell this software and
+ * its documentation for any purpose is hereby granted without fee, provided
+ * that the above copyright notice appear in all copies and that both that
+ * copyright notice and this permission notice appear in supporting
+ * documentation, and that the name of the copyright holders not be used in
+ * advertising or publicity pertaining to distribution of the software
+ * without specific, written prior permission.  The copyright holders make
+ * no representations about the suitability of this software for any
+ * purpose.  It is provided "as is" without express or implied warranty.
+ *
+ * THE COPYRIGHT HOLDERS DISCLAIM ALL WARRANTIES WITH REGARD TO THIS
+ * SOFTWARE, INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND
+ * FITNESS, IN NO EVENT SHALL THE COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * SPECIAL, INDIRECT OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER
+ * RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF
+ * CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+ * CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#ifndef IVI_INPUT_RECORD_H
+#define IVI_INPUT_RECORD_H
+
+#include <stdint.h>
+
+/* Format of the input traces written by ivi-input-controller
+ *
+ * A trace starts with an ivi_input_record_header, followed by records of
+ * record_size bytes. A seat record is followed by the name of the seat,
+ * zero padded to a multiple of 8 bytes. It assigns the next seat index,
+ * starting at 0, which later records refer to. All members are in host
+ * byte order, positions are wl_fixed_t in the global coordinate space of
+ * the compositor.
+ */
+
+#define IVI_INPUT_RECORD_MAGIC   0x52495649 /* "IVIR" */
+#define IVI_INPUT_RECORD_VERSION 1
+
+struct ivi_input_record_header {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t record_size;
+    uint32_t reserved;
+};
+
+enum ivi_input_record_type {
+    IVI_INPUT_RECORD_SEAT = 1,          /* length of the name */
+    IVI_INPUT_RECORD_KEY,               /* key, state */
+    IVI_INPUT_RECORD_POINTER_MOTION,    /* x, y */
+    IVI_INPUT_RECORD_BUTTON,            /* button, state */
+    IVI_INPUT_RECORD_AXIS,              /* axis, value as wl_fixed_t */
+    IVI_INPUT_RECORD_AXIS_SOURCE,       /* source */
+    IVI_INPUT_RECORD_POINTER_FRAME,
+    IVI_INPUT_RECORD_TOUCH_DOWN,        /* touch id, x, y */
+    IVI_INPUT_RECORD_TOUCH_UP,          /* touch id */
+    IVI_INPUT_RECORD_TOUCH_MOTION,      /* touch id, x, y */
+    IVI_INPUT_RECORD_TOUCH_FRAME,
+    IVI_INPUT_RECORD_TOUCH_CANCEL,
+};
+
+struct ivi_input_record {
+    uint64_t time_us;           /* timestamp of the event */
+    uint16_t type;
+    uint16_t seat;
+    int32_t args[5];
+};
+
+#endif /* IVI_INPUT_RECORD_H */
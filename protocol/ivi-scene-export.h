@@ -0,0 +1,125 @@
+/*
+ * Copyright (C) 2017 Advanced Driver Information Technology Joint Venture GmbH
+ *
+ * Permission to use, copy, modify, distribute, and sell this software and
+ * its documentation for any purpose is hereby granted without fee, provided
+ * that the above copyright notice appear in all copies and that both that
+ * copyright notice and this permission notice appear in supporting
+ * documentation, and that the name of the copyright holders not be used in
+ * advertising or publicity pertaining to distribution of the software
+ * without specific, written prior permission.  The copyright holders make
+ * no representations about the suitability of this software for any
+ * purpose.  It is provided "as is" without express or implied warranty.
+ *
+ * THE COPYRIGHT HOLDERS DISCLAIM ALL WARRANTIES WITH REGARD TO THIS
+ * SOFTWARE, INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND
+ * FITNESS, IN NO EVENT SHALL THE COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * SPECIAL, INDIRECT OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER
+ * RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF
+ * CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+ * CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#ifndef IVI_SCENE_EXPORT_H
+#define IVI_SCENE_EXPORT_H
+
+#include <stdint.h>
+
+/* Layout of the shared memory region passed with ivi_wm.scene_export
+ *
+ * The region starts with an ivi_scene_export_header, followed by two
+ * snapshot buffers of buffer_size bytes each. The compositor writes a new
+ * snapshot into the buffer which is not current, then stores its index
+ * in current. Every buffer starts with a sequence counter, which is odd
+ * while the compositor writes into it.
+ *
+ * A reader loads current, loads seq of that buffer and retries while it
+ * is odd, copies the snapshot, and retries if seq changed meanwhile. The
+ * counters must be accessed atomically, with acquire semantics.
+ *
+ * When only frame counters of surfaces changed, the compositor writes them
+ * into the current buffer under its sequence counter, without a new
+ * generation.
+ *
+ * A snapshot is an ivi_scene_export_snapshot followed by screen_count
+ * screens, layer_count layers, surface_count surfaces and id_count ids.
+ * The render order of a screen or layer is the range of ids starting at
+ * its first_id. All members are 32 bit wide in host byte order.
+ */
+
+#define IVI_SCENE_EXPORT_MAGIC   0x53495649 /* "IVIS" */
+#define IVI_SCENE_EXPORT_VERSION 1
+
+struct ivi_scene_export_header {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t buffer_offset;     /* offset of the first buffer */
+    uint32_t buffer_size;
+    uint32_t current;           /* index of the latest complete buffer */
+    uint32_t reserved[3];
+};
+
+struct ivi_scene_export_snapshot {
+    uint32_t seq;
+    uint32_t generation;        /* incremented for every new snapshot */
+    uint32_t screen_count;
+    uint32_t layer_count;
+    uint32_t surface_count;
+    uint32_t id_count;
+    uint32_t truncated;         /* 1 if the scene did not fit into the buffer */
+    uint32_t reserved;
+};
+
+struct ivi_scene_export_screen {
+    uint32_t id;
+    int32_t width;
+    int32_t height;
+    uint32_t layer_count;
+    uint32_t first_id;
+};
+
+struct ivi_scene_export_layer {
+    uint32_t id;
+    int32_t source_x;
+    int32_t source_y;
+    int32_t source_width;
+    int32_t source_height;
+    int32_t dest_x;
+    int32_t dest_y;
+    int32_t dest_width;
+    int32_t dest_height;
+    int32_t opacity;            /* wl_fixed_t */
+    uint32_t visibility;
+    uint32_t surface_count;
+    uint32_t first_id;
+};
+
+struct ivi_scene_export_surface {
+    uint32_t id;
+    int32_t source_x;
+    int32_t source_y;
+    int32_t source_width;
+    int32_t source_height;
+    int32_t dest_x;
+    int32_t dest_y;
+    int32_t dest_width;
+    int32_t dest_height;
+    int32_t opacity;            /* wl_fixed_t */
+    uint32_t visibility;
+    int32_t width;              /* size of the content */
+    int32_t height;
+    uint32_t frame_count;
+    int32_t pid;
+    uint32_t occluded;
+};
+
+static inline struct ivi_scene_export_snapshot *
+ivi_scene_export_buffer(struct ivi_scene_export_header *header,
+                        uint32_t index)
+{
+    return (struct ivi_scene_export_snapshot *)
+        ((char *)header + header->buffer_offset +
+         index * header->buffer_size);
+}
+
+#endif /* IVI_SCENE_EXPORT_H */
@@ -1,3 +1,8 @@
 #pragma once
 
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
 #define MODULEDIR "@LIBWESTON_LIBDIR@/weston"
+#cmakedefine HAVE_MEMFD_CREATE
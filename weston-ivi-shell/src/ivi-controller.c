@@ -35,11 +35,15 @@
 #include <string.h>
 
 #include <sys/mman.h>
+#include <pixman.h>
 
 #include <weston.h>
 #include <libweston/desktop.h>
 #include "ivi-wm-server-protocol.h"
 #include "ivi-controller.h"
+#include "ivi-frame-policy.h"
+#include "ivi-scene-export.h"
+#include "ivi-trace.h"
 
 #include "wayland-util.h"
 
@@ -48,6 +52,18 @@
 #define IVI_CLIENT_DEBUG_SCOPES_ENV_NAME "IVI_CLIENT_DEBUG_STREAM_NAMES"
 #define IVI_CLIENT_ENABLE_CURSOR_ENV_NAME "IVI_CLIENT_ENABLE_CURSOR"
 
+#define IVI_HASH_TABLE_INITIAL_SIZE 64
+#define IVI_HASH_TABLE_MAX_LOAD 2
+
+#define IVI_SCREEN_FRAME_TIME_BUCKETS 6
+
+#define IVI_SCREENSHOT_QUEUE_DEPTH 4
+
+#define IVI_SCENE_EXPORT_BUFFER_SIZE (64 * 1024)
+
+/* requests of ivi_wm counted per opcode */
+#define IVI_WM_REQUEST_OPCODES 32
+
 struct ivilayer;
 struct iviscreen;
 
@@ -55,15 +71,50 @@ struct notification {
     struct wl_list link;
     struct wl_resource *resource;
     struct wl_list layout_link;
+    /* Only one of them is set, depending on the notification list
+     * this notification is part of */
+    struct ivisurface *ivisurf;
+    struct ivilayer *ivilayer;
+    /* Changes accumulated since the last flush of the controller */
+    struct wl_list dirty_link;
+    uint32_t pending_mask;
 };
 
 struct ivilayer {
     struct wl_list link;
+    struct ivi_hash_entry ptr_entry;
     struct ivishell *shell;
     struct ivi_layout_layer *layout_layer;
     const struct ivi_layout_layer_properties *prop;
     struct wl_listener property_changed;
     struct wl_list notification_list;
+
+    /* IVI_NOTIFICATION_* bits of the properties requested by controllers
+     * since the last commit */
+    uint32_t pending_mask;
+    /* in ivishell::pending_layers while pending_mask is set */
+    struct wl_list pending_link;
+};
+
+/* Upper bounds of the frame time histogram buckets in milliseconds, the
+ * last bucket takes all longer frame times */
+static const uint32_t frame_time_bucket_ms[IVI_SCREEN_FRAME_TIME_BUCKETS - 1] = {
+    8, 17, 34, 50, 100
+};
+
+struct ivi_repaint_stats {
+    uint32_t frames;
+    uint32_t missed_vblanks;
+    /* from the submission of a frame until its presentation */
+    uint64_t present_delay_sum_us;
+    uint32_t present_delay_max_us;
+    uint32_t frame_time_hist[IVI_SCREEN_FRAME_TIME_BUCKETS];
+    /* time the last repaint was submitted at, it waits for its
+     * presentation */
+    int64_t repaint_us;
+    bool repaint_pending;
+    /* presentation time of the last presented frame */
+    int64_t presented_us;
 };
 
 struct iviscreen {
@@ -72,6 +123,8 @@ struct iviscreen {
     uint32_t id_screen;
     struct weston_output *output;
     struct wl_list resource_list;
+    struct wl_listener output_frame;
+    struct ivi_repaint_stats repaint_stats;
 };
 
 struct ivicontroller {
@@ -83,6 +136,33 @@ struct ivicontroller {
 
     struct wl_list layer_notifications;
     struct wl_list surface_notifications;
+    struct wl_list dirty_notifications;
+
+    /* wl_shm format of following surface and layer screenshots */
+    uint32_t screenshot_format;
+
+    /* requests dropped, because they did not change anything */
+    uint32_t skipped_requests;
+    uint32_t commits;
+    uint32_t skipped_commits;
+
+    /* requests received and events sent, counted by the protocol logger */
+    uint32_t requests[IVI_WM_REQUEST_OPCODES];
+    uint32_t events;
+    uint64_t event_bytes;
+
+    /* commits applied in the second starting at commit_window_ms, and in
+     * the second before */
+    int64_t commit_window_ms;
+    uint32_t window_commits;
+    uint32_t commit_rate;
+
+    /* commits beyond the commit budget are deferred to the next second,
+     * further ones are coalesced with the deferred one */
+    bool commit_deferred;
+    uint32_t deferred_commits;
+    uint32_t coalesced_commits;
+    struct wl_event_source *commit_timer;
 };
 
 struct ivi_screenshooter {
@@ -90,20 +170,69 @@ struct ivi_screenshooter {
     struct weston_output *output;
 };
 
+/* A surface, thumbnail or layer screenshot request waiting in
+ * ivishell::screenshot_queue */
+struct ivi_surface_screenshot {
+    struct wl_list link;
+    struct ivishell *shell;
+    struct wl_resource *screenshot;
+    struct wl_resource *buffer_resource;
+    struct wl_listener buffer_destroy_listener;
+    void (*dump)(struct ivi_surface_screenshot *state);
+    /* set by dump to be queued again for the rest of the request */
+    bool incomplete;
+    uint32_t format;
+    uint32_t surface_id;
+    /* layer_screenshot only */
+    uint32_t layer_id;
+    /* surfaces_thumbnail only */
+    struct wl_array surface_ids;
+    int32_t thumb_width;
+    int32_t thumb_height;
+    /* surfaces dumped so far and their entries of thumbnail_layout */
+    uint32_t thumb_index;
+    struct wl_array thumb_layout;
+};
+
 struct screen_id_info {
     char *screen_name;
     uint32_t screen_id;
 };
 
+static struct notification *
+create_notification(struct wl_resource *resource,
+                    struct ivisurface *ivisurf, struct ivilayer *ivilayer)
+{
+    struct notification *noti;
+
+    noti = calloc(1, sizeof *noti);
+    if (noti == NULL)
+        return NULL;
+
+    noti->resource = resource;
+    noti->ivisurf = ivisurf;
+    noti->ivilayer = ivilayer;
+    wl_list_init(&noti->dirty_link);
+
+    return noti;
+}
+
+static void
+destroy_notification(struct notification *noti)
+{
+    wl_list_remove(&noti->dirty_link);
+    wl_list_remove(&noti->layout_link);
+    wl_list_remove(&noti->link);
+    free(noti);
+}
+
 static void
 clear_notification_list(struct wl_list* notification_list)
 {
     struct notification *noti, *next;
 
     wl_list_for_each_safe(noti, next, notification_list, link) {
-         wl_list_remove(&noti->layout_link);
-         wl_list_remove(&noti->link);
-         free(noti);
+         destroy_notification(noti);
     }
 }
 
@@ -120,6 +249,9 @@ unbind_resource_controller(struct wl_resource *resource)
 
     wl_list_remove(&controller->link);
 
+    if (controller->commit_timer)
+        wl_event_source_remove(controller->commit_timer);
+
     clear_notification_list(&controller->layer_notifications);
     clear_notification_list(&controller->surface_notifications);
 
@@ -127,29 +259,150 @@ unbind_resource_controller(struct wl_resource *resource)
     controller = NULL;
 }
 
-static struct ivisurface*
-get_surface(struct wl_list *list_surf, struct ivi_layout_surface *layout_surface)
+static int
+hash_table_init(struct ivi_hash_table *table)
 {
-    struct ivisurface *ivisurf = NULL;
+    uint32_t i;
 
-    wl_list_for_each(ivisurf, list_surf, link) {
-        if (layout_surface == ivisurf->layout_surface) {
-            return ivisurf;
-        }
+    table->buckets = calloc(IVI_HASH_TABLE_INITIAL_SIZE,
+                            sizeof *table->buckets);
+    if (table->buckets == NULL)
+        return -1;
+
+    table->size = IVI_HASH_TABLE_INITIAL_SIZE;
+    table->count = 0;
+
+    for (i = 0; i < table->size; i++)
+        wl_list_init(&table->buckets[i]);
+
+    return 0;
+}
+
+static void
+hash_table_release(struct ivi_hash_table *table)
+{
+    free(table->buckets);
+    table->buckets = NULL;
+    table->size = 0;
+    table->count = 0;
+}
+
+/* Doubles the number of buckets. If the allocation fails the table
+ * keeps its current size, lookups stay correct but chains get longer.
+ */
+static void
+hash_table_grow(struct ivi_hash_table *table)
+{
+    struct ivi_hash_entry *entry, *next;
+    struct wl_list *buckets;
+    uint32_t size = table->size * 2;
+    uint32_t i;
+
+    buckets = calloc(size, sizeof *buckets);
+    if (buckets == NULL) {
+        weston_log("ivi-controller: no memory to grow hash table\n");
+        return;
     }
 
-    return NULL;
+    for (i = 0; i < size; i++)
+        wl_list_init(&buckets[i]);
+
+    for (i = 0; i < table->size; i++) {
+        wl_list_for_each_safe(entry, next, &table->buckets[i], link)
+            wl_list_insert(&buckets[entry->hash & (size - 1)], &entry->link);
+    }
+
+    free(table->buckets);
+    table->buckets = buckets;
+    table->size = size;
+}
+
+static void
+hash_table_insert(struct ivi_hash_table *table,
+                  struct ivi_hash_entry *entry, uint32_t hash)
+{
+    if (table->count >= table->size * IVI_HASH_TABLE_MAX_LOAD)
+        hash_table_grow(table);
+
+    entry->hash = hash;
+    wl_list_insert(ivi_hash_bucket(table, hash), &entry->link);
+    table->count++;
+}
+
+static void
+hash_table_remove(struct ivi_hash_table *table, struct ivi_hash_entry *entry)
+{
+    wl_list_remove(&entry->link);
+    wl_list_init(&entry->link);
+    table->count--;
 }
 
+static int
+init_shell_indexes(struct ivishell *shell)
+{
+    if (hash_table_init(&shell->surface_ptr_index) < 0)
+        goto err;
+
+    if (hash_table_init(&shell->surface_id_index) < 0)
+        goto err;
+
+    if (hash_table_init(&shell->layer_ptr_index) < 0)
+        goto err;
+
+    return 0;
+
+err:
+    hash_table_release(&shell->surface_ptr_index);
+    hash_table_release(&shell->surface_id_index);
+    hash_table_release(&shell->layer_ptr_index);
+    return -1;
+}
+
+static void
+release_shell_indexes(struct ivishell *shell)
+{
+    hash_table_release(&shell->surface_ptr_index);
+    hash_table_release(&shell->surface_id_index);
+    hash_table_release(&shell->layer_ptr_index);
+}
+
+static struct ivi_trace_span
+trace_request_begin(struct wl_resource *resource, const char *func)
+{
+    struct ivicontroller *ctrl = wl_resource_get_user_data(resource);
+    struct ivi_trace_span span;
+
+    /* the name of the handler without the controller_ prefix */
+    ivi_trace_span_begin(ctrl->shell->trace, &span, "request",
+                         func + strlen("controller_"), resource);
+
+    return span;
+}
+
+static void
+trace_request_end(struct ivi_trace_span *span)
+{
+    ivi_trace_span_end(span, NULL);
+}
+
+/* Traces the request handler it is placed in until the handler returns */
+#define TRACE_REQUEST(resource) \
+    struct ivi_trace_span trace_span \
+        __attribute__((cleanup(trace_request_end))) = \
+        trace_request_begin((resource), __func__)
+
 static struct ivilayer*
-get_layer(struct wl_list *list_layer, struct ivi_layout_layer *layout_layer)
+get_layer(struct ivishell *shell, struct ivi_layout_layer *layout_layer)
 {
-    struct ivilayer *ivilayer = NULL;
+    struct ivi_hash_entry *entry;
+    struct ivilayer *ivilayer;
+    uint32_t hash = ivi_hash_ptr(layout_layer);
 
-    wl_list_for_each(ivilayer, list_layer, link) {
-        if (layout_layer == ivilayer->layout_layer) {
+    wl_list_for_each(entry,
+                     ivi_hash_bucket(&shell->layer_ptr_index, hash), link) {
+        ivilayer = wl_container_of(entry, ivilayer, ptr_entry);
+        if (ivilayer->layout_layer == layout_layer)
             return ivilayer;
-        }
     }
 
     return NULL;
@@ -204,6 +457,384 @@ send_surface_event(struct ivicontroller * ctrl,
     }
 }
 
+static void
+flush_notifications(void *data);
+
+static void
+queue_notification(struct notification *noti, uint32_t mask)
+{
+    struct ivicontroller *ctrl = wl_resource_get_user_data(noti->resource);
+    struct ivishell *shell = ctrl->shell;
+    struct wl_event_loop *loop;
+
+    if (mask == 0)
+        return;
+
+    if (noti->pending_mask == 0)
+        wl_list_insert(ctrl->dirty_notifications.prev, &noti->dirty_link);
+
+    noti->pending_mask |= mask;
+
+    if (shell->notification_idle == NULL) {
+        loop = wl_display_get_event_loop(shell->compositor->wl_display);
+        shell->notification_idle =
+            wl_event_loop_add_idle(loop, flush_notifications, shell);
+    }
+}
+
+static int
+create_scene_export_file(size_t size)
+{
+    const char templatename[] = "/ivi-scene-export-XXXXXX";
+    const char *runtimedir;
+    char *tmpname;
+    int fd;
+
+#ifdef HAVE_MEMFD_CREATE
+    fd = memfd_create("ivi-scene-export", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+    if (fd >= 0) {
+        if (ftruncate(fd, size) < 0) {
+            close(fd);
+            return -1;
+        }
+#ifdef F_ADD_SEALS
+        fcntl(fd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW);
+#endif
+        return fd;
+    }
+#endif
+
+    runtimedir = getenv("XDG_RUNTIME_DIR");
+    if (runtimedir == NULL)
+        return -1;
+
+    tmpname = malloc(strlen(runtimedir) + sizeof(templatename));
+    if (tmpname == NULL)
+        return -1;
+
+    fd = mkostemp(strcat(strcpy(tmpname, runtimedir), templatename),
+                  O_CLOEXEC);
+    if (fd < 0) {
+        free(tmpname);
+        return -1;
+    }
+
+    unlink(tmpname);
+    free(tmpname);
+
+    if (ftruncate(fd, size) < 0) {
+        close(fd);
+        return -1;
+    }
+
+    return fd;
+}
+
+static void
+write_scene_snapshot(struct ivishell *shell,
+                     struct ivi_scene_export_snapshot *snap, uint32_t size)
+{
+    const struct ivi_layout_interface *lyt = shell->interface;
+    struct ivi_scene_export_screen *screens;
+    struct ivi_scene_export_layer *layers;
+    struct ivi_scene_export_surface *surfaces, *s;
+    struct ivi_layout_layer **layer_array = NULL;
+    struct ivi_layout_surface **surface_array = NULL;
+    struct iviscreen *iviscrn;
+    struct ivilayer *ivilayer;
+    struct ivisurface *ivisurf;
+    struct weston_surface *surface;
+    const char *end = (const char *)snap + size;
+    uint32_t *ids;
+    uint32_t n_screens, n_layers, n_surfaces, max_ids;
+    uint32_t i, id_count = 0;
+    int32_t length, j;
+
+    snap->truncated = 0;
+
+    /* the objects take what fits, their render orders the rest */
+    n_screens = wl_list_length(&shell->list_screen);
+    n_layers = wl_list_length(&shell->list_layer);
+    n_surfaces = wl_list_length(&shell->list_surface);
+
+    screens = (struct ivi_scene_export_screen *)(snap + 1);
+    if ((size_t)(end - (const char *)screens) / sizeof *screens < n_screens) {
+        n_screens = (end - (const char *)screens) / sizeof *screens;
+        snap->truncated = 1;
+    }
+    layers = (struct ivi_scene_export_layer *)(screens + n_screens);
+    if ((size_t)(end - (const char *)layers) / sizeof *layers < n_layers) {
+        n_layers = (end - (const char *)layers) / sizeof *layers;
+        snap->truncated = 1;
+    }
+    surfaces = (struct ivi_scene_export_surface *)(layers + n_layers);
+    if ((size_t)(end - (const char *)surfaces) / sizeof *surfaces < n_surfaces) {
+        n_surfaces = (end - (const char *)surfaces) / sizeof *surfaces;
+        snap->truncated = 1;
+    }
+    ids = (uint32_t *)(surfaces + n_surfaces);
+    max_ids = (end - (const char *)ids) / sizeof *ids;
+
+    i = 0;
+    wl_list_for_each_reverse(iviscrn, &shell->list_screen, link) {
+        if (i == n_screens)
+            break;
+
+        screens[i].id = iviscrn->id_screen;
+        screens[i].width = iviscrn->output->width;
+        screens[i].height = iviscrn->output->height;
+        screens[i].first_id = id_count;
+        screens[i].layer_count = 0;
+
+        if (lyt->get_layers_on_screen(iviscrn->output, &length,
+                                      &layer_array) == IVI_SUCCEEDED) {
+            for (j = 0; j < length; j++) {
+                if (id_count == max_ids) {
+                    snap->truncated = 1;
+                    break;
+                }
+                ids[id_count++] = lyt->get_id_of_layer(layer_array[j]);
+                screens[i].layer_count++;
+            }
+            free(layer_array);
+            layer_array = NULL;
+        }
+        i++;
+    }
+
+    i = 0;
+    wl_list_for_each_reverse(ivilayer, &shell->list_layer, link) {
+        if (i == n_layers)
+            break;
+
+        layers[i].id = lyt->get_id_of_layer(ivilayer->layout_layer);
+        layers[i].source_x = ivilayer->prop->source_x;
+        layers[i].source_y = ivilayer->prop->source_y;
+        layers[i].source_width = ivilayer->prop->source_width;
+        layers[i].source_height = ivilayer->prop->source_height;
+        layers[i].dest_x = ivilayer->prop->dest_x;
+        layers[i].dest_y = ivilayer->prop->dest_y;
+        layers[i].dest_width = ivilayer->prop->dest_width;
+        layers[i].dest_height = ivilayer->prop->dest_height;
+        layers[i].opacity = ivilayer->prop->opacity;
+        layers[i].visibility = ivilayer->prop->visibility;
+        layers[i].first_id = id_count;
+        layers[i].surface_count = 0;
+
+        if (lyt->get_surfaces_on_layer(ivilayer->layout_layer, &length,
+                                       &surface_array) == IVI_SUCCEEDED) {
+            for (j = 0; j < length; j++) {
+                if (id_count == max_ids) {
+                    snap->truncated = 1;
+                    break;
+                }
+                ids[id_count++] = lyt->get_id_of_surface(surface_array[j]);
+                layers[i].surface_count++;
+            }
+            free(surface_array);
+            surface_array = NULL;
+        }
+        i++;
+    }
+
+    i = 0;
+    wl_list_for_each_reverse(ivisurf, &shell->list_surface, link) {
+        if (i == n_surfaces)
+            break;
+
+        s = &surfaces[i++];
+        s->id = ivisurf->id_surface;
+        s->source_x = ivisurf->prop->source_x;
+        s->source_y = ivisurf->prop->source_y;
+        s->source_width = ivisurf->prop->source_width;
+        s->source_height = ivisurf->prop->source_height;
+        s->dest_x = ivisurf->prop->dest_x;
+        s->dest_y = ivisurf->prop->dest_y;
+        s->dest_width = ivisurf->prop->dest_width;
+        s->dest_height = ivisurf->prop->dest_height;
+        s->opacity = ivisurf->prop->opacity;
+        s->visibility = ivisurf->prop->visibility;
+        s->frame_count = ivisurf->frame_count;
+        s->occluded = ivisurf->occluded;
+        s->width = 0;
+        s->height = 0;
+        s->pid = ivisurf->pid;
+
+        surface = lyt->surface_get_weston_surface(ivisurf->layout_surface);
+        if (surface) {
+            s->width = surface->width;
+            s->height = surface->height;
+        }
+    }
+
+    snap->screen_count = n_screens;
+    snap->layer_count = n_layers;
+    snap->surface_count = n_surfaces;
+    snap->id_count = id_count;
+}
+
+/* Only the frame counters changed since the last snapshot. They are
+ * written into the current buffer, readers copying it meanwhile see the
+ * sequence counter change and retry.
+ */
+static void
+update_scene_frame_counts(struct ivishell *shell)
+{
+    struct ivi_scene_export_header *header = shell->scene_export;
+    struct ivi_scene_export_snapshot *snap;
+    struct ivi_scene_export_surface *surfaces;
+    struct ivisurface *ivisurf;
+    uint32_t i = 0, seq;
+
+    snap = ivi_scene_export_buffer(header, header->current);
+    surfaces = (struct ivi_scene_export_surface *)
+        ((struct ivi_scene_export_screen *)(snap + 1) + snap->screen_count);
+    surfaces = (struct ivi_scene_export_surface *)
+        ((struct ivi_scene_export_layer *)surfaces + snap->layer_count);
+
+    seq = snap->seq;
+    __atomic_store_n(&snap->seq, seq + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    /* the list did not change since the snapshot, else it would be
+     * written again */
+    wl_list_for_each_reverse(ivisurf, &shell->list_surface, link) {
+        if (i == snap->surface_count)
+            break;
+        if (surfaces[i].id == ivisurf->id_surface)
+            surfaces[i].frame_count = ivisurf->frame_count;
+        i++;
+    }
+
+    __atomic_store_n(&snap->seq, seq + 2, __ATOMIC_RELEASE);
+}
+
+/* Writes the scene into the buffer readers are not directed to, then
+ * directs them to it. A reader still copying the other buffer is not
+ * disturbed, unless it is slower than two snapshots.
+ */
+static void
+publish_scene(void *data)
+{
+    struct ivishell *shell = data;
+    struct ivi_scene_export_header *header = shell->scene_export;
+    struct ivi_scene_export_snapshot *snap;
+    uint32_t index, seq;
+
+    shell->scene_export_idle = NULL;
+
+    if (!shell->scene_export_dirty) {
+        update_scene_frame_counts(shell);
+        return;
+    }
+    shell->scene_export_dirty = false;
+
+    index = !header->current;
+    snap = ivi_scene_export_buffer(header, index);
+
+    seq = snap->seq;
+    __atomic_store_n(&snap->seq, seq + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    write_scene_snapshot(shell, snap, header->buffer_size);
+    snap->generation = ++shell->scene_export_generation;
+
+    __atomic_store_n(&snap->seq, seq + 2, __ATOMIC_RELEASE);
+    __atomic_store_n(&header->current, index, __ATOMIC_RELEASE);
+}
+
+/* Publish the scene once the event loop is idle, a new snapshot if the
+ * scene is dirty or the frame counters only otherwise */
+static void
+schedule_scene_export(struct ivishell *shell, bool dirty)
+{
+    struct wl_event_loop *loop;
+
+    if (shell->scene_export == NULL)
+        return;
+
+    if (dirty)
+        shell->scene_export_dirty = true;
+
+    if (shell->scene_export_idle)
+        return;
+
+    loop = wl_display_get_event_loop(shell->compositor->wl_display);
+    shell->scene_export_idle = wl_event_loop_add_idle(loop, publish_scene,
+                                                      shell);
+}
+
+/* The geometry or the render order of the scene may have changed */
+static void
+notify_scene_changed(struct ivishell *shell)
+{
+    wl_signal_emit(&shell->scene_changed_signal, shell);
+    schedule_scene_export(shell, true);
+}
+
+static int
+create_scene_export(struct ivishell *shell)
+{
+    struct ivi_scene_export_header *header;
+    uint32_t buffer_offset = (sizeof *header + 63) & ~63u;
+    uint32_t buffer_size;
+    size_t size;
+    int fd;
+
+    buffer_size = (shell->scene_export_buffer_size + 63) & ~63u;
+    if (buffer_size == 0)
+        buffer_size = IVI_SCENE_EXPORT_BUFFER_SIZE;
+
+    size = buffer_offset + 2 * (size_t)buffer_size;
+
+    fd = create_scene_export_file(size);
+    if (fd < 0) {
+        weston_log("ivi-controller: failed to create the scene export\n");
+        return -1;
+    }
+
+    header = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (header == MAP_FAILED) {
+        weston_log("ivi-controller: failed to map the scene export\n");
+        close(fd);
+        return -1;
+    }
+
+#if defined(F_ADD_SEALS) && defined(F_SEAL_FUTURE_WRITE)
+    /* readers can not map the region writable any more */
+    fcntl(fd, F_ADD_SEALS, F_SEAL_FUTURE_WRITE);
+#endif
+
+    header->magic = IVI_SCENE_EXPORT_MAGIC;
+    header->version = IVI_SCENE_EXPORT_VERSION;
+    header->buffer_offset = buffer_offset;
+    header->buffer_size = buffer_size;
+    header->current = 0;
+
+    shell->scene_export = header;
+    shell->scene_export_size = size;
+    shell->scene_export_fd = fd;
+    shell->scene_export_dirty = true;
+
+    publish_scene(shell);
+
+    return 0;
+}
+
+static void
+destroy_scene_export(struct ivishell *shell)
+{
+    if (shell->scene_export == NULL)
+        return;
+
+    if (shell->scene_export_idle)
+        wl_event_source_remove(shell->scene_export_idle);
+
+    munmap(shell->scene_export, shell->scene_export_size);
+    close(shell->scene_export_fd);
+    shell->scene_export = NULL;
+}
+
 static void
 send_surface_prop(struct wl_listener *listener, void *data)
 {
@@ -211,20 +842,19 @@ send_surface_prop(struct wl_listener *listener, void *data)
              wl_container_of(listener, ivisurf,
                     property_changed);
     (void)data;
-    enum ivi_layout_notification_mask mask;
-    struct ivicontroller *ctrl;
-    const struct ivi_layout_interface *lyt = ivisurf->shell->interface;
     struct notification *noti;
-    uint32_t surface_id;
-
-    mask = ivisurf->prop->event_mask;
-
-    surface_id = lyt->get_id_of_surface(ivisurf->layout_surface);
 
     wl_list_for_each(noti, &ivisurf->notification_list, layout_link) {
-        ctrl = wl_resource_get_user_data(noti->resource);
-        send_surface_event(ctrl, ivisurf->layout_surface, surface_id, ivisurf->prop, mask);
+        queue_notification(noti, ivisurf->prop->event_mask);
     }
+
+    /* committed, maybe by another module of the compositor */
+    ivisurf->pending_mask = 0;
+    wl_list_remove(&ivisurf->pending_link);
+    wl_list_init(&ivisurf->pending_link);
+
+    ivi_frame_policy_schedule_update(ivisurf->shell->frame_policy);
+    notify_scene_changed(ivisurf->shell);
 }
 
 static void
@@ -258,42 +888,137 @@ send_layer_prop(struct wl_listener *listener, void *data)
     struct ivilayer *ivilayer =
            wl_container_of(listener, ivilayer, property_changed);
     (void)data;
-    enum ivi_layout_notification_mask mask;
-    struct ivicontroller *ctrl;
-    const struct ivi_layout_interface *lyt = ivilayer->shell->interface;
     struct notification *noti;
-    uint32_t layer_id;
-
-    mask = ivilayer->prop->event_mask;
-
-    layer_id = lyt->get_id_of_layer(ivilayer->layout_layer);
 
     wl_list_for_each(noti, &ivilayer->notification_list, layout_link) {
-        ctrl = wl_resource_get_user_data(noti->resource);
-        send_layer_event(ctrl, ivilayer->layout_layer, layer_id, ivilayer->prop, mask);
+        queue_notification(noti, ivilayer->prop->event_mask);
     }
-}
-
-static void
-controller_set_surface_opacity(struct wl_client *client,
-                   struct wl_resource *resource,
-                   uint32_t surface_id,
-                   wl_fixed_t opacity)
-{
-    struct ivicontroller *ctrl = wl_resource_get_user_data(resource);
-    const struct ivi_layout_interface *lyt = ctrl->shell->interface;
-    (void)client;
-    struct ivi_layout_surface *layout_surface;
 
-    layout_surface = lyt->get_surface_from_id(surface_id);
-    if (!layout_surface) {
-        ivi_wm_send_surface_error(resource, surface_id,
-                                  IVI_WM_SURFACE_ERROR_NO_SURFACE,
-                                  "surface_set_opacity: the surface with given id does not exist");
-        return;
-    }
+    ivilayer->pending_mask = 0;
+    wl_list_remove(&ivilayer->pending_link);
+    wl_list_init(&ivilayer->pending_link);
 
-    lyt->surface_set_opacity(layout_surface, opacity);
+    ivi_frame_policy_schedule_update(ivilayer->shell->frame_policy);
+    notify_scene_changed(ivilayer->shell);
+}
+
+/* Sends the final state of every object that changed since the last
+ * flush, once per controller, instead of every intermediate state.
+ */
+static void
+flush_notifications(void *data)
+{
+    struct ivishell *shell = data;
+    const struct ivi_layout_interface *lyt = shell->interface;
+    struct ivicontroller *ctrl;
+    struct notification *noti, *next;
+    struct ivi_trace_span span;
+    uint32_t mask, notifications = 0, events = 0;
+
+    shell->notification_idle = NULL;
+
+    ivi_trace_span_begin(shell->trace, &span, "notification", "notify",
+                         NULL);
+
+    wl_list_for_each(ctrl, &shell->list_controller, link) {
+        wl_list_for_each_safe(noti, next, &ctrl->dirty_notifications,
+                              dirty_link) {
+            mask = noti->pending_mask;
+            noti->pending_mask = 0;
+            wl_list_remove(&noti->dirty_link);
+            wl_list_init(&noti->dirty_link);
+
+            if (noti->ivisurf) {
+                send_surface_event(ctrl, noti->ivisurf->layout_surface,
+                                   noti->ivisurf->id_surface,
+                                   noti->ivisurf->prop, mask);
+            } else {
+                send_layer_event(ctrl, noti->ivilayer->layout_layer,
+                                 lyt->get_id_of_layer(noti->ivilayer->layout_layer),
+                                 noti->ivilayer->prop, mask);
+            }
+
+            notifications++;
+            events += __builtin_popcount(mask & (IVI_NOTIFICATION_OPACITY |
+                                                 IVI_NOTIFICATION_SOURCE_RECT |
+                                                 IVI_NOTIFICATION_DEST_RECT |
+                                                 IVI_NOTIFICATION_VISIBILITY |
+                                                 IVI_NOTIFICATION_CONFIGURE));
+        }
+    }
+
+    ivi_trace_span_end(&span, "\"notifications\":%u,\"events\":%u",
+                       notifications, events);
+}
+
+/* A property request is dropped, if it sets the committed value of a
+ * property which no controller requested since the last commit. A value
+ * requested before would be reverted by the request, so it is always
+ * forwarded then. Requests of other modules are not visible through
+ * ivi-layout before they are committed.
+ */
+static bool
+surface_request_is_redundant(struct ivisurface *ivisurf, uint32_t mask,
+                             bool unchanged)
+{
+    if (!ivisurf)
+        return false;
+
+    if (unchanged && !(ivisurf->pending_mask & mask))
+        return true;
+
+    if (ivisurf->pending_mask == 0)
+        wl_list_insert(&ivisurf->shell->pending_surfaces,
+                       &ivisurf->pending_link);
+    ivisurf->pending_mask |= mask;
+    return false;
+}
+
+static bool
+layer_request_is_redundant(struct ivilayer *ivilayer, uint32_t mask,
+                           bool unchanged)
+{
+    if (unchanged && !(ivilayer->pending_mask & mask))
+        return true;
+
+    if (ivilayer->pending_mask == 0)
+        wl_list_insert(&ivilayer->shell->pending_layers,
+                       &ivilayer->pending_link);
+    ivilayer->pending_mask |= mask;
+    return false;
+}
+
+static void
+controller_set_surface_opacity(struct wl_client *client,
+                   struct wl_resource *resource,
+                   uint32_t surface_id,
+                   wl_fixed_t opacity)
+{
+    TRACE_REQUEST(resource);
+    struct ivicontroller *ctrl = wl_resource_get_user_data(resource);
+    const struct ivi_layout_interface *lyt = ctrl->shell->interface;
+    (void)client;
+    struct ivi_layout_surface *layout_surface;
+    struct ivisurface *ivisurf;
+
+    layout_surface = lyt->get_surface_from_id(surface_id);
+    if (!layout_surface) {
+        ivi_wm_send_surface_error(resource, surface_id,
+                                  IVI_WM_SURFACE_ERROR_NO_SURFACE,
+                                  "surface_set_opacity: the surface with given id does not exist");
+        return;
+    }
+
+    ivisurf = ivishell_get_surface(ctrl->shell, layout_surface);
+    if (surface_request_is_redundant(ivisurf, IVI_NOTIFICATION_OPACITY,
+            lyt->get_properties_of_surface(layout_surface)->opacity ==
+            opacity)) {
+        ctrl->skipped_requests++;
+        return;
+    }
+
+    lyt->surface_set_opacity(layout_surface, opacity);
+    ctrl->shell->pending_changes++;
 }
 
 static void
@@ -305,10 +1030,12 @@ controller_set_surface_source_rectangle(struct wl_client *client,
                    int32_t width,
                    int32_t height)
 {
+    TRACE_REQUEST(resource);
     struct ivicontroller *ctrl = wl_resource_get_user_data(resource);
     const struct ivi_layout_interface *lyt = ctrl->shell->interface;
     (void)client;
     struct ivi_layout_surface *layout_surface;
+    struct ivisurface *ivisurf;
     const struct ivi_layout_surface_properties *prop;
 
     layout_surface = lyt->get_surface_from_id(surface_id);
@@ -320,6 +1047,7 @@ controller_set_surface_source_rectangle(struct wl_client *client,
     }
 
     prop = lyt->get_properties_of_surface(layout_surface);
+    ivisurf = ivishell_get_surface(ctrl->shell, layout_surface);
 
     if (x < 0)
         x = prop->source_x;
@@ -330,8 +1058,16 @@ controller_set_surface_source_rectangle(struct wl_client *client,
     if (height < 0)
         height = prop->source_height;
 
+    if (surface_request_is_redundant(ivisurf, IVI_NOTIFICATION_SOURCE_RECT,
+            prop->source_x == x && prop->source_y == y &&
+            prop->source_width == width && prop->source_height == height)) {
+        ctrl->skipped_requests++;
+        return;
+    }
+
     lyt->surface_set_source_rectangle(layout_surface,
             (uint32_t)x, (uint32_t)y, (uint32_t)width, (uint32_t)height);
+    ctrl->shell->pending_changes++;
 }
 
 static void
@@ -343,10 +1079,12 @@ controller_set_surface_destination_rectangle(struct wl_client *client,
                      int32_t width,
                      int32_t height)
 {
+    TRACE_REQUEST(resource);
     struct ivicontroller *ctrl = wl_resource_get_user_data(resource);
     const struct ivi_layout_interface *lyt = ctrl->shell->interface;
     (void)client;
     struct ivi_layout_surface *layout_surface;
+    struct ivisurface *ivisurf;
     const struct ivi_layout_surface_properties *prop;
 
     layout_surface = lyt->get_surface_from_id(surface_id);
@@ -358,11 +1096,7 @@ controller_set_surface_destination_rectangle(struct wl_client *client,
     }
 
     prop = lyt->get_properties_of_surface(layout_surface);
-
-    // TODO: create set transition type protocol
-    lyt->surface_set_transition(layout_surface,
-                                     IVI_LAYOUT_TRANSITION_NONE,
-                                     300); // ms
+    ivisurf = ivishell_get_surface(ctrl->shell, layout_surface);
 
     if (x < 0)
         x = prop->dest_x;
@@ -373,9 +1107,21 @@ controller_set_surface_destination_rectangle(struct wl_client *client,
     if (height < 0)
         height = prop->dest_height;
 
+    if (surface_request_is_redundant(ivisurf, IVI_NOTIFICATION_DEST_RECT,
+            prop->dest_x == x && prop->dest_y == y &&
+            prop->dest_width == width && prop->dest_height == height)) {
+        ctrl->skipped_requests++;
+        return;
+    }
+
+    // TODO: create set transition type protocol
+    lyt->surface_set_transition(layout_surface,
+                                     IVI_LAYOUT_TRANSITION_NONE,
+                                     300); // ms
 
     lyt->surface_set_destination_rectangle(layout_surface,
             (uint32_t)x, (uint32_t)y, (uint32_t)width, (uint32_t)height);
+    ctrl->shell->pending_changes++;
 }
 
 static void
@@ -384,10 +1130,12 @@ controller_set_surface_visibility(struct wl_client *client,
                       uint32_t surface_id,
                       uint32_t visibility)
 {
+    TRACE_REQUEST(resource);
     struct ivicontroller *ctrl = wl_resource_get_user_data(resource);
     const struct ivi_layout_interface *lyt = ctrl->shell->interface;
     (void)client;
     struct ivi_layout_surface *layout_surface;
+    struct ivisurface *ivisurf;
 
     layout_surface = lyt->get_surface_from_id(surface_id);
     if (!layout_surface) {
@@ -397,7 +1145,16 @@ controller_set_surface_visibility(struct wl_client *client,
         return;
     }
 
+    ivisurf = ivishell_get_surface(ctrl->shell, layout_surface);
+    if (surface_request_is_redundant(ivisurf, IVI_NOTIFICATION_VISIBILITY,
+            lyt->get_properties_of_surface(layout_surface)->visibility ==
+            !!visibility)) {
+        ctrl->skipped_requests++;
+        return;
+    }
+
     lyt->surface_set_visibility(layout_surface, visibility);
+    ctrl->shell->pending_changes++;
 }
 
 /** Read the current time from the Presentation clock
@@ -436,85 +1193,1003 @@ ivi_weston_compositor_read_presentation_clock(
 	}
 }
 
+/* \return bytes per pixel of a supported screenshot format, or 0 */
+static int32_t
+screenshot_format_bpp(uint32_t format)
+{
+    switch (format) {
+    case WL_SHM_FORMAT_ABGR8888:
+    case WL_SHM_FORMAT_ARGB8888:
+        return 4;
+    case WL_SHM_FORMAT_RGB888:
+        return 3;
+    case WL_SHM_FORMAT_RGB565:
+        return 2;
+    case WL_SHM_FORMAT_R8:
+        return 1;
+    default:
+        return 0;
+    }
+}
+
+/* Row kernels converting the ABGR32 output of surface_dump. They are
+ * plain per pixel loops without dependencies between iterations, so the
+ * compiler vectorizes them.
+ */
 static void
-controller_surface_screenshot(struct wl_client *client,
-                              struct wl_resource *resource,
-                              struct wl_resource *buffer_resource,
-                              uint32_t screenshot_id,
-                              uint32_t surface_id)
+convert_row_argb8888(uint8_t *restrict dst, const uint8_t *restrict src,
+                     int32_t width)
+{
+    int32_t x;
+
+    for (x = 0; x < width; x++) {
+        dst[x * 4 + 0] = src[x * 4 + 2];
+        dst[x * 4 + 1] = src[x * 4 + 1];
+        dst[x * 4 + 2] = src[x * 4 + 0];
+        dst[x * 4 + 3] = src[x * 4 + 3];
+    }
+}
+
+static void
+convert_row_rgb888(uint8_t *restrict dst, const uint8_t *restrict src,
+                   int32_t width)
+{
+    int32_t x;
+
+    for (x = 0; x < width; x++) {
+        dst[x * 3 + 0] = src[x * 4 + 2];
+        dst[x * 3 + 1] = src[x * 4 + 1];
+        dst[x * 3 + 2] = src[x * 4 + 0];
+    }
+}
+
+static void
+convert_row_rgb565(uint8_t *restrict dst, const uint8_t *restrict src,
+                   int32_t width)
+{
+    int32_t x;
+
+    for (x = 0; x < width; x++) {
+        uint16_t pixel = ((src[x * 4 + 0] & 0xf8) << 8) |
+                         ((src[x * 4 + 1] & 0xfc) << 3) |
+                         (src[x * 4 + 2] >> 3);
+
+        dst[x * 2 + 0] = pixel & 0xff;
+        dst[x * 2 + 1] = pixel >> 8;
+    }
+}
+
+static void
+convert_row_r8(uint8_t *restrict dst, const uint8_t *restrict src,
+               int32_t width)
+{
+    int32_t x;
+
+    /* BT.601 luma in 8 bit fixed point */
+    for (x = 0; x < width; x++)
+        dst[x] = (77 * src[x * 4 + 0] + 150 * src[x * 4 + 1] +
+                  29 * src[x * 4 + 2] + 128) >> 8;
+}
+
+/* Convert an ABGR32 image into format with tightly packed rows */
+static void
+convert_screenshot(uint32_t format, uint8_t *dst, const uint8_t *src,
+                   int32_t src_stride, int32_t width, int32_t height)
+{
+    const int32_t dst_stride = width * screenshot_format_bpp(format);
+    int32_t y;
+
+    for (y = 0; y < height; y++) {
+        uint8_t *out = dst + y * dst_stride;
+        const uint8_t *in = src + y * src_stride;
+
+        switch (format) {
+        case WL_SHM_FORMAT_ABGR8888:
+            memcpy(out, in, dst_stride);
+            break;
+        case WL_SHM_FORMAT_ARGB8888:
+            convert_row_argb8888(out, in, width);
+            break;
+        case WL_SHM_FORMAT_RGB888:
+            convert_row_rgb888(out, in, width);
+            break;
+        case WL_SHM_FORMAT_RGB565:
+            convert_row_rgb565(out, in, width);
+            break;
+        case WL_SHM_FORMAT_R8:
+            convert_row_r8(out, in, width);
+            break;
+        }
+    }
+}
+
+/* Check that the buffer can take a width x height image in format.
+ * ABGR32 images are written with the stride of the buffer, converted
+ * ones with tightly packed rows.
+ */
+static bool
+screenshot_buffer_fits(struct weston_buffer *weston_buffer, uint32_t format,
+                       int32_t width, int32_t height)
+{
+    struct wl_shm_buffer *shm_buffer;
+
+    if ((weston_buffer == NULL) ||
+            (weston_buffer->type != WESTON_BUFFER_SHM))
+        return false;
+
+    shm_buffer = weston_buffer->shm_buffer;
+    if (format != WL_SHM_FORMAT_ABGR8888)
+        return (int64_t)wl_shm_buffer_get_stride(shm_buffer) *
+                   wl_shm_buffer_get_height(shm_buffer) >=
+               (int64_t)width * screenshot_format_bpp(format) * height;
+
+    /* assuming ABGR32 is always written by surface_dump.
+     * ABGR32 may not support by rederer to create a shm buffer.
+     * So, just check the bytes per pixel must be 4 here.
+     */
+    return ((wl_shm_buffer_get_stride(shm_buffer) /
+                (wl_shm_buffer_get_width(shm_buffer))) == 4) &&
+           (wl_shm_buffer_get_width(shm_buffer) >= width) &&
+           (wl_shm_buffer_get_height(shm_buffer) >= height);
+}
+
+static void
+dump_surface_screenshot(struct ivi_surface_screenshot *state)
 {
     int32_t result = IVI_FAILED;
-    struct ivicontroller *ctrl = wl_resource_get_user_data(resource);
+    struct ivishell *shell = state->shell;
     struct weston_surface *weston_surface = NULL;
     int32_t width = 0, height = 0, stride = 0, size = 0;
-    const struct ivi_layout_interface *lyt = ctrl->shell->interface;
+    const struct ivi_layout_interface *lyt = shell->interface;
     struct ivi_layout_surface *layout_surface;
-    struct weston_compositor *compositor = ctrl->shell->compositor;
-    struct wl_resource *screenshot;
+    struct weston_compositor *compositor = shell->compositor;
+    struct wl_resource *screenshot = state->screenshot;
     struct timespec stamp;
     uint32_t stamp_ms;
     void *shm_buff_data = NULL;
+    void *dump_data = NULL;
     struct weston_buffer *weston_buffer = NULL;
 
-    screenshot = wl_resource_create(client,
-            &ivi_screenshot_interface, 2, screenshot_id);
-    if (screenshot == NULL) {
-        wl_client_post_no_memory(client);
+    if (!screenshot_format_bpp(state->format)) {
+        ivi_screenshot_send_error(screenshot, IVI_SCREENSHOT_ERROR_NOT_SUPPORTED,
+                "surface_screenshot: unsupported pixel format");
         return;
     }
 
-    layout_surface = lyt->get_surface_from_id(surface_id);
+    layout_surface = lyt->get_surface_from_id(state->surface_id);
     if (!layout_surface) {
         ivi_screenshot_send_error(screenshot, IVI_SCREENSHOT_ERROR_NO_SURFACE, 
                 "surface_screenshot: the surface with given id does not exist");
-        goto err;
+        return;
     }
 
     lyt->surface_get_size(layout_surface, &width, &height, &stride);
     if (!width || !height || !stride) {
         ivi_screenshot_send_error(screenshot, IVI_SCREENSHOT_ERROR_NO_CONTENT, 
                 "surface_screenshot: surface does not have content");
-        goto err;
+        return;
     }
 
-    /* get the weston buffer from buffer resource, then verify */
-    weston_buffer = weston_buffer_from_resource(compositor, buffer_resource);
-    if ( (weston_buffer == NULL) ||
-            (weston_buffer->type != WESTON_BUFFER_SHM) ||
-            /* assuming ABGR32 is always written by surface_dump.
-             * ABGR32 may not support by rederer to create a shm buffer.
-             * So, just check the bytes per pixel must be 4 here.
-             */
-            ((wl_shm_buffer_get_stride(weston_buffer->shm_buffer) /
-                (wl_shm_buffer_get_width(weston_buffer->shm_buffer))) != 4) ||
-            (wl_shm_buffer_get_width(weston_buffer->shm_buffer) < width) ||
-            (wl_shm_buffer_get_height(weston_buffer->shm_buffer) < height)) {
+    /* the client may have destroyed the buffer while the request
+     * was queued */
+    if (state->buffer_resource)
+        weston_buffer = weston_buffer_from_resource(compositor,
+                                                    state->buffer_resource);
+
+    /* verify the weston buffer */
+    if (!screenshot_buffer_fits(weston_buffer, state->format, width, height)) {
         ivi_screenshot_send_error(screenshot, IVI_SCREENSHOT_ERROR_BAD_BUFFER,
                 "bad buffer input");
-        goto err;
+        return;
     }
     shm_buff_data = wl_shm_buffer_get_data(weston_buffer->shm_buffer);
 
-    /* surface dump the data to shm buffer */
+    /* surface dump the data to shm buffer, or to a temporary one if
+     * it has to be converted */
     size = stride * height;
+    if (state->format == WL_SHM_FORMAT_ABGR8888) {
+        dump_data = shm_buff_data;
+    } else {
+        dump_data = malloc(size);
+        if (dump_data == NULL) {
+            ivi_screenshot_send_error(screenshot, IVI_SCREENSHOT_ERROR_NO_MEMORY,
+                    "surface_screenshot: failed to allocate the surface image");
+            return;
+        }
+    }
     weston_surface = lyt->surface_get_weston_surface(layout_surface);
 
-    result = lyt->surface_dump(weston_surface, shm_buff_data, size, 0, 0,
+    result = lyt->surface_dump(weston_surface, dump_data, size, 0, 0,
             width, height);
 
     if (result != IVI_SUCCEEDED) {
+        if (dump_data != shm_buff_data)
+            free(dump_data);
         ivi_screenshot_send_error(screenshot, IVI_SCREENSHOT_ERROR_NOT_SUPPORTED,
                 "surface_screenshot: surface dumping is not supported by renderer");
-        goto err;
+        return;
+    }
+
+    if (dump_data != shm_buff_data) {
+        convert_screenshot(state->format, shm_buff_data, dump_data, stride,
+                           width, height);
+        free(dump_data);
     }
 
     /* get current timestamp */
     ivi_weston_compositor_read_presentation_clock(compositor, &stamp);
     stamp_ms = stamp.tv_sec * 1000 + stamp.tv_nsec / 1000000;
     ivi_screenshot_send_done(screenshot, stamp_ms);
+}
 
-err:
-    wl_resource_destroy(screenshot);
+/* Downscale an ABGR32 image by averaging all source pixels covered by
+ * each destination pixel. Source rows are first summed up per byte into
+ * column_sum, a straight loop the compiler vectorizes, then the columns
+ * of each destination pixel are reduced.
+ */
+static void
+box_filter_downscale(const uint8_t *src, int32_t src_width,
+                     int32_t src_height, int32_t src_stride,
+                     uint8_t *dst, int32_t dst_width, int32_t dst_height,
+                     int32_t dst_stride, uint32_t *column_sum)
+{
+    const int32_t row_bytes = src_width * 4;
+    int32_t x, y, sx, sy, i, c;
+
+    for (y = 0; y < dst_height; y++) {
+        int32_t y0 = (int64_t)y * src_height / dst_height;
+        int32_t y1 = (int64_t)(y + 1) * src_height / dst_height;
+        uint8_t *out = dst + y * dst_stride;
+
+        memset(column_sum, 0, row_bytes * sizeof *column_sum);
+        for (sy = y0; sy < y1; sy++) {
+            const uint8_t *row = src + sy * src_stride;
+
+            for (i = 0; i < row_bytes; i++)
+                column_sum[i] += row[i];
+        }
+
+        for (x = 0; x < dst_width; x++) {
+            int32_t x0 = (int64_t)x * src_width / dst_width;
+            int32_t x1 = (int64_t)(x + 1) * src_width / dst_width;
+            uint64_t count = (uint64_t)(x1 - x0) * (y1 - y0);
+            uint64_t acc[4] = {0, 0, 0, 0};
+
+            for (sx = x0; sx < x1; sx++) {
+                for (c = 0; c < 4; c++)
+                    acc[c] += column_sum[sx * 4 + c];
+            }
+
+            for (c = 0; c < 4; c++)
+                out[x * 4 + c] = (acc[c] + count / 2) / count;
+        }
+    }
+}
+
+/* Dump one surface and downscale it into its cell of the atlas. The
+ * size of the thumbnail is 0 x 0 if the surface could not be dumped.
+ */
+static void
+dump_surface_thumbnail(struct ivishell *shell, uint32_t surface_id,
+                       uint8_t *cell, int32_t cell_stride,
+                       int32_t cell_width, int32_t cell_height,
+                       uint32_t *thumb_width, uint32_t *thumb_height)
+{
+    const struct ivi_layout_interface *lyt = shell->interface;
+    struct ivi_layout_surface *layout_surface;
+    struct weston_surface *weston_surface;
+    int32_t width = 0, height = 0, stride = 0;
+    int32_t dst_width, dst_height;
+    uint8_t *pixels;
+    uint32_t *column_sum;
+
+    *thumb_width = 0;
+    *thumb_height = 0;
+
+    layout_surface = lyt->get_surface_from_id(surface_id);
+    if (!layout_surface)
+        return;
+
+    lyt->surface_get_size(layout_surface, &width, &height, &stride);
+    if (!width || !height || !stride)
+        return;
+
+    /* fit into the cell keeping the aspect ratio, never scale up */
+    if ((int64_t)width * cell_height >= (int64_t)height * cell_width) {
+        dst_width = width < cell_width ? width : cell_width;
+        dst_height = (int64_t)height * dst_width / width;
+    } else {
+        dst_height = height < cell_height ? height : cell_height;
+        dst_width = (int64_t)width * dst_height / height;
+    }
+    if (dst_width < 1)
+        dst_width = 1;
+    if (dst_height < 1)
+        dst_height = 1;
+
+    pixels = malloc(stride * height);
+    column_sum = malloc(width * 4 * sizeof *column_sum);
+    if (pixels == NULL || column_sum == NULL)
+        goto out;
+
+    weston_surface = lyt->surface_get_weston_surface(layout_surface);
+    if (lyt->surface_dump(weston_surface, pixels, stride * height, 0, 0,
+                          width, height) != IVI_SUCCEEDED)
+        goto out;
+
+    box_filter_downscale(pixels, width, height, stride,
+                         cell, dst_width, dst_height, cell_stride,
+                         column_sum);
+    *thumb_width = dst_width;
+    *thumb_height = dst_height;
+
+out:
+    free(column_sum);
+    free(pixels);
+}
+
+/* Dump one surface per call into its cell of the atlas, so that a long
+ * list of surfaces does not hold up input and repaints. The layout is
+ * sent with the last surface.
+ */
+static void
+dump_surfaces_thumbnail(struct ivi_surface_screenshot *state)
+{
+    struct ivishell *shell = state->shell;
+    struct weston_compositor *compositor = shell->compositor;
+    struct wl_resource *screenshot = state->screenshot;
+    struct weston_buffer *weston_buffer = NULL;
+    struct wl_shm_buffer *shm_buffer;
+    int32_t cell_width = state->thumb_width;
+    int32_t cell_height = state->thumb_height;
+    int32_t buffer_stride, columns, rows, row, x, y;
+    uint32_t count = state->surface_ids.size / sizeof(uint32_t);
+    uint32_t surface_id;
+    uint32_t *entry;
+    uint8_t *atlas, *cell;
+    struct timespec stamp;
+    uint32_t stamp_ms;
+
+    /* checked on every call, the client may destroy the buffer meanwhile */
+    if (state->buffer_resource)
+        weston_buffer = weston_buffer_from_resource(compositor,
+                                                    state->buffer_resource);
+
+    if ((weston_buffer == NULL) ||
+            (weston_buffer->type != WESTON_BUFFER_SHM) ||
+            (cell_width <= 0) || (cell_height <= 0)) {
+        ivi_screenshot_send_error(screenshot, IVI_SCREENSHOT_ERROR_BAD_BUFFER,
+                "bad buffer input");
+        return;
+    }
+
+    shm_buffer = weston_buffer->shm_buffer;
+    buffer_stride = wl_shm_buffer_get_stride(shm_buffer);
+    columns = wl_shm_buffer_get_width(shm_buffer) / cell_width;
+    rows = wl_shm_buffer_get_height(shm_buffer) / cell_height;
+    if ((buffer_stride / wl_shm_buffer_get_width(shm_buffer)) != 4 ||
+            (uint64_t)columns * rows < count) {
+        ivi_screenshot_send_error(screenshot, IVI_SCREENSHOT_ERROR_BAD_BUFFER,
+                "bad buffer input");
+        return;
+    }
+    atlas = wl_shm_buffer_get_data(shm_buffer);
+
+    if (state->thumb_index < count) {
+        surface_id = ((uint32_t *)state->surface_ids.data)[state->thumb_index];
+        x = (state->thumb_index % columns) * cell_width;
+        y = (state->thumb_index / columns) * cell_height;
+        cell = atlas + y * buffer_stride + x * 4;
+
+        entry = wl_array_add(&state->thumb_layout, 5 * sizeof *entry);
+        if (entry == NULL) {
+            ivi_screenshot_send_error(screenshot,
+                    IVI_SCREENSHOT_ERROR_NO_MEMORY,
+                    "surfaces_thumbnail: failed to allocate the layout");
+            return;
+        }
+
+        for (row = 0; row < cell_height; row++)
+            memset(cell + row * buffer_stride, 0, cell_width * 4);
+
+        entry[0] = surface_id;
+        entry[1] = x;
+        entry[2] = y;
+        dump_surface_thumbnail(shell, surface_id, cell, buffer_stride,
+                               cell_width, cell_height, &entry[3], &entry[4]);
+
+        if (++state->thumb_index < count) {
+            state->incomplete = true;
+            return;
+        }
+    }
+
+    ivi_screenshot_send_thumbnail_layout(screenshot, &state->thumb_layout);
+
+    ivi_weston_compositor_read_presentation_clock(compositor, &stamp);
+    stamp_ms = stamp.tv_sec * 1000 + stamp.tv_nsec / 1000000;
+    ivi_screenshot_send_done(screenshot, stamp_ms);
+}
+
+/* Composite one surface of a layer into the layer image
+ *
+ * \return 0 on success or if the surface is not shown, -1 after an error
+ * has been sent to the screenshot
+ */
+static int
+composite_layer_surface(struct ivi_surface_screenshot *state,
+                        pixman_image_t *target,
+                        const struct ivi_layout_layer_properties *layer_prop,
+                        struct ivi_layout_surface *layout_surface)
+{
+    const struct ivi_layout_interface *lyt = state->shell->interface;
+    const struct ivi_layout_surface_properties *prop;
+    struct weston_surface *weston_surface;
+    int32_t width = 0, height = 0, stride = 0;
+    int32_t x0, y0, x1, y1;
+    double scale_x, scale_y, opacity;
+    struct pixman_f_transform ftransform;
+    pixman_transform_t transform;
+    pixman_image_t *source = NULL;
+    pixman_image_t *mask = NULL;
+    pixman_color_t mask_color;
+    void *pixels = NULL;
+    int ret = -1;
+
+    prop = lyt->get_properties_of_surface(layout_surface);
+    if (!prop->visibility ||
+            !prop->source_width || !prop->source_height ||
+            !prop->dest_width || !prop->dest_height)
+        return 0;
+
+    lyt->surface_get_size(layout_surface, &width, &height, &stride);
+    if (!width || !height || !stride)
+        return 0;
+
+    /* destination rectangle of the surface in image coordinates */
+    scale_x = (double)layer_prop->dest_width / layer_prop->source_width;
+    scale_y = (double)layer_prop->dest_height / layer_prop->source_height;
+    x0 = (prop->dest_x - layer_prop->source_x) * scale_x;
+    y0 = (prop->dest_y - layer_prop->source_y) * scale_y;
+    x1 = (prop->dest_x + prop->dest_width - layer_prop->source_x) * scale_x;
+    y1 = (prop->dest_y + prop->dest_height - layer_prop->source_y) * scale_y;
+    if (x0 < 0)
+        x0 = 0;
+    if (y0 < 0)
+        y0 = 0;
+    if (x1 > layer_prop->dest_width)
+        x1 = layer_prop->dest_width;
+    if (y1 > layer_prop->dest_height)
+        y1 = layer_prop->dest_height;
+    if (x0 >= x1 || y0 >= y1)
+        return 0;
+
+    pixels = malloc(stride * height);
+    if (pixels == NULL) {
+        ivi_screenshot_send_error(state->screenshot,
+                IVI_SCREENSHOT_ERROR_NO_MEMORY,
+                "layer_screenshot: failed to allocate the surface image");
+        return -1;
+    }
+
+    weston_surface = lyt->surface_get_weston_surface(layout_surface);
+    if (lyt->surface_dump(weston_surface, pixels, stride * height, 0, 0,
+                          width, height) != IVI_SUCCEEDED) {
+        ivi_screenshot_send_error(state->screenshot,
+                IVI_SCREENSHOT_ERROR_NOT_SUPPORTED,
+                "layer_screenshot: surface dumping is not supported by renderer");
+        goto out;
+    }
+
+    /* surface_dump writes ABGR32 */
+    source = pixman_image_create_bits(PIXMAN_a8b8g8r8, width, height,
+                                      pixels, stride);
+    if (source == NULL) {
+        ivi_screenshot_send_error(state->screenshot,
+                IVI_SCREENSHOT_ERROR_NO_MEMORY,
+                "layer_screenshot: failed to create the surface image");
+        goto out;
+    }
+
+    /* image -> layer -> surface buffer coordinates */
+    pixman_f_transform_init_scale(&ftransform,
+            (double)prop->source_width / (prop->dest_width * scale_x),
+            (double)prop->source_height / (prop->dest_height * scale_y));
+    pixman_f_transform_translate(&ftransform, NULL,
+            prop->source_x + (double)(layer_prop->source_x - prop->dest_x) *
+                prop->source_width / prop->dest_width,
+            prop->source_y + (double)(layer_prop->source_y - prop->dest_y) *
+                prop->source_height / prop->dest_height);
+    pixman_transform_from_pixman_f_transform(&transform, &ftransform);
+    pixman_image_set_transform(source, &transform);
+    pixman_image_set_filter(source, PIXMAN_FILTER_BILINEAR, NULL, 0);
+
+    opacity = wl_fixed_to_double(prop->opacity) *
+              wl_fixed_to_double(layer_prop->opacity);
+    if (opacity < 1.0) {
+        mask_color.red = 0;
+        mask_color.green = 0;
+        mask_color.blue = 0;
+        mask_color.alpha = opacity * 0xffff;
+        mask = pixman_image_create_solid_fill(&mask_color);
+    }
+
+    pixman_image_composite32(PIXMAN_OP_OVER, source, mask, target,
+                             x0, y0, 0, 0, x0, y0, x1 - x0, y1 - y0);
+    ret = 0;
+
+out:
+    if (mask)
+        pixman_image_unref(mask);
+    if (source)
+        pixman_image_unref(source);
+    free(pixels);
+    return ret;
+}
+
+static void
+dump_layer_screenshot(struct ivi_surface_screenshot *state)
+{
+    struct ivishell *shell = state->shell;
+    const struct ivi_layout_interface *lyt = shell->interface;
+    const struct ivi_layout_layer_properties *layer_prop;
+    struct ivi_layout_layer *layout_layer;
+    struct ivi_layout_surface **surfaces = NULL;
+    struct weston_compositor *compositor = shell->compositor;
+    struct wl_resource *screenshot = state->screenshot;
+    struct weston_buffer *weston_buffer = NULL;
+    void *shm_buff_data;
+    pixman_image_t *target;
+    int32_t length = 0;
+    int32_t width, height, i;
+    struct timespec stamp;
+    uint32_t stamp_ms;
+
+    if (!screenshot_format_bpp(state->format)) {
+        ivi_screenshot_send_error(screenshot, IVI_SCREENSHOT_ERROR_NOT_SUPPORTED,
+                "layer_screenshot: unsupported pixel format");
+        return;
+    }
+
+    layout_layer = lyt->get_layer_from_id(state->layer_id);
+    if (!layout_layer) {
+        ivi_screenshot_send_error(screenshot, IVI_SCREENSHOT_ERROR_NO_LAYER,
+                "layer_screenshot: the layer with given id does not exist");
+        return;
+    }
+
+    layer_prop = lyt->get_properties_of_layer(layout_layer);
+    width = layer_prop->dest_width;
+    height = layer_prop->dest_height;
+    if (!width || !height ||
+            !layer_prop->source_width || !layer_prop->source_height) {
+        ivi_screenshot_send_error(screenshot, IVI_SCREENSHOT_ERROR_NO_CONTENT,
+                "layer_screenshot: layer does not have a size");
+        return;
+    }
+
+    if (state->buffer_resource)
+        weston_buffer = weston_buffer_from_resource(compositor,
+                                                    state->buffer_resource);
+
+    if (!screenshot_buffer_fits(weston_buffer, state->format, width, height)) {
+        ivi_screenshot_send_error(screenshot, IVI_SCREENSHOT_ERROR_BAD_BUFFER,
+                "bad buffer input");
+        return;
+    }
+    shm_buff_data = wl_shm_buffer_get_data(weston_buffer->shm_buffer);
+
+    /* composite into the shm buffer, or into an image of pixman if it
+     * has to be converted */
+    if (state->format == WL_SHM_FORMAT_ABGR8888)
+        target = pixman_image_create_bits(PIXMAN_a8b8g8r8, width, height,
+                shm_buff_data,
+                wl_shm_buffer_get_stride(weston_buffer->shm_buffer));
+    else
+        target = pixman_image_create_bits(PIXMAN_a8b8g8r8, width, height,
+                NULL, 0);
+    if (target == NULL) {
+        ivi_screenshot_send_error(screenshot, IVI_SCREENSHOT_ERROR_NO_MEMORY,
+                "layer_screenshot: failed to create the layer image");
+        return;
+    }
+
+    if (lyt->get_surfaces_on_layer(layout_layer, &length,
+                                   &surfaces) != IVI_SUCCEEDED) {
+        pixman_image_unref(target);
+        ivi_screenshot_send_error(screenshot, IVI_SCREENSHOT_ERROR_NO_MEMORY,
+                "layer_screenshot: failed to get the surfaces of the layer");
+        return;
+    }
+
+    pixman_image_composite32(PIXMAN_OP_CLEAR, target, NULL, target,
+                             0, 0, 0, 0, 0, 0, width, height);
+
+    /* the first surface of the render order is the bottom one */
+    for (i = 0; i < length; i++) {
+        if (composite_layer_surface(state, target, layer_prop,
+                                    surfaces[i]) < 0)
+            break;
+    }
+
+    free(surfaces);
+
+    if (i < length) {
+        pixman_image_unref(target);
+        return;
+    }
+
+    if (state->format != WL_SHM_FORMAT_ABGR8888)
+        convert_screenshot(state->format, shm_buff_data,
+                           (const uint8_t *)pixman_image_get_data(target),
+                           pixman_image_get_stride(target), width, height);
+    pixman_image_unref(target);
+
+    ivi_weston_compositor_read_presentation_clock(compositor, &stamp);
+    stamp_ms = stamp.tv_sec * 1000 + stamp.tv_nsec / 1000000;
+    ivi_screenshot_send_done(screenshot, stamp_ms);
+}
+
+static void
+surface_screenshot_buffer_destroyed(struct wl_listener *listener, void *data)
+{
+    struct ivi_surface_screenshot *state =
+        wl_container_of(listener, state, buffer_destroy_listener);
+    (void)data;
+
+    state->buffer_resource = NULL;
+    wl_list_remove(&listener->link);
+    wl_list_init(&listener->link);
+}
+
+static void
+surface_screenshot_destroy(struct wl_resource *resource)
+{
+    struct ivi_surface_screenshot *state = wl_resource_get_user_data(resource);
+
+    /* still queued, e.g. the client is gone before the dump */
+    if (!wl_list_empty(&state->link))
+        state->shell->screenshot_queue_length--;
+
+    wl_list_remove(&state->link);
+    wl_list_remove(&state->buffer_destroy_listener.link);
+    wl_array_release(&state->surface_ids);
+    wl_array_release(&state->thumb_layout);
+    free(state);
+}
+
+static int
+surface_screenshot_timer(void *data)
+{
+    struct ivishell *shell = data;
+    struct ivi_surface_screenshot *state;
+
+    if (wl_list_empty(&shell->screenshot_queue))
+        return 0;
+
+    state = wl_container_of(shell->screenshot_queue.next, state, link);
+    wl_list_remove(&state->link);
+    wl_list_init(&state->link);
+    shell->screenshot_queue_length--;
+
+    state->incomplete = false;
+    state->dump(state);
+
+    /* the rest of the request waits behind the requests queued meanwhile */
+    if (state->incomplete) {
+        wl_list_insert(shell->screenshot_queue.prev, &state->link);
+        shell->screenshot_queue_length++;
+    } else {
+        wl_resource_destroy(state->screenshot);
+    }
+
+    /* serve the next request only after the loop had a chance to
+     * dispatch input and repaint. An idle source would not do: idle
+     * sources added by an idle callback run in the same dispatch, which
+     * would drain the whole queue at once. The output frame signal is not
+     * used either, since no repaint may be due. A 1 ms timer is the
+     * shortest wait that goes through epoll again. */
+    if (!wl_list_empty(&shell->screenshot_queue))
+        wl_event_source_timer_update(shell->screenshot_timer, 1);
+
+    return 0;
+}
+
+/* Create the ivi_screenshot resource of a request and queue it
+ *
+ * \return the queued state, or NULL if the request has already been
+ * answered with an error
+ */
+static struct ivi_surface_screenshot *
+queue_surface_screenshot(struct wl_client *client,
+                         struct wl_resource *resource,
+                         struct wl_resource *buffer_resource,
+                         uint32_t screenshot_id,
+                         void (*dump)(struct ivi_surface_screenshot *state))
+{
+    struct ivicontroller *ctrl = wl_resource_get_user_data(resource);
+    struct ivishell *shell = ctrl->shell;
+    struct ivi_surface_screenshot *state;
+    struct wl_event_loop *loop;
+    struct wl_resource *screenshot;
+
+    screenshot = wl_resource_create(client, &ivi_screenshot_interface,
+            wl_resource_get_version(resource), screenshot_id);
+    if (screenshot == NULL) {
+        wl_client_post_no_memory(client);
+        return NULL;
+    }
+
+    if (shell->screenshot_queue_length >= shell->screenshot_queue_depth) {
+        if (wl_resource_get_version(screenshot) >=
+                IVI_SCREENSHOT_ERROR_BUSY_SINCE_VERSION)
+            ivi_screenshot_send_error(screenshot, IVI_SCREENSHOT_ERROR_BUSY,
+                    "surface_screenshot: too many pending screenshots");
+        else
+            ivi_screenshot_send_error(screenshot, IVI_SCREENSHOT_ERROR_NO_MEMORY,
+                    "surface_screenshot: too many pending screenshots");
+        wl_resource_destroy(screenshot);
+        return NULL;
+    }
+
+    if (shell->screenshot_timer == NULL) {
+        loop = wl_display_get_event_loop(shell->compositor->wl_display);
+        shell->screenshot_timer =
+            wl_event_loop_add_timer(loop, surface_screenshot_timer, shell);
+    }
+
+    state = calloc(1, sizeof *state);
+    if (state == NULL || shell->screenshot_timer == NULL) {
+        free(state);
+        ivi_screenshot_send_error(screenshot, IVI_SCREENSHOT_ERROR_NO_MEMORY,
+                "surface_screenshot: failed to queue the screenshot");
+        wl_resource_destroy(screenshot);
+        return NULL;
+    }
+
+    state->shell = shell;
+    state->screenshot = screenshot;
+    state->dump = dump;
+    state->format = ctrl->screenshot_format;
+    wl_array_init(&state->surface_ids);
+    wl_array_init(&state->thumb_layout);
+    state->buffer_resource = buffer_resource;
+    state->buffer_destroy_listener.notify = surface_screenshot_buffer_destroyed;
+    wl_resource_add_destroy_listener(buffer_resource,
+                                     &state->buffer_destroy_listener);
+
+    wl_resource_set_implementation(screenshot, NULL, state,
+                                   surface_screenshot_destroy);
+
+    wl_list_insert(shell->screenshot_queue.prev, &state->link);
+    if (shell->screenshot_queue_length++ == 0)
+        wl_event_source_timer_update(shell->screenshot_timer, 1);
+
+    return state;
+}
+
+static void
+controller_surface_screenshot(struct wl_client *client,
+                              struct wl_resource *resource,
+                              struct wl_resource *buffer_resource,
+                              uint32_t screenshot_id,
+                              uint32_t surface_id)
+{
+    TRACE_REQUEST(resource);
+    struct ivi_surface_screenshot *state;
+
+    state = queue_surface_screenshot(client, resource, buffer_resource,
+                                     screenshot_id, dump_surface_screenshot);
+    if (state)
+        state->surface_id = surface_id;
+}
+
+static void
+controller_surfaces_thumbnail(struct wl_client *client,
+                              struct wl_resource *resource,
+                              struct wl_resource *buffer_resource,
+                              uint32_t screenshot_id,
+                              int32_t width,
+                              int32_t height,
+                              struct wl_array *surface_ids)
+{
+    TRACE_REQUEST(resource);
+    struct ivi_surface_screenshot *state;
+
+    state = queue_surface_screenshot(client, resource, buffer_resource,
+                                     screenshot_id, dump_surfaces_thumbnail);
+    if (state == NULL)
+        return;
+
+    state->thumb_width = width;
+    state->thumb_height = height;
+    if (wl_array_copy(&state->surface_ids, surface_ids) < 0) {
+        ivi_screenshot_send_error(state->screenshot,
+                IVI_SCREENSHOT_ERROR_NO_MEMORY,
+                "surfaces_thumbnail: failed to copy the surface ids");
+        wl_resource_destroy(state->screenshot);
+    }
+}
+
+static void
+controller_layer_screenshot(struct wl_client *client,
+                            struct wl_resource *resource,
+                            struct wl_resource *buffer_resource,
+                            uint32_t screenshot_id,
+                            uint32_t layer_id)
+{
+    TRACE_REQUEST(resource);
+    struct ivi_surface_screenshot *state;
+
+    state = queue_surface_screenshot(client, resource, buffer_resource,
+                                     screenshot_id, dump_layer_screenshot);
+    if (state)
+        state->layer_id = layer_id;
+}
+
+static void
+controller_set_screenshot_format(struct wl_client *client,
+                                 struct wl_resource *resource,
+                                 uint32_t format)
+{
+    TRACE_REQUEST(resource);
+    struct ivicontroller *ctrl = wl_resource_get_user_data(resource);
+    (void)client;
+
+    /* unsupported formats are reported by the screenshots using them */
+    ctrl->screenshot_format = format;
+}
+
+static void
+controller_get_request_stats(struct wl_client *client,
+                             struct wl_resource *resource)
+{
+    TRACE_REQUEST(resource);
+    struct ivicontroller *ctrl = wl_resource_get_user_data(resource);
+    (void)client;
+
+    ivi_wm_send_request_stats(resource, ctrl->skipped_requests,
+                              ctrl->commits, ctrl->skipped_commits);
+}
+
+static void
+controller_get_scene_export(struct wl_client *client,
+                            struct wl_resource *resource)
+{
+    TRACE_REQUEST(resource);
+    struct ivicontroller *ctrl = wl_resource_get_user_data(resource);
+    struct ivishell *shell = ctrl->shell;
+    (void)client;
+
+    if (!shell->scene_export && create_scene_export(shell) < 0) {
+        ivi_wm_send_surface_error(resource, 0,
+                                  IVI_WM_SURFACE_ERROR_NOT_SUPPORTED,
+                                  "get_scene_export: failed to create the shared memory");
+        return;
+    }
+
+    ivi_wm_send_scene_export(resource, shell->scene_export_fd,
+                             shell->scene_export_size);
+}
+
+static void
+controller_get_client_stats(struct wl_client *client,
+                            struct wl_resource *resource)
+{
+    TRACE_REQUEST(resource);
+    struct ivicontroller *ctrl = wl_resource_get_user_data(resource);
+    struct wl_array requests;
+    uint32_t *count;
+    int i;
+    (void)client;
+
+    wl_array_init(&requests);
+    for (i = 0; i < ivi_wm_interface.method_count &&
+                i < IVI_WM_REQUEST_OPCODES; i++) {
+        count = wl_array_add(&requests, sizeof *count);
+        if (count == NULL) {
+            wl_array_release(&requests);
+            wl_client_post_no_memory(client);
+            return;
+        }
+        *count = ctrl->requests[i];
+    }
+
+    update_commit_window(ctrl);
+
+    ivi_wm_send_client_stats(resource, &requests, ctrl->events,
+                             ctrl->event_bytes > UINT32_MAX ?
+                             UINT32_MAX : (uint32_t)ctrl->event_bytes,
+                             ctrl->commit_rate, ctrl->deferred_commits,
+                             ctrl->coalesced_commits);
+    wl_array_release(&requests);
+}
+
+static void
+controller_set_surface_frame_rate_limit(struct wl_client *client,
+                                        struct wl_resource *resource,
+                                        uint32_t surface_id,
+                                        uint32_t frame_rate)
+{
+    TRACE_REQUEST(resource);
+    struct ivicontroller *ctrl = wl_resource_get_user_data(resource);
+    struct ivisurface *ivisurf;
+    (void)client;
+
+    ivisurf = ivishell_get_surface_from_id(ctrl->shell, surface_id);
+    if (!ivisurf) {
+        ivi_wm_send_surface_error(resource, surface_id,
+                                  IVI_WM_SURFACE_ERROR_NO_SURFACE,
+                                  "set_surface_frame_rate_limit: the surface with given id does not exist");
+        return;
+    }
+
+    ivi_frame_policy_set_frame_rate_limit(ctrl->shell->frame_policy,
+                                          ivisurf, frame_rate);
+}
+
+static int
+compare_interval(const void *a, const void *b)
+{
+    uint32_t ia = *(const uint32_t *)a;
+    uint32_t ib = *(const uint32_t *)b;
+
+    return (ia > ib) - (ia < ib);
+}
+
+static void
+send_surface_frame_stats(struct ivicontroller *ctrl,
+                         struct ivisurface *ivisurf,
+                         uint32_t surface_id)
+{
+    const struct ivi_frame_stats *stats = &ivisurf->frame_stats;
+    uint32_t intervals[IVI_FRAME_STATS_SAMPLES];
+    uint32_t first, cur, prev, i, n = 0;
+    uint32_t last_ms = 0;
+    uint32_t min = 0, avg = 0, max = 0, p99 = 0;
+    uint64_t sum = 0;
+    wl_fixed_t rate = 0;
+
+    if (stats->count > 0) {
+        first = (stats->head + IVI_FRAME_STATS_SAMPLES - stats->count) %
+                IVI_FRAME_STATS_SAMPLES;
+        prev = first;
+        for (i = 1; i < stats->count; i++) {
+            cur = (first + i) % IVI_FRAME_STATS_SAMPLES;
+            intervals[n++] = (uint32_t)(stats->commit_time_us[cur] -
+                                        stats->commit_time_us[prev]);
+            prev = cur;
+        }
+        last_ms = (uint32_t)(stats->commit_time_us[prev] / 1000);
+    }
+
+    if (n > 0) {
+        qsort(intervals, n, sizeof intervals[0], compare_interval);
+
+        for (i = 0; i < n; i++)
+            sum += intervals[i];
+
+        min = intervals[0];
+        max = intervals[n - 1];
+        avg = (uint32_t)(sum / n);
+        /* nearest-rank percentile */
+        p99 = intervals[(n * 99 + 99) / 100 - 1];
+
+        if (sum > 0)
+            rate = wl_fixed_from_double(n * 1000000.0 / sum);
+    }
+
+    ivi_wm_send_surface_frame_stats(ctrl->resource, surface_id, rate,
+                                    min, avg, max, p99,
+                                    stats->superseded, last_ms);
+
+    if (wl_resource_get_version(ctrl->resource) >=
+        IVI_WM_SURFACE_FRAME_RATE_SINCE_VERSION)
+        ivi_wm_send_surface_frame_rate(ctrl->resource, surface_id,
+                ivisurf->frame_rate_limit,
+                wl_fixed_from_double(ivi_frame_policy_get_enforced_rate(
+                        ctrl->shell->frame_policy, ivisurf)),
+                ivisurf->paced_frames);
 }
 
 static void
@@ -522,24 +2197,16 @@ send_surface_stats(struct ivicontroller *ctrl,
                    struct ivi_layout_surface *layout_surface,
                    uint32_t surface_id)
 {
-    const struct ivi_layout_interface *lyt = ctrl->shell->interface;
     struct ivisurface *ivisurf;
-    struct weston_surface *surface;
-    struct wl_client* target_client;
-    pid_t pid;
-    uid_t uid;
-    gid_t gid;
-
-    ivisurf = get_surface(&ctrl->shell->list_surface, layout_surface);
-
-    /* Get pid that creates surface */
-    surface = lyt->surface_get_weston_surface(layout_surface);
 
-    target_client = wl_resource_get_client(surface->resource);
+    ivisurf = ivishell_get_surface(ctrl->shell, layout_surface);
 
-    wl_client_get_credentials(target_client, &pid, &uid, &gid);
+    ivi_wm_send_surface_stats(ctrl->resource, surface_id, ivisurf->frame_count,
+                              ivisurf->pid);
 
-    ivi_wm_send_surface_stats(ctrl->resource, surface_id, ivisurf->frame_count, pid);
+    if (wl_resource_get_version(ctrl->resource) >=
+        IVI_WM_SURFACE_FRAME_STATS_SINCE_VERSION)
+        send_surface_frame_stats(ctrl, ivisurf, surface_id);
 }
 
 static void
@@ -548,6 +2215,7 @@ controller_surface_sync(struct wl_client *client,
                               uint32_t surface_id,
                               int32_t sync_state)
 {
+    TRACE_REQUEST(resource);
     struct ivicontroller *ctrl = wl_resource_get_user_data(resource);
     const struct ivi_layout_interface *lyt = ctrl->shell->interface;
     struct ivi_layout_surface *layout_surface;
@@ -563,12 +2231,12 @@ controller_surface_sync(struct wl_client *client,
         return;
     }
 
-    ivisurf = get_surface(&ctrl->shell->list_surface, layout_surface);
+    ivisurf = ivishell_get_surface(ctrl->shell, layout_surface);
 
     switch (sync_state) {
     case IVI_WM_SYNC_ADD:
         /*Check if a notification for the surface is already initialized*/
-        noti= calloc(1, sizeof *noti);
+        noti = create_notification(resource, ivisurf, NULL);
         if (noti == NULL) {
             wl_resource_post_no_memory(resource);
             return;
@@ -576,15 +2244,12 @@ controller_surface_sync(struct wl_client *client,
 
         wl_list_insert(&ctrl->surface_notifications, &noti->link);
         wl_list_insert(&ivisurf->notification_list, &noti->layout_link);
-        noti->resource = resource;
         break;
     case IVI_WM_SYNC_REMOVE:
         wl_list_for_each(noti, &ivisurf->notification_list, layout_link)
         {
             if (noti->resource == resource) {
-                wl_list_remove(&noti->link);
-                wl_list_remove(&noti->layout_link);
-                free(noti);
+                destroy_notification(noti);
                 break;
             }
         }
@@ -600,6 +2265,7 @@ static void
 controller_set_surface_type(struct wl_client *client, struct wl_resource *resource,
                             uint32_t surface_id, int32_t type)
 {
+    TRACE_REQUEST(resource);
     struct ivicontroller *ctrl = wl_resource_get_user_data(resource);
     const struct ivi_layout_interface *lyt = ctrl->shell->interface;
     (void)client;
@@ -614,7 +2280,7 @@ controller_set_surface_type(struct wl_client *client, struct wl_resource *resour
         return;
     }
 
-    ivisurf = get_surface(&ctrl->shell->list_surface, layout_surface);
+    ivisurf = ivishell_get_surface(ctrl->shell, layout_surface);
     ivisurf->type = type;
 }
 
@@ -642,6 +2308,7 @@ static void
 controller_surface_get(struct wl_client *client, struct wl_resource *resource,
                             uint32_t surface_id, int32_t param)
 {
+    TRACE_REQUEST(resource);
     struct ivicontroller *ctrl = wl_resource_get_user_data(resource);
     const struct ivi_layout_interface *lyt = ctrl->shell->interface;
     (void)client;
@@ -674,10 +2341,12 @@ controller_set_layer_source_rectangle(struct wl_client *client,
                    int32_t width,
                    int32_t height)
 {
+    TRACE_REQUEST(resource);
     struct ivicontroller *ctrl = wl_resource_get_user_data(resource);
     const struct ivi_layout_interface *lyt = ctrl->shell->interface;
     (void)client;
     struct ivi_layout_layer *layout_layer;
+    struct ivilayer *ivilayer;
     const struct ivi_layout_layer_properties *prop;
 
     layout_layer = lyt->get_layer_from_id(layer_id);
@@ -688,7 +2357,8 @@ controller_set_layer_source_rectangle(struct wl_client *client,
         return;
     }
 
-    prop = lyt->get_properties_of_layer(layout_layer);
+    ivilayer = get_layer(ctrl->shell, layout_layer);
+    prop = ivilayer->prop;
 
     if (x < 0)
         x = prop->source_x;
@@ -699,8 +2369,16 @@ controller_set_layer_source_rectangle(struct wl_client *client,
     if (height < 0)
         height = prop->source_height;
 
+    if (layer_request_is_redundant(ivilayer, IVI_NOTIFICATION_SOURCE_RECT,
+            prop->source_x == x && prop->source_y == y &&
+            prop->source_width == width && prop->source_height == height)) {
+        ctrl->skipped_requests++;
+        return;
+    }
+
     lyt->layer_set_source_rectangle(layout_layer,
            (uint32_t)x, (uint32_t)y, (uint32_t)width, (uint32_t)height);
+    ctrl->shell->pending_changes++;
 }
 
 static void
@@ -712,10 +2390,12 @@ controller_set_layer_destination_rectangle(struct wl_client *client,
                  int32_t width,
                  int32_t height)
 {
+    TRACE_REQUEST(resource);
     struct ivicontroller *ctrl = wl_resource_get_user_data(resource);
     const struct ivi_layout_interface *lyt = ctrl->shell->interface;
     (void)client;
     struct ivi_layout_layer *layout_layer;
+    struct ivilayer *ivilayer;
     const struct ivi_layout_layer_properties *prop;
 
     layout_layer = lyt->get_layer_from_id(layer_id);
@@ -726,7 +2406,8 @@ controller_set_layer_destination_rectangle(struct wl_client *client,
         return;
     }
 
-    prop = lyt->get_properties_of_layer(layout_layer);
+    ivilayer = get_layer(ctrl->shell, layout_layer);
+    prop = ivilayer->prop;
 
     if (x < 0)
         x = prop->dest_x;
@@ -737,8 +2418,16 @@ controller_set_layer_destination_rectangle(struct wl_client *client,
     if (height < 0)
         height = prop->dest_height;
 
+    if (layer_request_is_redundant(ivilayer, IVI_NOTIFICATION_DEST_RECT,
+            prop->dest_x == x && prop->dest_y == y &&
+            prop->dest_width == width && prop->dest_height == height)) {
+        ctrl->skipped_requests++;
+        return;
+    }
+
     lyt->layer_set_destination_rectangle(layout_layer,
             (uint32_t)x, (uint32_t)y, (uint32_t)width, (uint32_t)height);
+    ctrl->shell->pending_changes++;
 }
 
 static void
@@ -747,10 +2436,12 @@ controller_set_layer_visibility(struct wl_client *client,
                     uint32_t layer_id,
                     uint32_t visibility)
 {
+    TRACE_REQUEST(resource);
     struct ivicontroller *ctrl = wl_resource_get_user_data(resource);
     const struct ivi_layout_interface *lyt = ctrl->shell->interface;
     (void)client;
     struct ivi_layout_layer *layout_layer;
+    struct ivilayer *ivilayer;
 
     layout_layer = lyt->get_layer_from_id(layer_id);
     if (!layout_layer) {
@@ -760,7 +2451,15 @@ controller_set_layer_visibility(struct wl_client *client,
         return;
     }
 
+    ivilayer = get_layer(ctrl->shell, layout_layer);
+    if (layer_request_is_redundant(ivilayer, IVI_NOTIFICATION_VISIBILITY,
+            ivilayer->prop->visibility == !!visibility)) {
+        ctrl->skipped_requests++;
+        return;
+    }
+
     lyt->layer_set_visibility(layout_layer, visibility);
+    ctrl->shell->pending_changes++;
 }
 
 static void
@@ -769,10 +2468,12 @@ controller_set_layer_opacity(struct wl_client *client,
                  uint32_t layer_id,
                  wl_fixed_t opacity)
 {
+    TRACE_REQUEST(resource);
     struct ivicontroller *ctrl = wl_resource_get_user_data(resource);
     const struct ivi_layout_interface *lyt = ctrl->shell->interface;
     (void)client;
     struct ivi_layout_layer *layout_layer;
+    struct ivilayer *ivilayer;
 
     layout_layer = lyt->get_layer_from_id(layer_id);
     if (!layout_layer) {
@@ -782,7 +2483,15 @@ controller_set_layer_opacity(struct wl_client *client,
         return;
     }
 
+    ivilayer = get_layer(ctrl->shell, layout_layer);
+    if (layer_request_is_redundant(ivilayer, IVI_NOTIFICATION_OPACITY,
+            ivilayer->prop->opacity == opacity)) {
+        ctrl->skipped_requests++;
+        return;
+    }
+
     lyt->layer_set_opacity(layout_layer, opacity);
+    ctrl->shell->pending_changes++;
 }
 
 static void
@@ -790,6 +2499,7 @@ controller_layer_clear(struct wl_client *client,
                     struct wl_resource *resource,
                     uint32_t layer_id)
 {
+    TRACE_REQUEST(resource);
     struct ivicontroller *ctrl = wl_resource_get_user_data(resource);
     const struct ivi_layout_interface *lyt = ctrl->shell->interface;
     (void)client;
@@ -804,6 +2514,7 @@ controller_layer_clear(struct wl_client *client,
     }
 
     lyt->layer_set_render_order(layout_layer, NULL, 0);
+    ctrl->shell->pending_changes++;
 }
 
 static void
@@ -927,6 +2638,7 @@ controller_layer_add_surface(struct wl_client *client,
                  uint32_t layer_id,
                  uint32_t surface_id)
 {
+    TRACE_REQUEST(resource);
     struct ivicontroller *ctrl = wl_resource_get_user_data(resource);
     const struct ivi_layout_interface *lyt = ctrl->shell->interface;
     (void)client;
@@ -950,6 +2662,7 @@ controller_layer_add_surface(struct wl_client *client,
     }
 
     lyt->layer_add_surface(layout_layer, layout_surface);
+    ctrl->shell->pending_changes++;
 }
 
 static void
@@ -958,6 +2671,7 @@ controller_layer_remove_surface(struct wl_client *client,
                     uint32_t layer_id,
                     uint32_t surface_id)
 {
+    TRACE_REQUEST(resource);
     struct ivicontroller *ctrl = wl_resource_get_user_data(resource);
     const struct ivi_layout_interface *lyt = ctrl->shell->interface;
     (void)client;
@@ -981,6 +2695,7 @@ controller_layer_remove_surface(struct wl_client *client,
     }
 
     lyt->layer_remove_surface(layout_layer, layout_surface);
+    ctrl->shell->pending_changes++;
 }
 
 static void
@@ -989,6 +2704,7 @@ controller_layer_sync(struct wl_client *client,
                       uint32_t layer_id,
                       int32_t sync_state)
 {
+    TRACE_REQUEST(resource);
     struct ivicontroller *ctrl = wl_resource_get_user_data(resource);
     const struct ivi_layout_interface *lyt = ctrl->shell->interface;
     struct ivi_layout_layer *layout_layer;
@@ -1004,12 +2720,12 @@ controller_layer_sync(struct wl_client *client,
         return;
     }
 
-    ivilayer = get_layer(&ctrl->shell->list_layer, layout_layer);
+    ivilayer = get_layer(ctrl->shell, layout_layer);
 
     switch (sync_state) {
     case IVI_WM_SYNC_ADD:
         /*Check if a notification for the surface is already initialized*/
-        noti= calloc(1, sizeof *noti);
+        noti = create_notification(resource, NULL, ivilayer);
         if (noti == NULL) {
             wl_resource_post_no_memory(resource);
             return;
@@ -1017,17 +2733,14 @@ controller_layer_sync(struct wl_client *client,
 
         wl_list_insert(&ctrl->layer_notifications, &noti->link);
         wl_list_insert(&ivilayer->notification_list, &noti->layout_link);
-        noti->resource = resource;
         break;
     case IVI_WM_SYNC_REMOVE:
-        ivilayer = get_layer(&ctrl->shell->list_layer, layout_layer);
+        ivilayer = get_layer(ctrl->shell, layout_layer);
 
         wl_list_for_each(noti, &ivilayer->notification_list, layout_link)
         {
             if (noti->resource == resource) {
-                wl_list_remove(&noti->link);
-                wl_list_remove(&noti->layout_link);
-                free(noti);
+                destroy_notification(noti);
                 break;
             }
         }
@@ -1045,19 +2758,24 @@ controller_create_layout_layer(struct wl_client *client,
                     struct wl_resource *resource, uint32_t layer_id,
                     int width, int height)
 {
+    TRACE_REQUEST(resource);
     struct ivicontroller *ctrl = wl_resource_get_user_data(resource);
     const struct ivi_layout_interface *lyt = ctrl->shell->interface;
     (void)client;
 
      if(lyt->layer_create_with_dimension(layer_id, width, height) == NULL) {
          wl_resource_post_no_memory(resource);
+         return;
      }
+
+    ctrl->shell->pending_changes++;
 }
 
 static void
 controller_destroy_layout_layer(struct wl_client *client,
                     struct wl_resource *resource, uint32_t layer_id)
 {
+    TRACE_REQUEST(resource);
     struct ivicontroller *ctrl = wl_resource_get_user_data(resource);
     const struct ivi_layout_interface *lyt = ctrl->shell->interface;
     (void)client;
@@ -1072,21 +2790,39 @@ controller_destroy_layout_layer(struct wl_client *client,
     }
 
     lyt->layer_destroy(layout_layer);
+    ctrl->shell->pending_changes++;
+}
+
+static void
+send_layer_render_order(struct ivicontroller *ctrl,
+                        struct ivi_layout_layer *layout_layer,
+                        uint32_t layer_id)
+{
+    const struct ivi_layout_interface *lyt = ctrl->shell->interface;
+    struct ivi_layout_surface **surf_list = NULL;
+    int32_t surface_count, i;
+    uint32_t id;
+
+    lyt->get_surfaces_on_layer(layout_layer, &surface_count, &surf_list);
+    for (i = 0; i < surface_count; i++) {
+        id = lyt->get_id_of_surface(surf_list[i]);
+        ivi_wm_send_layer_surface_added(ctrl->resource, layer_id, id);
+    }
+
+    free(surf_list);
 }
 
 static void
 controller_layer_get(struct wl_client *client, struct wl_resource *resource,
                      uint32_t layer_id, int32_t param)
 {
+    TRACE_REQUEST(resource);
     struct ivicontroller *ctrl = wl_resource_get_user_data(resource);
     const struct ivi_layout_interface *lyt = ctrl->shell->interface;
     (void)client;
     struct ivi_layout_layer *layout_layer;
     const struct ivi_layout_layer_properties *prop;
     enum ivi_layout_notification_mask mask;
-    struct ivi_layout_surface **surf_list = NULL;
-    int32_t surface_count, i;
-    uint32_t id;
 
     layout_layer = lyt->get_layer_from_id(layer_id);
     if (!layout_layer) {
@@ -1100,15 +2836,8 @@ controller_layer_get(struct wl_client *client, struct wl_resource *resource,
     prop = lyt->get_properties_of_layer(layout_layer);
     send_layer_event(ctrl, layout_layer, layer_id, prop, mask);
 
-    if (param & IVI_WM_PARAM_RENDER_ORDER) {
-        lyt->get_surfaces_on_layer(layout_layer, &surface_count, &surf_list);
-        for (i = 0; i < surface_count; i++) {
-            id = lyt->get_id_of_surface(surf_list[i]);
-            ivi_wm_send_layer_surface_added(ctrl->resource, layer_id, id);
-        }
-
-        free(surf_list);
-    }
+    if (param & IVI_WM_PARAM_RENDER_ORDER)
+        send_layer_render_order(ctrl, layout_layer, layer_id);
 }
 
 static void
@@ -1135,6 +2864,7 @@ controller_screen_clear(struct wl_client *client,
 
     lyt = iviscrn->shell->interface;
     lyt->screen_set_render_order(iviscrn->output, NULL, 0);
+    iviscrn->shell->pending_changes++;
 }
 
 static void
@@ -1163,6 +2893,7 @@ controller_screen_add_layer(struct wl_client *client,
     }
 
     lyt->screen_add_layer(iviscrn->output, layout_layer);
+    iviscrn->shell->pending_changes++;
 }
 
 static void
@@ -1191,6 +2922,7 @@ controller_screen_remove_layer(struct wl_client *client,
     }
 
     lyt->screen_remove_layer(iviscrn->output, layout_layer);
+    iviscrn->shell->pending_changes++;
 }
 
 static void
@@ -1277,17 +3009,58 @@ free:
     free(screenshooter);
 }
 
+static void
+send_screen_stats(struct iviscreen *iviscrn, struct wl_resource *resource)
+{
+    const struct ivi_repaint_stats *stats = &iviscrn->repaint_stats;
+    struct wl_array histogram;
+    uint32_t *buckets;
+    uint32_t present_delay_avg = 0;
+
+    wl_array_init(&histogram);
+    buckets = wl_array_add(&histogram, sizeof stats->frame_time_hist);
+    if (buckets == NULL) {
+        wl_resource_post_no_memory(resource);
+        return;
+    }
+    memcpy(buckets, stats->frame_time_hist, sizeof stats->frame_time_hist);
+
+    if (stats->frames > 0)
+        present_delay_avg =
+            (uint32_t)(stats->present_delay_sum_us / stats->frames);
+
+    ivi_wm_screen_send_stats(resource, stats->frames, stats->missed_vblanks,
+                             present_delay_avg, stats->present_delay_max_us,
+                             &histogram);
+
+    wl_array_release(&histogram);
+}
+
+static void
+send_screen_render_order(struct iviscreen *iviscrn, struct wl_resource *resource)
+{
+    const struct ivi_layout_interface *lyt = iviscrn->shell->interface;
+    struct ivi_layout_layer **layer_list = NULL;
+    int32_t layer_count, i;
+    uint32_t id;
+
+    lyt->get_layers_on_screen(iviscrn->output, &layer_count, &layer_list);
+
+    for (i = 0; i < layer_count; i++) {
+        id = lyt->get_id_of_layer(layer_list[i]);
+        ivi_wm_screen_send_layer_added(resource, id);
+    }
+
+    free(layer_list);
+}
+
 static void
 controller_screen_get(struct wl_client *client,
                        struct wl_resource *resource,
                        int32_t param)
 {
     struct iviscreen *iviscrn = wl_resource_get_user_data(resource);
-    const struct ivi_layout_interface *lyt;
     (void)client;
-    struct ivi_layout_layer **layer_list = NULL;
-    int32_t layer_count, i;
-    uint32_t id;
 
     if (!iviscrn) {
         ivi_wm_screen_send_error(resource, IVI_WM_SCREEN_ERROR_NO_SCREEN,
@@ -1295,18 +3068,12 @@ controller_screen_get(struct wl_client *client,
         return;
     }
 
-    lyt = iviscrn->shell->interface;
-
-    if (param & IVI_WM_PARAM_RENDER_ORDER) {
-        lyt->get_layers_on_screen(iviscrn->output, &layer_count, &layer_list);
-
-        for (i = 0; i < layer_count; i++) {
-            id = lyt->get_id_of_layer(layer_list[i]);
-            ivi_wm_screen_send_layer_added(resource, id);
-	}
+    if (param & IVI_WM_PARAM_RENDER_ORDER)
+        send_screen_render_order(iviscrn, resource);
 
-        free(layer_list);
-    }
+    if ((param & IVI_WM_PARAM_STATS) &&
+        wl_resource_get_version(resource) >= IVI_WM_SCREEN_STATS_SINCE_VERSION)
+        send_screen_stats(iviscrn, resource);
 }
 
 static const
@@ -1319,18 +3086,142 @@ struct ivi_wm_screen_interface controller_screen_implementation = {
     controller_screen_get
 };
 
+/* Starts a new commit window if the current one is over */
 static void
-controller_commit_changes(struct wl_client *client,
-                          struct wl_resource *resource)
+update_commit_window(struct ivicontroller *controller)
+{
+    struct timespec now;
+    int64_t now_ms;
+
+    ivi_weston_compositor_read_presentation_clock(controller->shell->compositor,
+                                                  &now);
+    now_ms = timespec_to_msec(&now);
+
+    if (now_ms - controller->commit_window_ms < 1000)
+        return;
+
+    controller->commit_rate = (now_ms - controller->commit_window_ms < 2000) ?
+                              controller->window_commits : 0;
+    controller->commit_window_ms = now_ms;
+    controller->window_commits = 0;
+}
+
+static void
+apply_commit(struct ivicontroller *controller)
 {
+    struct ivishell *shell = controller->shell;
+    struct ivisurface *ivisurf, *next_surf;
+    struct ivilayer *ivilayer, *next_layer;
+    struct ivi_trace_span span;
+    uint32_t changes;
     int32_t ans = 0;
-    (void)client;
-    struct ivicontroller *controller = wl_resource_get_user_data(resource);
 
-    ans = controller->shell->interface->commit_changes();
+    /* Nothing was requested through ivi-controller since the last
+     * commit. ivi-layout does not tell whether other modules have changes
+     * pending, so the commit is still forwarded, only counted apart. */
+    if (shell->pending_changes == 0) {
+        controller->skipped_commits++;
+        if (shell->interface->commit_changes() < 0)
+            weston_log("Failed to commit changes at controller_commit_changes\n");
+        return;
+    }
+
+    ivi_trace_span_begin(shell->trace, &span, "commit", "commit",
+                         controller->resource);
+
+    update_commit_window(controller);
+    controller->window_commits++;
+    controller->commits++;
+    changes = shell->pending_changes;
+    shell->pending_changes = 0;
+
+    /* requests which ivi-layout found to change nothing emit no
+     * property_changed, which would clear the mask */
+    wl_list_for_each_safe(ivisurf, next_surf, &shell->pending_surfaces,
+                          pending_link) {
+        ivisurf->pending_mask = 0;
+        wl_list_remove(&ivisurf->pending_link);
+        wl_list_init(&ivisurf->pending_link);
+    }
+    wl_list_for_each_safe(ivilayer, next_layer, &shell->pending_layers,
+                          pending_link) {
+        ivilayer->pending_mask = 0;
+        wl_list_remove(&ivilayer->pending_link);
+        wl_list_init(&ivilayer->pending_link);
+    }
+
+    ans = shell->interface->commit_changes();
     if (ans < 0) {
         weston_log("Failed to commit changes at controller_commit_changes\n");
     }
+
+    ivi_trace_span_end(&span, "\"changes\":%u", changes);
+
+    ivi_frame_policy_schedule_update(controller->shell->frame_policy);
+    notify_scene_changed(controller->shell);
+}
+
+static int
+deferred_commit(void *data)
+{
+    struct ivicontroller *controller = data;
+
+    controller->commit_deferred = false;
+    apply_commit(controller);
+
+    return 0;
+}
+
+static void
+controller_commit_changes(struct wl_client *client,
+                          struct wl_resource *resource)
+{
+    TRACE_REQUEST(resource);
+    struct ivicontroller *controller = wl_resource_get_user_data(resource);
+    struct ivishell *shell = controller->shell;
+    struct wl_event_loop *loop;
+    struct timespec now;
+    int64_t delay_ms;
+    (void)client;
+
+    if (controller->commit_deferred) {
+        /* applied together with the deferred commit */
+        controller->coalesced_commits++;
+        return;
+    }
+
+    if (shell->commit_budget == 0 || shell->pending_changes == 0) {
+        apply_commit(controller);
+        return;
+    }
+
+    update_commit_window(controller);
+    if (controller->window_commits < shell->commit_budget) {
+        apply_commit(controller);
+        return;
+    }
+
+    /* The client used up its commits of this second, apply it when the
+     * next second starts instead of repainting for it now. The pending
+     * state of ivi-layout is shared, so a commit of another controller
+     * or module applies the requests of this client meanwhile. */
+    if (controller->commit_timer == NULL) {
+        loop = wl_display_get_event_loop(shell->compositor->wl_display);
+        controller->commit_timer =
+            wl_event_loop_add_timer(loop, deferred_commit, controller);
+        if (controller->commit_timer == NULL) {
+            apply_commit(controller);
+            return;
+        }
+    }
+
+    ivi_weston_compositor_read_presentation_clock(shell->compositor, &now);
+    delay_ms = controller->commit_window_ms + 1000 - timespec_to_msec(&now);
+    wl_event_source_timer_update(controller->commit_timer,
+                                 delay_ms > 0 ? delay_ms : 1);
+
+    controller->commit_deferred = true;
+    controller->deferred_commits++;
 }
 
 static void
@@ -1339,6 +3230,7 @@ controller_create_screen(struct wl_client *client,
                         struct wl_resource *output_resource,
                         uint32_t id)
 {
+    TRACE_REQUEST(resource);
     struct weston_head *weston_head =
         wl_resource_get_user_data(output_resource);
     struct wl_resource *screen_resource;
@@ -1351,7 +3243,8 @@ controller_create_screen(struct wl_client *client,
             continue;
         }
 
-        screen_resource = wl_resource_create(client, &ivi_wm_screen_interface, 1, id);
+        screen_resource = wl_resource_create(client, &ivi_wm_screen_interface,
+                                             wl_resource_get_version(resource), id);
         if (screen_resource == NULL) {
             wl_resource_post_no_memory(resource);
             return;
@@ -1365,6 +3258,12 @@ controller_create_screen(struct wl_client *client,
 
         ivi_wm_screen_send_screen_id(screen_resource, iviscrn->id_screen);
         ivi_wm_screen_send_connector_name(screen_resource, iviscrn->output->name);
+
+        /* Controllers receiving the initial state get the render
+         * order of the screen without asking for it */
+        if (wl_resource_get_version(resource) >=
+            IVI_WM_INITIAL_STATE_DONE_SINCE_VERSION)
+            send_screen_render_order(iviscrn, screen_resource);
     }
 }
 
@@ -1389,16 +3288,168 @@ static const struct ivi_wm_interface controller_implementation = {
     controller_layer_add_surface,
     controller_layer_remove_surface,
     controller_create_layout_layer,
-    controller_destroy_layout_layer
+    controller_destroy_layout_layer,
+    controller_surfaces_thumbnail,
+    controller_layer_screenshot,
+    controller_set_screenshot_format,
+    controller_set_surface_frame_rate_limit,
+    controller_get_request_stats,
+    controller_get_scene_export,
+    controller_get_client_stats
 };
 
+/* Size of a message on the wire, without file descriptors */
+static uint32_t
+message_size(const struct wl_protocol_logger_message *message)
+{
+    const char *signature = message->message->signature;
+    const char *string;
+    struct wl_array *array;
+    uint32_t size = 8;
+    int i = 0;
+
+    for (; *signature; signature++) {
+        switch (*signature) {
+        case 'i':
+        case 'u':
+        case 'f':
+        case 'o':
+        case 'n':
+            size += 4;
+            i++;
+            break;
+        case 's':
+            string = message->arguments[i++].s;
+            size += 4 + (string ? (strlen(string) + 4) & ~3u : 0);
+            break;
+        case 'a':
+            array = message->arguments[i++].a;
+            size += 4 + (array ? (array->size + 3) & ~3u : 0);
+            break;
+        case 'h':
+            i++;
+            break;
+        default:
+            /* version and nullability */
+            break;
+        }
+    }
+
+    return size;
+}
+
+static void
+count_controller_message(void *user_data,
+                         enum wl_protocol_logger_type type,
+                         const struct wl_protocol_logger_message *message)
+{
+    struct ivicontroller *ctrl;
+    (void)user_data;
+
+    /* called for every message of every client, so other interfaces
+     * are filtered by the address of their name first */
+    if (wl_resource_get_class(message->resource) != ivi_wm_interface.name)
+        return;
+
+    if (!wl_resource_instance_of(message->resource, &ivi_wm_interface,
+                                 &controller_implementation))
+        return;
+
+    ctrl = wl_resource_get_user_data(message->resource);
+    if (ctrl == NULL)
+        return;
+
+    if (type == WL_PROTOCOL_LOGGER_REQUEST) {
+        if (message->message_opcode < IVI_WM_REQUEST_OPCODES)
+            ctrl->requests[message->message_opcode]++;
+    } else {
+        ctrl->events++;
+        ctrl->event_bytes += message_size(message);
+    }
+}
+
+/* Dumps the counters of every controller to a subscriber of the
+ * ivi-controller-clients debug scope */
+static void
+print_client_stats(struct weston_log_subscription *subscription, void *data)
+{
+    struct ivishell *shell = data;
+    struct ivicontroller *ctrl;
+    pid_t pid;
+    uid_t uid;
+    gid_t gid;
+    int i;
+
+    wl_list_for_each(ctrl, &shell->list_controller, link) {
+        wl_client_get_credentials(ctrl->client, &pid, &uid, &gid);
+        update_commit_window(ctrl);
+
+        weston_log_subscription_printf(subscription,
+                "client %d ivi_wm@%u: commits %u (%u/s), skipped %u, "
+                "deferred %u, coalesced %u, skipped requests %u, "
+                "events %u (%llu bytes)\n",
+                pid, ctrl->id, ctrl->commits, ctrl->commit_rate,
+                ctrl->skipped_commits, ctrl->deferred_commits,
+                ctrl->coalesced_commits, ctrl->skipped_requests,
+                ctrl->events, (unsigned long long)ctrl->event_bytes);
+
+        for (i = 0; i < ivi_wm_interface.method_count &&
+                    i < IVI_WM_REQUEST_OPCODES; i++) {
+            if (ctrl->requests[i] == 0)
+                continue;
+            weston_log_subscription_printf(subscription, "\t%s %u\n",
+                    ivi_wm_interface.methods[i].name, ctrl->requests[i]);
+        }
+    }
+
+    weston_log_subscription_complete(subscription);
+}
+
+/* Sends every surface and layer together with its properties and the
+ * render order of the layers, so a new controller does not need a get
+ * request per object to learn the scene.
+ */
+static void
+send_initial_state(struct ivicontroller *ctrl)
+{
+    struct ivishell *shell = ctrl->shell;
+    const struct ivi_layout_interface *lyt = shell->interface;
+    struct ivisurface *ivisurf;
+    struct ivilayer *ivilayer;
+    uint32_t surface_id, layer_id;
+    uint32_t mask = IVI_NOTIFICATION_OPACITY | IVI_NOTIFICATION_SOURCE_RECT |
+                    IVI_NOTIFICATION_DEST_RECT | IVI_NOTIFICATION_VISIBILITY |
+                    IVI_NOTIFICATION_CONFIGURE;
+
+    wl_list_for_each_reverse(ivisurf, &shell->list_surface, link) {
+        surface_id = lyt->get_id_of_surface(ivisurf->layout_surface);
+        ivi_wm_send_surface_created(ctrl->resource, surface_id);
+        send_surface_event(ctrl, ivisurf->layout_surface, surface_id,
+                           ivisurf->prop, mask);
+        send_surface_stats(ctrl, ivisurf->layout_surface, surface_id);
+        if (ivisurf->occluded &&
+            wl_resource_get_version(ctrl->resource) >=
+            IVI_WM_SURFACE_OCCLUSION_SINCE_VERSION)
+            ivi_wm_send_surface_occlusion(ctrl->resource, surface_id, 1);
+    }
+
+    wl_list_for_each_reverse(ivilayer, &shell->list_layer, link) {
+        layer_id = lyt->get_id_of_layer(ivilayer->layout_layer);
+        ivi_wm_send_layer_created(ctrl->resource, layer_id);
+        send_layer_event(ctrl, ivilayer->layout_layer, layer_id,
+                         ivilayer->prop, mask);
+        send_layer_render_order(ctrl, ivilayer->layout_layer, layer_id);
+    }
+
+    ivi_wm_send_initial_state_done(ctrl->resource);
+}
+
 static void
 bind_ivi_controller(struct wl_client *client, void *data,
                     uint32_t version, uint32_t id)
 {
     struct ivishell *shell = data;
     struct ivicontroller *controller;
-    (void)version;
     uint32_t surface_id, layer_id;
     struct ivisurface *ivisurf;
     struct ivilayer *ivilayer;
@@ -1417,6 +3468,7 @@ bind_ivi_controller(struct wl_client *client, void *data,
         wl_client_post_no_memory(client);
         return;
     }
+    controller->screenshot_format = WL_SHM_FORMAT_ABGR8888;
 
     controller->resource =
         wl_resource_create(client, &ivi_wm_interface, version, id);
@@ -1437,6 +3489,12 @@ bind_ivi_controller(struct wl_client *client, void *data,
     wl_list_insert(&shell->list_controller, &controller->link);
     wl_list_init(&controller->surface_notifications);
     wl_list_init(&controller->layer_notifications);
+    wl_list_init(&controller->dirty_notifications);
+
+    if (version >= IVI_WM_INITIAL_STATE_DONE_SINCE_VERSION) {
+        send_initial_state(controller);
+        return;
+    }
 
     wl_list_for_each_reverse(ivisurf, &shell->list_surface, link) {
         surface_id = shell->interface->get_id_of_surface(ivisurf->layout_surface);
@@ -1449,6 +3507,65 @@ bind_ivi_controller(struct wl_client *client, void *data,
     }
 }
 
+/* The frame signal is emitted when the repaint of the output has been
+ * submitted. The presentation of the previous repaint is known by then,
+ * so the statistics of a frame are updated one frame later.
+ */
+static void
+output_frame_event(struct wl_listener *listener, void *data)
+{
+    struct iviscreen *iviscrn =
+            wl_container_of(listener, iviscrn, output_frame);
+    struct ivi_repaint_stats *stats = &iviscrn->repaint_stats;
+    struct weston_output *output = iviscrn->output;
+    struct timespec now;
+    int64_t presented_us, period_us = 0, delay_us, frame_us;
+    uint32_t i;
+    (void)data;
+
+    if (output->current_mode && output->current_mode->refresh > 0)
+        period_us = 1000000000LL / output->current_mode->refresh;
+
+    presented_us = timespec_to_usec(&output->frame_time);
+
+    if (stats->repaint_pending && presented_us > stats->repaint_us) {
+        delay_us = presented_us - stats->repaint_us;
+
+        stats->frames++;
+        stats->present_delay_sum_us += delay_us;
+        if (delay_us > stats->present_delay_max_us)
+            stats->present_delay_max_us = (uint32_t)delay_us;
+
+        if (period_us > 0 && delay_us > period_us)
+            stats->missed_vblanks += (uint32_t)(delay_us / period_us);
+
+        /* a repaint later than one period after the last presentation
+         * means the output was idle, it is not a frame time */
+        if (stats->presented_us > 0 &&
+            (period_us == 0 ||
+             stats->repaint_us - stats->presented_us <= period_us)) {
+            frame_us = presented_us - stats->presented_us;
+
+            for (i = 0; i < IVI_SCREEN_FRAME_TIME_BUCKETS - 1; i++) {
+                if (frame_us <= frame_time_bucket_ms[i] * 1000)
+                    break;
+            }
+            stats->frame_time_hist[i]++;
+        }
+
+        stats->presented_us = presented_us;
+    }
+
+    /* frame_signal is emitted once the repaint was submitted, libweston
+     * has no signal at its start */
+    ivi_weston_compositor_read_presentation_clock(output->compositor, &now);
+    stats->repaint_us = timespec_to_usec(&now);
+    stats->repaint_pending = true;
+
+    /* surfaces committed new frames for this repaint */
+    schedule_scene_export(iviscrn->shell, false);
+}
+
 static void
 create_screen(struct ivishell *shell, struct weston_output *output)
 {
@@ -1480,6 +3597,9 @@ create_screen(struct ivishell *shell, struct weston_output *output)
     wl_list_insert(&shell->list_screen, &iviscrn->link);
     wl_list_init(&iviscrn->resource_list);
 
+    iviscrn->output_frame.notify = output_frame_event;
+    wl_signal_add(&output->frame_signal, &iviscrn->output_frame);
+
     return;
 }
 
@@ -1493,6 +3613,7 @@ destroy_screen(struct iviscreen *iviscrn)
         wl_resource_destroy(resource);
     }
 
+    wl_list_remove(&iviscrn->output_frame.link);
     wl_list_remove(&iviscrn->link);
     free(iviscrn);
 }
@@ -1510,6 +3631,9 @@ output_destroyed_event(struct wl_listener *listener, void *data)
             destroy_screen(iviscrn);
     }
 
+    ivi_frame_policy_schedule_update(shell->frame_policy);
+    notify_scene_changed(shell);
+
     if (shell->bkgnd_view && shell->client)
         set_bkgnd_surface_prop(shell);
     else
@@ -1532,6 +3656,8 @@ output_created_event(struct wl_listener *listener, void *data)
     struct weston_output *created_output = (struct weston_output*)data;
 
     create_screen(shell, created_output);
+    ivi_frame_policy_schedule_update(shell->frame_policy);
+    notify_scene_changed(shell);
 
     if (shell->bkgnd_view && shell->client)
         set_bkgnd_surface_prop(shell);
@@ -1557,7 +3683,10 @@ create_layer(struct ivishell *shell,
     ivilayer->shell = shell;
     wl_list_insert(&shell->list_layer, &ivilayer->link);
     wl_list_init(&ivilayer->notification_list);
+    wl_list_init(&ivilayer->pending_link);
     ivilayer->layout_layer = layout_layer;
+    hash_table_insert(&shell->layer_ptr_index, &ivilayer->ptr_entry,
+                      ivi_hash_ptr(layout_layer));
     ivilayer->prop = lyt->get_properties_of_layer(layout_layer);
 
     ivilayer->property_changed.notify = send_layer_prop;
@@ -1575,9 +3704,35 @@ static void
 surface_committed(struct wl_listener *listener, void *data)
 {
     struct ivisurface *ivisurf = wl_container_of(listener, ivisurf, committed);
+    struct ivi_frame_stats *stats = &ivisurf->frame_stats;
+    struct weston_surface *surface;
+    struct timespec now;
+    uint32_t last;
     (void)data;
 
     ivisurf->frame_count++;
+
+    surface = ivisurf->shell->interface->surface_get_weston_surface(
+            ivisurf->layout_surface);
+    ivi_weston_compositor_read_presentation_clock(ivisurf->shell->compositor,
+                                                  &now);
+
+    /* The previous commit is superseded, if the output showing the
+     * surface has not presented a frame since it was made */
+    if (stats->count > 0 && surface && surface->output) {
+        last = (stats->head + IVI_FRAME_STATS_SAMPLES - 1) %
+               IVI_FRAME_STATS_SAMPLES;
+        if (timespec_to_usec(&surface->output->frame_time) <
+            stats->commit_time_us[last])
+            stats->superseded++;
+    }
+
+    stats->commit_time_us[stats->head] = timespec_to_usec(&now);
+    stats->head = (stats->head + 1) % IVI_FRAME_STATS_SAMPLES;
+    if (stats->count < IVI_FRAME_STATS_SAMPLES)
+        stats->count++;
+
+    ivi_frame_policy_surface_committed(ivisurf->shell->frame_policy, ivisurf);
 }
 
 static struct ivisurface*
@@ -1589,6 +3744,8 @@ create_surface(struct ivishell *shell,
     struct ivisurface *ivisurf = NULL;
     struct ivicontroller *controller = NULL;
     struct weston_surface *surface;
+    uid_t uid;
+    gid_t gid;
 
     ivisurf = calloc(1, sizeof *ivisurf);
     if (ivisurf == NULL) {
@@ -1600,14 +3757,26 @@ create_surface(struct ivishell *shell,
     ivisurf->layout_surface = layout_surface;
     ivisurf->prop = lyt->get_properties_of_surface(layout_surface);
     wl_list_init(&ivisurf->notification_list);
+    wl_list_init(&ivisurf->held_frame_callbacks);
+    wl_list_init(&ivisurf->pending_link);
 
     ivisurf->committed.notify = surface_committed;
     surface = lyt->surface_get_weston_surface(layout_surface);
     wl_signal_add(&surface->commit_signal, &ivisurf->committed);
 
+    if (surface->resource)
+        wl_client_get_credentials(wl_resource_get_client(surface->resource),
+                                  &ivisurf->pid, &uid, &gid);
+
     if (shell->bkgnd_surface_id != (int32_t)id_surface) {
         wl_list_insert(&shell->list_surface, &ivisurf->link);
 
+        ivisurf->id_surface = id_surface;
+        hash_table_insert(&shell->surface_ptr_index, &ivisurf->ptr_entry,
+                          ivi_hash_ptr(layout_surface));
+        hash_table_insert(&shell->surface_id_index, &ivisurf->id_entry,
+                          ivi_hash_id(id_surface));
+
         wl_list_for_each(controller, &shell->list_controller, link) {
             if (controller->resource)
                 ivi_wm_send_surface_created(controller->resource, id_surface);
@@ -1640,6 +3809,8 @@ layer_event_create(struct wl_listener *listener, void *data)
         weston_log("failed to create layer");
         return;
     }
+
+    notify_scene_changed(shell);
 }
 
 static void
@@ -1653,7 +3824,7 @@ layer_event_remove(struct wl_listener *listener, void *data)
     uint32_t id_layer = 0;
     struct notification *noti, *next;
 
-    ivilayer = get_layer(&shell->list_layer, layout_layer);
+    ivilayer = get_layer(shell, layout_layer);
     if (ivilayer == NULL) {
         weston_log("id_surface is not created yet\n");
         return;
@@ -1661,12 +3832,12 @@ layer_event_remove(struct wl_listener *listener, void *data)
 
     wl_list_for_each_safe(noti, next, &ivilayer->notification_list, layout_link)
     {
-        wl_list_remove(&noti->link);
-        wl_list_remove(&noti->layout_link);
-        free(noti);
+        destroy_notification(noti);
     }
 
+    hash_table_remove(&shell->layer_ptr_index, &ivilayer->ptr_entry);
     wl_list_remove(&ivilayer->link);
+    wl_list_remove(&ivilayer->pending_link);
     wl_list_remove(&ivilayer->property_changed.link);
     free(ivilayer);
 
@@ -1676,6 +3847,9 @@ layer_event_remove(struct wl_listener *listener, void *data)
         if (controller->resource)
             ivi_wm_send_layer_destroyed(controller->resource, id_layer);
     }
+
+    ivi_frame_policy_schedule_update(shell->frame_policy);
+    notify_scene_changed(shell);
 }
 
 static bool
@@ -1718,6 +3892,30 @@ surface_event_create(struct wl_listener *listener, void *data)
 
     if (shell->bkgnd_surface_id != (int32_t)id_surface)
         wl_signal_emit(&shell->ivisurface_created_signal, ivisurf);
+
+    ivi_frame_policy_schedule_update(shell->frame_policy);
+    notify_scene_changed(shell);
+}
+
+static void
+surface_event_occlusion(struct wl_listener *listener, void *data)
+{
+    struct ivishell *shell =
+            wl_container_of(listener, shell, surface_occlusion_changed);
+    struct ivisurface *ivisurf = data;
+    struct ivicontroller *controller;
+
+    schedule_scene_export(shell, true);
+
+    wl_list_for_each(controller, &shell->list_controller, link) {
+        if (wl_resource_get_version(controller->resource) <
+            IVI_WM_SURFACE_OCCLUSION_SINCE_VERSION)
+            continue;
+
+        ivi_wm_send_surface_occlusion(controller->resource,
+                                      ivisurf->id_surface,
+                                      ivisurf->occluded);
+    }
 }
 
 static void
@@ -1726,11 +3924,11 @@ remove_common_surface(struct ivisurface *ivisurf)
     struct notification *noti, *next;
 
     wl_list_for_each_safe(noti, next, &ivisurf->notification_list, layout_link) {
-        wl_list_remove(&noti->link);
-        wl_list_remove(&noti->layout_link);
-        free(noti);
+        destroy_notification(noti);
     }
 
+    ivi_frame_policy_surface_removed(ivisurf);
+    wl_list_remove(&ivisurf->pending_link);
     wl_list_remove(&ivisurf->committed.link);
     free(ivisurf);
 }
@@ -1761,9 +3959,14 @@ remove_ivi_surface(struct ivishell *shell,
             ivi_wm_send_surface_destroyed(controller->resource, id_surface);
     }
 
+    hash_table_remove(&shell->surface_ptr_index, &ivisurf->ptr_entry);
+    hash_table_remove(&shell->surface_id_index, &ivisurf->id_entry);
     wl_list_remove(&ivisurf->link);
     wl_list_remove(&ivisurf->property_changed.link);
     remove_common_surface(ivisurf);
+
+    ivi_frame_policy_schedule_update(shell->frame_policy);
+    notify_scene_changed(shell);
 }
 
 static void
@@ -1775,7 +3978,7 @@ surface_event_remove(struct wl_listener *listener, void *data)
            (struct ivi_layout_surface *) data;
     uint32_t id_surface = 0;
 
-    ivisurf = get_surface(&shell->list_surface, layout_surface);
+    ivisurf = ivishell_get_surface(shell, layout_surface);
     id_surface = shell->interface->get_id_of_surface(layout_surface);
 
     if (ivisurf == NULL) {
@@ -1796,7 +3999,6 @@ surface_event_configure(struct wl_listener *listener, void *data)
     struct ivisurface *ivisurf = NULL;
     struct ivi_layout_surface *layout_surface =
            (struct ivi_layout_surface *) data;
-    struct ivicontroller *ctrl;
     struct notification *noti;
     uint32_t surface_id;
     struct weston_surface *w_surface;
@@ -1819,12 +4021,21 @@ surface_event_configure(struct wl_listener *listener, void *data)
         return;
     }
 
-    ivisurf = get_surface(&shell->list_surface, layout_surface);
+    ivisurf = ivishell_get_surface(shell, layout_surface);
     if (ivisurf == NULL) {
         weston_log("id_surface is not created yet\n");
         return;
     }
 
+    /* The id-agent or a client may have changed the id of the surface,
+     * keep the id index in sync with it. */
+    if (ivisurf->id_surface != surface_id) {
+        hash_table_remove(&shell->surface_id_index, &ivisurf->id_entry);
+        ivisurf->id_surface = surface_id;
+        hash_table_insert(&shell->surface_id_index, &ivisurf->id_entry,
+                          ivi_hash_id(surface_id));
+    }
+
     /* ivi-controller only care the surface configured event when
      * it has changed the size. Doesn't handle the id-agent sets
      * the id of surface.*/
@@ -1853,10 +4064,11 @@ surface_event_configure(struct wl_listener *listener, void *data)
     }
 
     wl_list_for_each(noti, &ivisurf->notification_list, layout_link) {
-        ctrl = wl_resource_get_user_data(noti->resource);
-        send_surface_event(ctrl, ivisurf->layout_surface, surface_id, ivisurf->prop,
-                           IVI_NOTIFICATION_CONFIGURE);
+        queue_notification(noti, IVI_NOTIFICATION_CONFIGURE);
     }
+
+    ivi_frame_policy_schedule_update(shell->frame_policy);
+    notify_scene_changed(shell);
 }
 
 static void
@@ -1949,6 +4161,9 @@ get_config(struct weston_compositor *compositor, struct ivishell *shell)
 	struct screen_id_info *screen_info = NULL;
 	const char *name = NULL;
 
+	shell->screenshot_queue_depth = IVI_SCREENSHOT_QUEUE_DEPTH;
+	shell->scene_export_buffer_size = IVI_SCENE_EXPORT_BUFFER_SIZE;
+
 	config = wet_get_config(compositor);
 	if (!config)
 		return;
@@ -1957,6 +4172,20 @@ get_config(struct weston_compositor *compositor, struct ivishell *shell)
 	if (!section)
 		return;
 
+	weston_config_section_get_uint(section,
+				       "screenshot-queue-depth",
+				       &shell->screenshot_queue_depth,
+				       IVI_SCREENSHOT_QUEUE_DEPTH);
+
+	weston_config_section_get_uint(section,
+				       "scene-export-size",
+				       &shell->scene_export_buffer_size,
+				       IVI_SCENE_EXPORT_BUFFER_SIZE);
+
+	weston_config_section_get_uint(section,
+				       "commit-budget",
+				       &shell->commit_budget, 0);
+
 	weston_config_section_get_uint(section,
 				       "screen-id-offset",
 				       &shell->screen_id_offset, 0);
@@ -2012,6 +4241,22 @@ get_config(struct weston_compositor *compositor, struct ivishell *shell)
 	}
 }
 
+/* Reverse of the creation in wet_module_init() */
+static void
+destroy_shell_instrumentation(struct ivishell *shell)
+{
+	if (shell->client_stats_scope)
+		weston_log_scope_destroy(shell->client_stats_scope);
+	shell->client_stats_scope = NULL;
+	if (shell->protocol_logger)
+		wl_protocol_logger_destroy(shell->protocol_logger);
+	shell->protocol_logger = NULL;
+	ivi_trace_destroy(shell->trace);
+	shell->trace = NULL;
+	ivi_frame_policy_destroy(shell->frame_policy);
+	shell->frame_policy = NULL;
+}
+
 static void
 ivi_shell_destroy(struct wl_listener *listener, void *data)
 {
@@ -2021,6 +4266,8 @@ ivi_shell_destroy(struct wl_listener *listener, void *data)
 	struct ivilayer *ivilayer_next;
 	struct iviscreen *iviscrn;
 	struct iviscreen *iviscrn_next;
+	struct ivi_surface_screenshot *shot;
+	struct ivi_surface_screenshot *shot_next;
 	struct ivishell *shell =
 		wl_container_of(listener, shell, destroy_listener);
 
@@ -2031,6 +4278,21 @@ ivi_shell_destroy(struct wl_listener *listener, void *data)
 
 	wl_list_remove(&shell->destroy_listener.link);
 
+	if (shell->notification_idle)
+		wl_event_source_remove(shell->notification_idle);
+
+	destroy_scene_export(shell);
+	destroy_shell_instrumentation(shell);
+	wl_list_remove(&shell->surface_occlusion_changed.link);
+
+	wl_list_for_each_safe(shot, shot_next,
+			      &shell->screenshot_queue, link) {
+		wl_resource_destroy(shot->screenshot);
+	}
+
+	if (shell->screenshot_timer)
+		wl_event_source_remove(shell->screenshot_timer);
+
 	wl_list_remove(&shell->output_created.link);
 	wl_list_remove(&shell->output_destroyed.link);
 	wl_list_remove(&shell->output_resized.link);
@@ -2045,6 +4307,7 @@ ivi_shell_destroy(struct wl_listener *listener, void *data)
 
 	wl_list_for_each_safe(ivisurf, ivisurf_next,
 			      &shell->list_surface, link) {
+		ivi_frame_policy_surface_removed(ivisurf);
 		wl_list_remove(&ivisurf->link);
 		free(ivisurf);
 	}
@@ -2061,6 +4324,7 @@ ivi_shell_destroy(struct wl_listener *listener, void *data)
 	}
 
 	destroy_screen_ids(shell);
+	release_shell_indexes(shell);
 	free(shell);
 }
 
@@ -2075,8 +4339,11 @@ init_ivi_shell(struct weston_compositor *ec, struct ivishell *shell)
 
     wl_list_init(&shell->list_surface);
     wl_list_init(&shell->list_layer);
+    wl_list_init(&shell->pending_surfaces);
+    wl_list_init(&shell->pending_layers);
     wl_list_init(&shell->list_screen);
     wl_list_init(&shell->list_controller);
+    wl_list_init(&shell->screenshot_queue);
 
     wl_list_for_each(output, &ec->output_list, link)
         create_screen(shell, output);
@@ -2118,13 +4385,19 @@ init_ivi_shell(struct weston_compositor *ec, struct ivishell *shell)
     wl_signal_init(&shell->id_allocation_request_signal);
     wl_signal_init(&shell->ivisurface_created_signal);
     wl_signal_init(&shell->ivisurface_removed_signal);
+    wl_signal_init(&shell->ivisurface_occlusion_signal);
+    wl_signal_init(&shell->scene_changed_signal);
+
+    shell->surface_occlusion_changed.notify = surface_event_occlusion;
+    wl_signal_add(&shell->ivisurface_occlusion_signal,
+                  &shell->surface_occlusion_changed);
 }
 
 int
 setup_ivi_controller_server(struct weston_compositor *compositor,
                             struct ivishell *shell)
 {
-    if (wl_global_create(compositor->wl_display, &ivi_wm_interface, 2,
+    if (wl_global_create(compositor->wl_display, &ivi_wm_interface, 3,
                          shell, bind_ivi_controller) == NULL) {
         return -1;
     }
@@ -2269,16 +4542,42 @@ wet_module_init(struct weston_compositor *compositor,
                                   WESTON_LAYER_POSITION_BACKGROUND);
     }
 
+    if (init_shell_indexes(shell) < 0) {
+        destroy_screen_ids(shell);
+        free(shell);
+        weston_log("ivi-controller: no memory to allocate shell indexes\n");
+        return -1;
+    }
+
     init_ivi_shell(compositor, shell);
 
+    shell->frame_policy = ivi_frame_policy_create(shell);
+    if (shell->frame_policy == NULL)
+        weston_log("ivi-controller: frame callbacks are not throttled\n");
+
+    shell->trace = ivi_trace_create(compositor);
+
+    shell->protocol_logger =
+        wl_display_add_protocol_logger(compositor->wl_display,
+                                       count_controller_message, shell);
+    shell->client_stats_scope =
+        weston_compositor_add_log_scope(compositor, "ivi-controller-clients",
+                                        "requests, events and commits of "
+                                        "every ivi_wm client\n",
+                                        print_client_stats, NULL, shell);
+
     if (setup_ivi_controller_server(compositor, shell)) {
+        destroy_shell_instrumentation(shell);
         destroy_screen_ids(shell);
+        release_shell_indexes(shell);
         free(shell);
         return -1;
     }
 
     if (load_input_module(shell) < 0) {
+        destroy_shell_instrumentation(shell);
         destroy_screen_ids(shell);
+        release_shell_indexes(shell);
         free(shell);
         return -1;
     }
@@ -39,8 +39,80 @@ timespec_to_msec(const struct timespec *a)
 	return (int64_t)a->tv_sec * 1000 + a->tv_nsec / 1000000;
 }
 
+/* Convert timespec to microseconds
+ *
+ * \param a timespec
+ * \return microseconds
+ */
+static inline int64_t
+timespec_to_usec(const struct timespec *a)
+{
+	return (int64_t)a->tv_sec * 1000000 + a->tv_nsec / 1000;
+}
+
+/* Chained hash table used to index ivisurfaces and ivilayers.
+ *
+ * Every bucket is a wl_list of entries; the number of buckets is always
+ * a power of two so a hash can be reduced with a mask.
+ */
+struct ivi_hash_entry {
+    struct wl_list link;
+    uint32_t hash;
+};
+
+struct ivi_hash_table {
+    struct wl_list *buckets;
+    uint32_t size;
+    uint32_t count;
+};
+
+static inline uint32_t
+ivi_hash_ptr(const void *ptr)
+{
+	uint64_t h = (uintptr_t)ptr;
+
+	h ^= h >> 33;
+	h *= 0xff51afd7ed558ccdULL;
+	h ^= h >> 33;
+
+	return (uint32_t)h;
+}
+
+static inline uint32_t
+ivi_hash_id(uint32_t id)
+{
+	return id * 2654435761u;
+}
+
+static inline struct wl_list *
+ivi_hash_bucket(const struct ivi_hash_table *table, uint32_t hash)
+{
+	return &table->buckets[hash & (table->size - 1)];
+}
+
+#define IVI_FRAME_STATS_SAMPLES 128
+
+/* Ring buffer of the latest commit timestamps of a surface. It is
+ * filled on every commit, the statistics are calculated on request.
+ */
+struct ivi_frame_stats {
+    int64_t commit_time_us[IVI_FRAME_STATS_SAMPLES];
+    uint32_t head;
+    uint32_t count;
+    uint32_t superseded;
+};
+
+/* Set of seat ids, ids below 32 need no allocation */
+struct ivi_seat_mask {
+    uint32_t low;
+    struct wl_array high;
+};
+
 struct ivisurface {
     struct wl_list link;
+    struct ivi_hash_entry ptr_entry;
+    struct ivi_hash_entry id_entry;
+    uint32_t id_surface;
     struct ivishell *shell;
     uint32_t update_count;
     struct ivi_layout_surface *layout_surface;
@@ -50,8 +122,36 @@ struct ivisurface {
     struct wl_listener committed;
     struct wl_list notification_list;
     enum ivi_wm_surface_type type;
+    /* pid of the client which created the surface, 0 if unknown */
+    pid_t pid;
     uint32_t frame_count;
+    struct ivi_frame_stats frame_stats;
+    /* focus state of accepted seats, allocated on first use */
     struct wl_list accepted_seat_list;
+    /* bits of the ids of the accepted seats */
+    struct ivi_seat_mask accepted_seat_mask;
+    /* seats whose acceptance changed in this dispatch cycle */
+    struct ivi_seat_mask acceptance_pending;
+
+    /* Set by the frame policy, when no part of the surface is shown */
+    bool occluded;
+    uint32_t visible_serial;
+    /* the opaque region covered the surface at the last commit */
+    bool opaque_content;
+    /* wl_surface.frame callbacks held back while occluded or paced */
+    struct wl_list held_frame_callbacks;
+
+    /* IVI_NOTIFICATION_* bits of the properties requested by controllers
+     * since the last commit */
+    uint32_t pending_mask;
+    /* in ivishell::pending_surfaces while pending_mask is set */
+    struct wl_list pending_link;
+
+    /* Frame callbacks per second at most, 0 for no limit */
+    uint32_t frame_rate_limit;
+    uint32_t paced_frames;
+    int64_t frame_done_us;
+    struct wl_event_source *frame_pacing_timer;
 };
 
 struct ivishell {
@@ -62,16 +162,64 @@ struct ivishell {
     struct wl_list list_layer;
     struct wl_list list_screen;
 
+    /* Indexes over list_surface / list_layer, kept up to date by
+     * ivi-controller. Modules must use the lookup helpers below. */
+    struct ivi_hash_table surface_ptr_index;
+    struct ivi_hash_table surface_id_index;
+    struct ivi_hash_table layer_ptr_index;
+
     struct wl_list list_controller;
+    struct wl_event_source *notification_idle;
+
+    /* Requests forwarded to ivi-layout since the last commit_changes of
+     * a controller */
+    uint32_t pending_changes;
+    /* surfaces and layers with a pending_mask, cleared on commit */
+    struct wl_list pending_surfaces;
+    struct wl_list pending_layers;
+
+    /* Pending surface screenshots, served one per loop iteration */
+    struct wl_list screenshot_queue;
+    uint32_t screenshot_queue_length;
+    uint32_t screenshot_queue_depth;
+    struct wl_event_source *screenshot_timer;
+
+    struct ivi_frame_policy *frame_policy;
+    /* debug scope ivi-controller-trace */
+    struct ivi_trace *trace;
+
+    /* commits per second a controller may apply, 0 for no limit. This
+     * only limits the repaints a controller causes, its requests are
+     * applied by any earlier commit, as ivi-layout has one pending state
+     * for all controllers and modules. */
+    uint32_t commit_budget;
+    struct wl_protocol_logger *protocol_logger;
+    struct weston_log_scope *client_stats_scope;
+
+    /* Scene published in shared memory, created on the first
+     * get_scene_export request */
+    struct ivi_scene_export_header *scene_export;
+    size_t scene_export_size;
+    int scene_export_fd;
+    uint32_t scene_export_buffer_size;
+    uint32_t scene_export_generation;
+    struct wl_event_source *scene_export_idle;
+    /* more than the frame counters changed since the last snapshot */
+    bool scene_export_dirty;
 
     struct wl_signal ivisurface_created_signal;
     struct wl_signal ivisurface_removed_signal;
+    struct wl_signal ivisurface_occlusion_signal;
     struct wl_signal id_allocation_request_signal;
+    /* Emitted when properties or the render order are committed, when a
+     * surface is configured and when outputs change, not on repaints */
+    struct wl_signal scene_changed_signal;
 
     struct wl_listener surface_created;
     struct wl_listener surface_removed;
     struct wl_listener surface_configured;
     struct wl_listener desktop_surface_configured;
+    struct wl_listener surface_occlusion_changed;
 
     struct wl_listener layer_created;
     struct wl_listener layer_removed;
@@ -100,4 +248,47 @@ struct ivishell {
     char *debug_scopes;
 };
 
+/* Look up the ivisurface of a layout surface
+ *
+ * \return the ivisurface or NULL, e.g. for the background surface
+ */
+static inline struct ivisurface *
+ivishell_get_surface(struct ivishell *shell,
+                     struct ivi_layout_surface *layout_surface)
+{
+    struct ivi_hash_entry *entry;
+    struct ivisurface *ivisurf;
+    uint32_t hash = ivi_hash_ptr(layout_surface);
+
+    wl_list_for_each(entry,
+                     ivi_hash_bucket(&shell->surface_ptr_index, hash), link) {
+        ivisurf = wl_container_of(entry, ivisurf, ptr_entry);
+        if (ivisurf->layout_surface == layout_surface)
+            return ivisurf;
+    }
+
+    return NULL;
+}
+
+/* Look up an ivisurface by its ivi-id
+ *
+ * \return the ivisurface or NULL if no surface uses the id
+ */
+static inline struct ivisurface *
+ivishell_get_surface_from_id(struct ivishell *shell, uint32_t id_surface)
+{
+    struct ivi_hash_entry *entry;
+    struct ivisurface *ivisurf;
+    uint32_t hash = ivi_hash_id(id_surface);
+
+    wl_list_for_each(entry,
+                     ivi_hash_bucket(&shell->surface_id_index, hash), link) {
+        ivisurf = wl_container_of(entry, ivisurf, id_entry);
+        if (ivisurf->id_surface == id_surface)
+            return ivisurf;
+    }
+
+    return NULL;
+}
+
 #endif /* WESTON_IVI_SHELL_SRC_IVI_CONTROLLER_H_ */
@@ -0,0 +1,555 @@
+/*
+ * Copyright (C) 2017 Advanced Driver Information Technology Joint Venture GmbH
+ *
+ * Permission to use, copy, modify, distribute, and sell this software and
+ * its documentation for any purpose is hereby granted without fee, provided
+ * that the above copyright notice appear in all copies and that both that
+ * copyright notice and this permission notice appear in supporting
+ * documentation, and that the name of the copyright holders not be used in
+ * advertising or publicity pertaining to distribution of the software
+ * without specific, written prior permission.  The copyright holders make
+ * no representations about the suitability of this software for any
+ * purpose.  It is provided "as is" without express or implied warranty.
+ *
+ * THE COPYRIGHT HOLDERS DISCLAIM ALL WARRANTIES WITH REGARD TO THIS
+ * SOFTWARE, INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND
+ * FITNESS, IN NO EVENT SHALL THE COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * SPECIAL, INDIRECT OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER
+ * RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF
+ * CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+ * CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/**
+ * Frame callback throttling for surfaces which can not be seen.
+ *
+ * Frame callbacks of a surface with a frame rate limit are paced, so that
+ * they complete at most frame_rate_limit times per second.
+ *
+ * Configuration in weston.ini:
+ *
+ *   [ivi-shell]
+ *   frame-throttling=true      enable the policy, off by default
+ *   hidden-frame-rate=1        frame callbacks per second for surfaces which
+ *                              are not visible, 0 holds them back until the
+ *                              surface becomes visible again
+ *
+ *   [ivi-surface]
+ *   surface-id=1000
+ *   frame-throttling=false     never throttle this surface
+ */
+
+#include "config.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <pixman.h>
+#include <weston.h>
+#include "ivi-frame-policy.h"
+
+#define IVI_FRAME_POLICY_HIDDEN_FRAME_RATE 1
+
+struct ivi_frame_policy {
+    struct ivishell *shell;
+
+    bool enabled;
+    /* interval of frame callbacks of hidden surfaces, 0 to hold them */
+    uint32_t hidden_interval_ms;
+    /* ids of surfaces which are never throttled */
+    struct wl_array exempt_ids;
+
+    /* visible_serial of a surface equals this when the last update
+     * found it visible */
+    uint32_t serial;
+
+    struct wl_event_source *update_idle;
+    struct wl_event_source *release_timer;
+    bool release_armed;
+};
+
+static bool
+surface_is_exempt(struct ivi_frame_policy *policy, struct ivisurface *ivisurf)
+{
+    uint32_t *id;
+
+    wl_array_for_each(id, &policy->exempt_ids) {
+        if (*id == ivisurf->id_surface)
+            return true;
+    }
+
+    return false;
+}
+
+static void
+send_frame_callbacks(struct wl_list *callbacks, uint32_t time_ms)
+{
+    struct wl_resource *cb, *next;
+
+    wl_resource_for_each_safe(cb, next, callbacks) {
+        wl_callback_send_done(cb, time_ms);
+        wl_resource_destroy(cb);
+    }
+}
+
+static int64_t
+current_time_us(struct ivishell *shell)
+{
+    struct timespec now;
+
+    if (clock_gettime(shell->compositor->presentation_clock, &now) < 0)
+        return 0;
+
+    return timespec_to_usec(&now);
+}
+
+static bool
+surface_is_throttled(struct ivi_frame_policy *policy,
+                     struct ivisurface *ivisurf)
+{
+    return policy && policy->enabled && ivisurf->occluded &&
+           !surface_is_exempt(policy, ivisurf);
+}
+
+/* The opaque region of the surface covers all of it */
+static bool
+surface_content_is_opaque(struct weston_surface *surface)
+{
+    pixman_box32_t box;
+
+    if (!surface || surface->width <= 0 || surface->height <= 0)
+        return false;
+
+    box.x1 = 0;
+    box.y1 = 0;
+    box.x2 = surface->width;
+    box.y2 = surface->height;
+
+    return pixman_region32_contains_rectangle(&surface->opaque, &box) ==
+           PIXMAN_REGION_IN;
+}
+
+/* A surface covers everything below its destination rectangle, if it is
+ * fully opaque by itself and neither it nor its layer is translucent */
+static bool
+surface_is_opaque(struct ivi_frame_policy *policy,
+                  struct ivisurface *ivisurf,
+                  const struct ivi_layout_layer_properties *layer_prop)
+{
+    if (ivisurf->prop->opacity != wl_fixed_from_int(1) ||
+        layer_prop->opacity != wl_fixed_from_int(1))
+        return false;
+
+    return surface_content_is_opaque(
+            policy->shell->interface->surface_get_weston_surface(
+                    ivisurf->layout_surface));
+}
+
+/* Walk the scene of an output from top to bottom, marking every surface
+ * which has a part not covered by opaque surfaces above */
+static void
+update_output(struct ivi_frame_policy *policy, struct weston_output *output)
+{
+    struct ivishell *shell = policy->shell;
+    const struct ivi_layout_interface *lyt = shell->interface;
+    const struct ivi_layout_layer_properties *layer_prop;
+    const struct ivi_layout_surface_properties *prop;
+    struct ivi_layout_layer **layers = NULL;
+    struct ivi_layout_surface **surfaces = NULL;
+    struct ivisurface *ivisurf;
+    int32_t layer_count = 0, surface_count = 0;
+    int32_t i, j, x0, y0, x1, y1;
+    double scale_x, scale_y;
+    pixman_region32_t covered;
+    pixman_region32_t area;
+
+    if (lyt->get_layers_on_screen(output, &layer_count,
+                                  &layers) != IVI_SUCCEEDED)
+        return;
+
+    pixman_region32_init(&covered);
+
+    for (i = layer_count - 1; i >= 0; i--) {
+        layer_prop = lyt->get_properties_of_layer(layers[i]);
+        if (!layer_prop->visibility || layer_prop->opacity == 0 ||
+            !layer_prop->source_width || !layer_prop->source_height ||
+            !layer_prop->dest_width || !layer_prop->dest_height)
+            continue;
+
+        if (lyt->get_surfaces_on_layer(layers[i], &surface_count,
+                                       &surfaces) != IVI_SUCCEEDED)
+            continue;
+
+        scale_x = (double)layer_prop->dest_width / layer_prop->source_width;
+        scale_y = (double)layer_prop->dest_height / layer_prop->source_height;
+
+        for (j = surface_count - 1; j >= 0; j--) {
+            ivisurf = ivishell_get_surface(shell, surfaces[j]);
+            if (!ivisurf)
+                continue;
+
+            prop = ivisurf->prop;
+            if (!prop->visibility || prop->opacity == 0)
+                continue;
+
+            /* destination rectangle on the output, clipped by the layer
+             * and the output */
+            x0 = layer_prop->dest_x +
+                 (prop->dest_x - layer_prop->source_x) * scale_x;
+            y0 = layer_prop->dest_y +
+                 (prop->dest_y - layer_prop->source_y) * scale_y;
+            x1 = layer_prop->dest_x +
+                 (prop->dest_x + prop->dest_width - layer_prop->source_x) *
+                 scale_x;
+            y1 = layer_prop->dest_y +
+                 (prop->dest_y + prop->dest_height - layer_prop->source_y) *
+                 scale_y;
+
+            if (x0 < layer_prop->dest_x)
+                x0 = layer_prop->dest_x;
+            if (y0 < layer_prop->dest_y)
+                y0 = layer_prop->dest_y;
+            if (x1 > layer_prop->dest_x + layer_prop->dest_width)
+                x1 = layer_prop->dest_x + layer_prop->dest_width;
+            if (y1 > layer_prop->dest_y + layer_prop->dest_height)
+                y1 = layer_prop->dest_y + layer_prop->dest_height;
+            if (x0 < 0)
+                x0 = 0;
+            if (y0 < 0)
+                y0 = 0;
+            if (x1 > output->width)
+                x1 = output->width;
+            if (y1 > output->height)
+                y1 = output->height;
+            if (x0 >= x1 || y0 >= y1)
+                continue;
+
+            pixman_region32_init_rect(&area, x0, y0, x1 - x0, y1 - y0);
+            pixman_region32_subtract(&area, &area, &covered);
+            if (pixman_region32_not_empty(&area))
+                ivisurf->visible_serial = policy->serial;
+            pixman_region32_fini(&area);
+
+            if (surface_is_opaque(policy, ivisurf, layer_prop))
+                pixman_region32_union_rect(&covered, &covered,
+                                           x0, y0, x1 - x0, y1 - y0);
+        }
+
+        free(surfaces);
+        surfaces = NULL;
+    }
+
+    pixman_region32_fini(&covered);
+    free(layers);
+}
+
+static void
+set_surface_occluded(struct ivi_frame_policy *policy,
+                     struct ivisurface *ivisurf, bool occluded)
+{
+    struct weston_surface *surface;
+
+    if (ivisurf->occluded == occluded)
+        return;
+
+    ivisurf->occluded = occluded;
+
+    /* let the client draw its next frame right away */
+    if (!occluded && !wl_list_empty(&ivisurf->held_frame_callbacks)) {
+        ivisurf->frame_done_us = current_time_us(policy->shell);
+        send_frame_callbacks(&ivisurf->held_frame_callbacks,
+                             (uint32_t)(ivisurf->frame_done_us / 1000));
+        surface = policy->shell->interface->surface_get_weston_surface(
+                ivisurf->layout_surface);
+        if (surface)
+            weston_surface_schedule_repaint(surface);
+    }
+
+    wl_signal_emit(&policy->shell->ivisurface_occlusion_signal, ivisurf);
+}
+
+static void
+update_visibility(void *data)
+{
+    struct ivi_frame_policy *policy = data;
+    struct ivishell *shell = policy->shell;
+    struct weston_output *output;
+    struct ivisurface *ivisurf;
+
+    policy->update_idle = NULL;
+    policy->serial++;
+
+    wl_list_for_each(output, &shell->compositor->output_list, link)
+        update_output(policy, output);
+
+    wl_list_for_each(ivisurf, &shell->list_surface, link)
+        set_surface_occluded(policy, ivisurf,
+                             ivisurf->visible_serial != policy->serial);
+}
+
+static int
+release_frame_callbacks(void *data)
+{
+    struct ivi_frame_policy *policy = data;
+    struct ivisurface *ivisurf;
+    int64_t now_us = current_time_us(policy->shell);
+
+    policy->release_armed = false;
+
+    wl_list_for_each(ivisurf, &policy->shell->list_surface, link) {
+        if (!surface_is_throttled(policy, ivisurf))
+            continue;
+
+        ivisurf->frame_done_us = now_us;
+        send_frame_callbacks(&ivisurf->held_frame_callbacks,
+                             (uint32_t)(now_us / 1000));
+    }
+
+    return 0;
+}
+
+static int
+release_paced_frame_callbacks(void *data)
+{
+    struct ivisurface *ivisurf = data;
+
+    /* hidden meanwhile, the callbacks wait for the throttling timer */
+    if (surface_is_throttled(ivisurf->shell->frame_policy, ivisurf))
+        return 0;
+
+    ivisurf->frame_done_us = current_time_us(ivisurf->shell);
+    send_frame_callbacks(&ivisurf->held_frame_callbacks,
+                         (uint32_t)(ivisurf->frame_done_us / 1000));
+
+    return 0;
+}
+
+/* Hold the frame callbacks of a surface which asks for frames faster than
+ * its limit, until one interval has passed since the last completion.
+ */
+static void
+pace_frame_callbacks(struct ivisurface *ivisurf,
+                     struct weston_surface *surface)
+{
+    struct wl_event_loop *loop;
+    int64_t now_us, due_us;
+
+    now_us = current_time_us(ivisurf->shell);
+    due_us = ivisurf->frame_done_us + 1000000 / ivisurf->frame_rate_limit;
+
+    if (now_us >= due_us && wl_list_empty(&ivisurf->held_frame_callbacks)) {
+        /* completed with the next repaint */
+        ivisurf->frame_done_us = now_us;
+        return;
+    }
+
+    if (ivisurf->frame_pacing_timer == NULL) {
+        loop = wl_display_get_event_loop(
+                ivisurf->shell->compositor->wl_display);
+        ivisurf->frame_pacing_timer = wl_event_loop_add_timer(loop,
+                release_paced_frame_callbacks, ivisurf);
+        if (ivisurf->frame_pacing_timer == NULL)
+            return;
+    }
+
+    wl_list_insert_list(ivisurf->held_frame_callbacks.prev,
+                        &surface->frame_callback_list);
+    wl_list_init(&surface->frame_callback_list);
+    ivisurf->paced_frames++;
+
+    wl_event_source_timer_update(ivisurf->frame_pacing_timer,
+            due_us > now_us ? (int)((due_us - now_us + 999) / 1000) : 1);
+}
+
+void
+ivi_frame_policy_schedule_update(struct ivi_frame_policy *policy)
+{
+    struct wl_event_loop *loop;
+
+    /* visibility is computed without throttling too, for the
+     * occlusion events */
+    if (!policy || policy->update_idle)
+        return;
+
+    loop = wl_display_get_event_loop(policy->shell->compositor->wl_display);
+    policy->update_idle = wl_event_loop_add_idle(loop, update_visibility,
+                                                 policy);
+}
+
+void
+ivi_frame_policy_surface_committed(struct ivi_frame_policy *policy,
+                                   struct ivisurface *ivisurf)
+{
+    struct weston_surface *surface;
+    bool opaque;
+
+    surface = ivisurf->shell->interface->surface_get_weston_surface(
+            ivisurf->layout_surface);
+
+    /* the surfaces below may be covered or uncovered by this commit */
+    opaque = surface_content_is_opaque(surface);
+    if (opaque != ivisurf->opaque_content) {
+        ivisurf->opaque_content = opaque;
+        ivi_frame_policy_schedule_update(policy);
+    }
+
+    if (!surface || wl_list_empty(&surface->frame_callback_list))
+        return;
+
+    if (!surface_is_throttled(policy, ivisurf)) {
+        if (ivisurf->frame_rate_limit)
+            pace_frame_callbacks(ivisurf, surface);
+        return;
+    }
+
+    /* take the callbacks away before the next repaint can send them */
+    wl_list_insert_list(ivisurf->held_frame_callbacks.prev,
+                        &surface->frame_callback_list);
+    wl_list_init(&surface->frame_callback_list);
+
+    if (policy->hidden_interval_ms && !policy->release_armed) {
+        wl_event_source_timer_update(policy->release_timer,
+                                     policy->hidden_interval_ms);
+        policy->release_armed = true;
+    }
+}
+
+void
+ivi_frame_policy_set_frame_rate_limit(struct ivi_frame_policy *policy,
+                                      struct ivisurface *ivisurf,
+                                      uint32_t frame_rate)
+{
+    ivisurf->frame_rate_limit = frame_rate;
+
+    /* callbacks held for the old limit are due at the new one */
+    if (ivisurf->frame_pacing_timer &&
+        !wl_list_empty(&ivisurf->held_frame_callbacks) &&
+        !surface_is_throttled(policy, ivisurf)) {
+        if (frame_rate)
+            wl_event_source_timer_update(ivisurf->frame_pacing_timer, 1);
+        else
+            release_paced_frame_callbacks(ivisurf);
+    }
+}
+
+double
+ivi_frame_policy_get_enforced_rate(struct ivi_frame_policy *policy,
+                                   struct ivisurface *ivisurf)
+{
+    struct weston_surface *surface;
+    double rate = 0.0;
+
+    surface = ivisurf->shell->interface->surface_get_weston_surface(
+            ivisurf->layout_surface);
+    if (surface && surface->output && surface->output->current_mode)
+        rate = surface->output->current_mode->refresh / 1000.0;
+
+    if (ivisurf->frame_rate_limit &&
+        (rate == 0.0 || ivisurf->frame_rate_limit < rate))
+        rate = ivisurf->frame_rate_limit;
+
+    if (surface_is_throttled(policy, ivisurf))
+        rate = policy->hidden_interval_ms ?
+               1000.0 / policy->hidden_interval_ms : 0.0;
+
+    return rate;
+}
+
+void
+ivi_frame_policy_surface_removed(struct ivisurface *ivisurf)
+{
+    struct wl_resource *cb, *next;
+
+    if (ivisurf->frame_pacing_timer) {
+        wl_event_source_remove(ivisurf->frame_pacing_timer);
+        ivisurf->frame_pacing_timer = NULL;
+    }
+
+    /* like weston does for a destroyed surface, without done */
+    wl_resource_for_each_safe(cb, next, &ivisurf->held_frame_callbacks)
+        wl_resource_destroy(cb);
+}
+
+static void
+read_config(struct ivi_frame_policy *policy)
+{
+    struct weston_config *config = wet_get_config(policy->shell->compositor);
+    struct weston_config_section *section;
+    const char *name = NULL;
+    uint32_t rate;
+    uint32_t surface_id;
+    uint32_t *id;
+    bool throttling;
+
+    section = weston_config_get_section(config, "ivi-shell", NULL, NULL);
+    weston_config_section_get_bool(section, "frame-throttling",
+                                   &policy->enabled, false);
+    weston_config_section_get_uint(section, "hidden-frame-rate", &rate,
+                                   IVI_FRAME_POLICY_HIDDEN_FRAME_RATE);
+    policy->hidden_interval_ms = rate ? 1000 / rate : 0;
+    if (rate > 1000)
+        policy->hidden_interval_ms = 1;
+
+    section = NULL;
+    while (weston_config_next_section(config, &section, &name)) {
+        if (0 != strcmp(name, "ivi-surface"))
+            continue;
+
+        if (0 != weston_config_section_get_uint(section, "surface-id",
+                                                &surface_id, 0))
+            continue;
+
+        weston_config_section_get_bool(section, "frame-throttling",
+                                       &throttling, true);
+        if (throttling)
+            continue;
+
+        id = wl_array_add(&policy->exempt_ids, sizeof *id);
+        if (id)
+            *id = surface_id;
+    }
+}
+
+struct ivi_frame_policy *
+ivi_frame_policy_create(struct ivishell *shell)
+{
+    struct ivi_frame_policy *policy;
+    struct wl_event_loop *loop;
+
+    policy = calloc(1, sizeof *policy);
+    if (policy == NULL)
+        return NULL;
+
+    policy->shell = shell;
+    wl_array_init(&policy->exempt_ids);
+
+    if (wet_get_config(shell->compositor))
+        read_config(policy);
+
+    loop = wl_display_get_event_loop(shell->compositor->wl_display);
+    policy->release_timer = wl_event_loop_add_timer(loop,
+            release_frame_callbacks, policy);
+    if (policy->release_timer == NULL) {
+        wl_array_release(&policy->exempt_ids);
+        free(policy);
+        return NULL;
+    }
+
+    ivi_frame_policy_schedule_update(policy);
+
+    return policy;
+}
+
+void
+ivi_frame_policy_destroy(struct ivi_frame_policy *policy)
+{
+    if (!policy)
+        return;
+
+    if (policy->update_idle)
+        wl_event_source_remove(policy->update_idle);
+    wl_event_source_remove(policy->release_timer);
+    wl_array_release(&policy->exempt_ids);
+    free(policy);
+}
@@ -0,0 +1,73 @@
+/*
+ * Copyright (C) 2017 Advanced Driver Information Technology Joint Venture GmbH
+ *
+ * Permission to use, copy, modify, distribute, and sell this software and
+ * its documentation for any purpose is hereby granted without fee, provided
+ * that the above copyright notice appear in all copies and that both that
+ * copyright notice and this permission notice appear in supporting
+ * documentation, and that the name of the copyright holders not be used in
+ * advertising or publicity pertaining to distribution of the software
+ * without specific, written prior permission.  The copyright holders make
+ * no representations about the suitability of this software for any
+ * purpose.  It is provided "as is" without express or implied warranty.
+ *
+ * THE COPYRIGHT HOLDERS DISCLAIM ALL WARRANTIES WITH REGARD TO THIS
+ * SOFTWARE, INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND
+ * FITNESS, IN NO EVENT SHALL THE COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * SPECIAL, INDIRECT OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER
+ * RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF
+ * CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+ * CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#ifndef WESTON_IVI_SHELL_SRC_IVI_FRAME_POLICY_H_
+#define WESTON_IVI_SHELL_SRC_IVI_FRAME_POLICY_H_
+
+#include "ivi-controller.h"
+
+/* Frame callback policy of ivi-controller
+ *
+ * Computes which surfaces are effectively visible on any output, taking
+ * the visibility and opacity of surfaces and layers, the destination
+ * rectangles and opaque surfaces stacked above into account.
+ * ivisurface_occlusion_signal is emitted whenever ivisurface::occluded
+ * changes. With frame-throttling set in the [ivi-shell] section, frame
+ * callbacks of surfaces which are not visible are held back and
+ * released at a low rate. Frame callbacks of surfaces
+ * with a frame rate limit are delayed to keep within the limit.
+ */
+struct ivi_frame_policy;
+
+struct ivi_frame_policy *
+ivi_frame_policy_create(struct ivishell *shell);
+
+void
+ivi_frame_policy_destroy(struct ivi_frame_policy *policy);
+
+/* Recompute the visibility of all surfaces once the event loop is idle,
+ * to be called when properties, the render order or the size of surfaces
+ * changed. Changes of opaque regions are found on commit. */
+void
+ivi_frame_policy_schedule_update(struct ivi_frame_policy *policy);
+
+/* To be called from the commit listener of the surface */
+void
+ivi_frame_policy_surface_committed(struct ivi_frame_policy *policy,
+                                   struct ivisurface *ivisurf);
+
+/* Set the frame rate limit of a surface, 0 removes it */
+void
+ivi_frame_policy_set_frame_rate_limit(struct ivi_frame_policy *policy,
+                                      struct ivisurface *ivisurf,
+                                      uint32_t frame_rate);
+
+/* Frame callbacks per second the surface gets at most, 0 if unknown */
+double
+ivi_frame_policy_get_enforced_rate(struct ivi_frame_policy *policy,
+                                   struct ivisurface *ivisurf);
+
+/* Drop the held frame callbacks of a surface which is going away */
+void
+ivi_frame_policy_surface_removed(struct ivisurface *ivisurf);
+
+#endif /* WESTON_IVI_SHELL_SRC_IVI_FRAME_POLICY_H_ */
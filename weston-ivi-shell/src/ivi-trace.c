@@ -0,0 +1,157 @@
+/*
+ * Copyright (C) 2017 Advanced Driver Information Technology Joint Venture GmbH
+ *
+ * Permission to use, copy, modify, distribute, and sell this software and
+ * its documentation for any purpose is hereby granted without fee, provided
+ * that the above copyright notice appear in all copies and that both that
+ * copyright notice and this permission notice appear in supporting
+ * documentation, and that the name of the copyright holders not be used in
+ * advertising or publicity pertaining to distribution of the software
+ * without specific, written prior permission.  The copyright holders make
+ * no representations about the suitability of this software for any
+ * purpose.  It is provided "as is" without express or implied warranty.
+ *
+ * THE COPYRIGHT HOLDERS DISCLAIM ALL WARRANTIES WITH REGARD TO THIS
+ * SOFTWARE, INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND
+ * FITNESS, IN NO EVENT SHALL THE COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * SPECIAL, INDIRECT OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER
+ * RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF
+ * CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+ * CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+
+#include "config.h"
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "ivi-trace.h"
+
+struct ivi_trace {
+    struct weston_compositor *compositor;
+    struct weston_log_scope *scope;
+};
+
+static int64_t
+current_time_us(struct ivi_trace *trace)
+{
+    struct timespec now;
+
+    clock_gettime(trace->compositor->presentation_clock, &now);
+
+    return (int64_t)now.tv_sec * 1000000 + now.tv_nsec / 1000;
+}
+
+static void
+subscription_started(struct weston_log_subscription *subscription,
+                     void *data)
+{
+    (void)data;
+
+    /* open the array of trace events, trailing commas and a missing
+     * closing bracket are accepted by the trace viewers */
+    weston_log_subscription_printf(subscription, "[\n");
+}
+
+struct ivi_trace *
+ivi_trace_create(struct weston_compositor *compositor)
+{
+    struct ivi_trace *trace;
+
+    trace = calloc(1, sizeof *trace);
+    if (trace == NULL)
+        return NULL;
+
+    trace->compositor = compositor;
+    trace->scope =
+        weston_compositor_add_log_scope(compositor, "ivi-controller-trace",
+                                        "ivi-controller requests, commits and "
+                                        "notifications as Chrome trace events\n",
+                                        subscription_started, NULL, trace);
+    if (trace->scope == NULL) {
+        free(trace);
+        return NULL;
+    }
+
+    return trace;
+}
+
+void
+ivi_trace_destroy(struct ivi_trace *trace)
+{
+    if (trace == NULL)
+        return;
+
+    weston_log_scope_destroy(trace->scope);
+    free(trace);
+}
+
+bool
+ivi_trace_is_enabled(struct ivi_trace *trace)
+{
+    return trace && weston_log_scope_is_enabled(trace->scope);
+}
+
+void
+ivi_trace_span_begin(struct ivi_trace *trace, struct ivi_trace_span *span,
+                     const char *category, const char *name,
+                     struct wl_resource *resource)
+{
+    pid_t pid;
+    uid_t uid;
+    gid_t gid;
+
+    span->trace = NULL;
+    if (!ivi_trace_is_enabled(trace))
+        return;
+
+    span->trace = trace;
+    span->category = category;
+    span->name = name;
+
+    if (resource) {
+        wl_client_get_credentials(wl_resource_get_client(resource),
+                                  &pid, &uid, &gid);
+        span->pid = pid;
+        span->tid = wl_resource_get_id(resource);
+    } else {
+        span->pid = getpid();
+        span->tid = 0;
+    }
+
+    span->start_us = current_time_us(trace);
+}
+
+void
+ivi_trace_span_end(struct ivi_trace_span *span, const char *args_fmt, ...)
+{
+    char args[256] = "";
+    va_list ap;
+    int64_t end_us;
+
+    if (span->trace == NULL)
+        return;
+
+    end_us = current_time_us(span->trace);
+
+    if (args_fmt) {
+        va_start(ap, args_fmt);
+        vsnprintf(args, sizeof args, args_fmt, ap);
+        va_end(ap);
+    }
+
+    weston_log_scope_printf(span->trace->scope,
+                            "{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\","
+                            "\"ts\":%lld,\"dur\":%lld,\"pid\":%d,\"tid\":%u,"
+                            "\"args\":{%s}},\n",
+                            span->name, span->category,
+                            (long long)span->start_us,
+                            (long long)(end_us - span->start_us),
+                            span->pid, span->tid, args);
+
+    span->trace = NULL;
+}
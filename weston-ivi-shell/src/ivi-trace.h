@@ -0,0 +1,72 @@
+/*
+ * Copyright (C) 2017 Advanced Driver Information Technology Joint Venture GmbH
+ *
+ * Permission to use, copy, modify, distribute, and sell this software and
+ * its documentation for any purpose is hereby granted without fee, provided
+ * that the above copyright notice appear in all copies and that both that
+ * copyright notice and this permission notice appear in supporting
+ * documentation, and that the name of the copyright holders not be used in
+ * advertising or publicity pertaining to distribution of the software
+ * without specific, written prior permission.  The copyright holders make
+ * no representations about the suitability of this software for any
+ * purpose.  It is provided "as is" without express or implied warranty.
+ *
+ * THE COPYRIGHT HOLDERS DISCLAIM ALL WARRANTIES WITH REGARD TO THIS
+ * SOFTWARE, INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND
+ * FITNESS, IN NO EVENT SHALL THE COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * SPECIAL, INDIRECT OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER
+ * RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF
+ * CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+ * CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+
+#ifndef WESTON_IVI_SHELL_SRC_IVI_TRACE_H_
+#define WESTON_IVI_SHELL_SRC_IVI_TRACE_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include <weston.h>
+
+/* Trace of ivi-controller, published in the weston debug scope
+ * "ivi-controller-trace"
+ *
+ * Every record is a Chrome trace event of type complete ("ph":"X") on a
+ * line of its own, with ts and dur in microseconds of the presentation
+ * clock. A subscription starts with "[", so the stream of a subscriber
+ * can be loaded into chrome://tracing or Perfetto as it is.
+ */
+struct ivi_trace;
+
+struct ivi_trace_span {
+    struct ivi_trace *trace;    /* NULL if nobody is subscribed */
+    const char *category;
+    const char *name;
+    int32_t pid;
+    uint32_t tid;
+    int64_t start_us;
+};
+
+struct ivi_trace *
+ivi_trace_create(struct weston_compositor *compositor);
+
+void
+ivi_trace_destroy(struct ivi_trace *trace);
+
+bool
+ivi_trace_is_enabled(struct ivi_trace *trace);
+
+/* Start a span of the client owning resource, or of the compositor if
+ * resource is NULL. Does nothing unless somebody is subscribed. */
+void
+ivi_trace_span_begin(struct ivi_trace *trace, struct ivi_trace_span *span,
+                     const char *category, const char *name,
+                     struct wl_resource *resource);
+
+/* Emit the span, args_fmt formats the members of its args object */
+void
+ivi_trace_span_end(struct ivi_trace_span *span, const char *args_fmt, ...)
+    __attribute__((format(printf, 2, 3)));
+
+#endif /* WESTON_IVI_SHELL_SRC_IVI_TRACE_H_ */